@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bench {
+
+// Sequential stopping for --adaptive-precision. Every (sample, decoder) is
+// timed at least min_repetitions times, then again each round only while the
+// 95% t interval of its mean decode time is wider than relative_precision
+// of the mean on either side, up to max_repetitions. A decode that fails or
+// times out stops its unit: re-timing an error says nothing about latency.
+struct AdaptiveOptions {
+    double relative_precision = 0.05;
+    int min_repetitions = 3;
+    int max_repetitions = 30;
+};
+
+struct AdaptiveDecoderReport {
+    std::string decoder;
+    std::size_t units = 0;
+    std::size_t converged = 0;      // reached the target precision
+    std::size_t capped = 0;         // still too wide: hit max_repetitions or the run stopped
+    std::size_t failed = 0;         // stopped by an error or timeout
+    std::size_t decode_calls = 0;
+    int max_repetitions_used = 0;
+    // A fixed --repetitions run needs the largest count any unit needed to
+    // give every unit the same precision.
+    std::size_t fixed_equivalent_calls = 0;
+    // Mean of the per-sample means, so noisy images that were re-timed more
+    // often do not weigh more than the others.
+    double mean_decode_ms = 0;
+    double median_relative_half_width = 0;
+};
+
+// --repetitions applies to every decoder, so the overall fixed equivalent
+// uses the largest count across decoders.
+struct AdaptiveReport {
+    std::vector<AdaptiveDecoderReport> decoders;
+    std::size_t decode_calls = 0;
+    std::size_t fixed_equivalent_calls = 0;
+    std::size_t savedCalls() const { return fixed_equivalent_calls > decode_calls ? fixed_equivalent_calls - decode_calls : 0; }
+};
+
+class AdaptiveRepetitions {
+public:
+    explicit AdaptiveRepetitions(AdaptiveOptions options);
+
+    // Seeds the timings from an existing results.jsonl so a resumed run
+    // stops where the interrupted one would have.
+    void load(const std::filesystem::path& jsonl);
+    void add(const std::string& sample_id, const std::string& decoder, std::int64_t decode_ns, bool failed);
+    bool needsMore(const std::string& sample_id, const std::string& decoder) const;
+    // Half-width of the 95% interval over the mean; infinite below two runs.
+    double relativeHalfWidth(const std::string& sample_id, const std::string& decoder) const;
+    AdaptiveReport report() const;
+    const AdaptiveOptions& options() const { return options_; }
+
+private:
+    struct Unit {
+        std::size_t calls = 0;
+        // Welford's running mean and sum of squared deviations over the
+        // decodes that succeeded.
+        std::size_t count = 0;
+        double mean_ns = 0;
+        double m2 = 0;
+        bool failed = false;
+    };
+    double relativeHalfWidth(const Unit& unit) const;
+
+    AdaptiveOptions options_;
+    std::map<std::pair<std::string, std::string>, Unit> units_;  // (decoder, sample)
+};
+
+void writeAdaptiveReport(const AdaptiveReport& report, const AdaptiveOptions& options, const std::filesystem::path& output);
+
+} // namespace bench
@@ -4,6 +4,7 @@
 #include <filesystem>
 #include <iosfwd>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace bench {
@@ -33,6 +34,10 @@ public:
     static std::vector<ManifestRecord> readManifest(const std::filesystem::path& path);
     static void writeManifest(const std::filesystem::path& path,
                               const std::vector<ManifestRecord>& records);
+    // One manifest line without the trailing newline, for streaming writers.
+    static std::string manifestLine(const ManifestRecord& record);
+    // The inverse; also reads the manifest fields of a results.jsonl record.
+    static ManifestRecord parseManifestLine(std::string_view line);
 };
 
 } // namespace bench
@@ -29,6 +29,10 @@ struct ManifestRecord {
     int width = 0;
     int height = 0;
     std::vector<GroundTruth> ground_truth;
+    // Set by `subset`: the stratum the image was drawn from and how many
+    // full-manifest images it stands for. Full manifests leave both default.
+    std::string stratum;
+    double weight = 1.0;
 };
 
 struct ImageBuffer {
@@ -36,6 +40,12 @@ struct ImageBuffer {
     int width = 0;
     int height = 0;
     int stride = 0;
+    // Pixels owned elsewhere, such as a shared-memory region; rgb is empty
+    // then. Decoders read through data() and size() so either form works.
+    const std::uint8_t* view = nullptr;
+
+    const std::uint8_t* data() const { return view ? view : rgb.data(); }
+    std::size_t size() const { return view ? static_cast<std::size_t>(stride) * height : rgb.size(); }
 };
 
 struct DecodedBarcode {
@@ -43,18 +53,32 @@ struct DecodedBarcode {
     std::vector<std::uint8_t> raw_bytes;
     std::string text;
     std::optional<double> confidence;
+    // Corners in image pixels, in the order the library reports them; empty
+    // when it reports none.
+    std::vector<Point> position;
 };
 
 struct DecodeRun {
     std::vector<DecodedBarcode> results;
     std::chrono::nanoseconds decode_time{0};
+    std::chrono::nanoseconds thread_cpu_time{0};
+    std::chrono::nanoseconds process_cpu_time{0};
+    std::int64_t voluntary_context_switches = 0;
+    std::int64_t involuntary_context_switches = 0;
     std::optional<std::string> error;
+    bool timed_out = false;
+    // Set by composite decoders: the RacingDecoder member or CascadeDecoder
+    // level whose answer was taken, or "none".
+    std::string resolved_by;
+    // Set by RacingDecoder: the wall time until every member had stopped,
+    // which is what the race costs per image; zero elsewhere.
+    std::chrono::nanoseconds wall_time{0};
 };
 
 enum class Outcome {
     Correct, NotFound, WrongText, WrongFormat, ExtraResult,
     UnsupportedFormat, AmbiguousGroundTruth, DecoderError,
-    LicenseOrInitializationError, InputPipelineError
+    LicenseOrInitializationError, InputPipelineError, Timeout
 };
 
 struct MatchItem {
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace bench {
+
+// Puts a decode into a cold-cache state. evict() flushes every cache line of
+// the image buffer (clflush on x86, dc civac on AArch64) and then streams
+// through a private thrash buffer larger than the last-level cache, which
+// also pushes out the decoder's own tables and heap.
+class CacheEvictor {
+public:
+    // thrash_bytes 0 picks twice the detected last-level cache, capped at
+    // kMaxDefaultThrash so hosts reporting huge shared caches stay usable.
+    explicit CacheEvictor(std::size_t thrash_bytes = 0);
+
+    void evict(std::span<const std::uint8_t> buffer);
+    std::size_t thrashBytes() const { return thrash_.size(); }
+
+    static constexpr std::size_t kMaxDefaultThrash = std::size_t{256} << 20;
+
+private:
+    std::vector<std::uint8_t> thrash_;
+    std::uint64_t sink_ = 0;
+};
+
+// Size of the largest cache level reported under /sys, or 0 when unknown.
+std::size_t lastLevelCacheBytes();
+// Parses sysfs cache sizes such as "32K", "2048K" or "8M".
+std::size_t parseCacheSize(std::string_view text);
+
+} // namespace bench
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "decoder_adapter.h"
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace bench {
+
+// Decodes a downscaled copy of the image first and moves to finer levels
+// only while fewer than `expected_symbols` distinct barcodes have been found.
+// Levels are downscale factors, powers of two in decreasing order such as
+// {4, 2, 1}; each is built by halving the previous one with halveImage(),
+// and levels whose shorter side would fall below 32 pixels are skipped.
+// Results from every level tried are merged by format and text, with
+// positions mapped back to full-resolution pixels.
+//
+// decode_time is the pyramid build plus every level's decode_time, so it
+// compares directly with the wrapped decoder's single-shot time.
+// resolved_by names the level that reached the expected count ("1/4"), or
+// "none" when no level did. The name is "cascade:<inner>", and
+// isFormatSupported() treats it like the inner decoder.
+class CascadeDecoder final : public IDecoderAdapter {
+public:
+    CascadeDecoder(std::unique_ptr<IDecoderAdapter> inner, std::vector<int> factors, std::size_t expected_symbols);
+
+    std::string name() const override { return "cascade:" + inner_->name(); }
+    std::string version() const override { return inner_->version(); }
+    DecodeRun decode(const ImageBuffer& image) override;
+    // A native deadline would apply to each level separately, so the budget
+    // for the whole cascade is left to the watchdog.
+    bool setDeadline(std::chrono::milliseconds) override { return false; }
+    bool cancel() override;
+
+private:
+    const ImageBuffer* level(const ImageBuffer& image, int factor);
+
+    std::unique_ptr<IDecoderAdapter> inner_;
+    std::vector<int> factors_;
+    std::size_t expected_;
+    // pyramid_[k] holds the image at 1/2^(k+1); built_ counts the levels
+    // already made from the current image.
+    std::vector<ImageBuffer> pyramid_;
+    std::size_t built_ = 0;
+    std::mutex mutex_;
+    bool busy_ = false;
+    bool cancelled_ = false;
+};
+
+// Parses "4,2,1" and checks the factors are decreasing powers of two.
+std::vector<int> parseCascadeLevels(std::string_view text);
+std::string cascadeLevelName(int factor);
+
+} // namespace bench
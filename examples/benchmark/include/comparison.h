@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bench {
+
+struct ComparisonOptions {
+    // Relative increase in mean paired latency that counts as a regression
+    // once the Wilcoxon test also rejects equality at the 5% level.
+    double latency_threshold = 0.05;
+    int bootstrap_resamples = 2000;
+    std::uint64_t seed = 1;
+};
+
+struct LatencyComparison {
+    std::string decoder;
+    std::size_t pairs = 0;
+    double baseline_mean_ms = 0;
+    double candidate_mean_ms = 0;
+    double relative_change = 0;
+    std::pair<double, double> relative_change_ci95{0, 0};
+    double median_delta_ms = 0;
+    std::pair<double, double> median_delta_ci95{0, 0};
+    double wilcoxon_z = 0;
+    double wilcoxon_p = 1;
+    bool regressed = false;
+};
+
+struct RecallComparison {
+    std::string decoder;
+    std::string format;
+    // Summed per-sample shares of repetitions that read each symbol, so
+    // flaky symbols count fractionally.
+    double baseline_correct = 0;
+    std::uint64_t baseline_eligible = 0;
+    double candidate_correct = 0;
+    std::uint64_t candidate_eligible = 0;
+    double delta = 0;
+    std::pair<double, double> delta_ci95{0, 0};
+    bool regressed = false;
+};
+
+struct ComparisonReport {
+    std::vector<LatencyComparison> latency;
+    std::vector<RecallComparison> recall;
+    std::size_t baseline_only = 0;
+    std::size_t candidate_only = 0;
+    bool regressed() const;
+};
+
+// Pairs the two results.jsonl streams by sample_id within each decoder.
+// Repetitions are averaged per sample before pairing, for recall as well as
+// latency (a symbol read in half the repetitions counts as half correct);
+// recall is compared per canonical format (plus "ALL") on the paired samples
+// only.
+ComparisonReport compareResults(const std::filesystem::path& baseline_jsonl,
+                                const std::filesystem::path& candidate_jsonl,
+                                const ComparisonOptions& options = ComparisonOptions{});
+void writeComparison(const ComparisonReport& report, const std::filesystem::path& output);
+
+} // namespace bench
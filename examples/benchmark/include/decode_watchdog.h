@@ -0,0 +1,44 @@
+#pragma once
+
+#include "decoder_adapter.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+
+namespace bench {
+
+// Enforces a per-image decode deadline. A background thread watches the
+// decode in flight and asks the adapter to cancel it once the deadline has
+// passed. Adapters that cannot be interrupted finish normally; their result
+// is then replaced by a timeout outcome so a slow answer is never scored. A
+// timed-out run keeps at least the wall time the call took as decode_time.
+class DecodeWatchdog {
+public:
+    explicit DecodeWatchdog(std::chrono::milliseconds timeout);
+    ~DecodeWatchdog();
+    DecodeWatchdog(const DecodeWatchdog&) = delete;
+    DecodeWatchdog& operator=(const DecodeWatchdog&) = delete;
+
+    DecodeRun decode(IDecoderAdapter& decoder, const ImageBuffer& image);
+    std::chrono::milliseconds timeout() const { return timeout_; }
+    std::size_t overruns() const;
+    std::size_t cancelled() const;
+
+private:
+    void watch();
+
+    const std::chrono::milliseconds timeout_;
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    IDecoderAdapter* active_ = nullptr;
+    std::chrono::steady_clock::time_point deadline_;
+    bool fired_ = false;
+    bool stop_ = false;
+    std::size_t overruns_ = 0;
+    std::size_t cancelled_ = 0;
+    std::thread thread_;
+};
+
+} // namespace bench
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "benchmark_types.h"
+#include <chrono>
 #include <memory>
 #include <string>
 
@@ -12,6 +13,12 @@ public:
     virtual std::string name() const = 0;
     virtual std::string version() const = 0;
     virtual DecodeRun decode(const ImageBuffer& image) = 0;
+    // Applies a per-call time budget inside the library. Returns false when
+    // the library has no native deadline.
+    virtual bool setDeadline(std::chrono::milliseconds) { return false; }
+    // Asks an in-flight decode() to stop early. Called from the watchdog
+    // thread; returns false when the library cannot be interrupted.
+    virtual bool cancel() { return false; }
 };
 
 std::unique_ptr<IDecoderAdapter> createZxingDecoder(int max_symbols);
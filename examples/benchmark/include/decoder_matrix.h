@@ -0,0 +1,39 @@
+#pragma once
+
+#include "decoder_adapter.h"
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace bench {
+
+// One decoder/configuration pair of a run. Without --config-matrix the run
+// uses one default entry per family; a matrix lists any number of them and
+// every loaded image is decoded by all of them.
+struct DecoderConfig {
+    std::string family;                             // "zxing-cpp" or "dynamsoft-dbr"
+    std::string label;                              // tells configurations of one family apart
+    std::string template_name = "ReadBarcodes_Default"; // DBR template to run
+    std::filesystem::path config;                   // DBR template file or ZXing options file
+
+    // The decoder name stored in records: the family, or "family:label".
+    // decoderFamily() recovers the family for format-support lookups.
+    std::string name() const;
+};
+
+// Reads {"decoders":[{"family":...,"label":...,"template":...,"config":...}]}.
+// Relative config paths are resolved against the matrix file's directory.
+std::vector<DecoderConfig> readDecoderMatrix(const std::filesystem::path& path);
+
+// Wraps an adapter so records carry a configuration-specific name.
+std::unique_ptr<IDecoderAdapter> renameDecoder(std::unique_ptr<IDecoderAdapter> decoder, std::string name);
+
+// Deterministic per-sample decoder order: a Fisher-Yates shuffle seeded by
+// the sample id and repetition. With two decoders it reproduces the order
+// of earlier two-decoder runs.
+std::vector<std::size_t> decoderOrder(std::string_view sample_id, int repetition, std::size_t count);
+
+} // namespace bench
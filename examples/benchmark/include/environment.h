@@ -0,0 +1,57 @@
+#pragma once
+
+#include <nlohmann/json.hpp>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace bench {
+
+// Where Linux details are read from; tests point these at a fake tree.
+struct EnvironmentSources {
+    std::filesystem::path sys = "/sys";
+    std::filesystem::path proc = "/proc";
+};
+
+// The machine and build a run executes on: OS, kernel, CPU model and core
+// counts, memory, compiler, build type and flags, and on Linux the cpufreq
+// governor and driver, turbo/boost state, SMT control, and isolated and
+// nohz_full CPUs. Values that cannot be read are left out.
+nlohmann::json captureEnvironment(const EnvironmentSources& sources = EnvironmentSources{});
+
+// SHA-256 of the environment without its capture timestamp, so restarts on
+// an unchanged machine keep the same value. Stored in every result record.
+std::string environmentHash(const nlohmann::json& environment);
+
+// Conditions that make latency comparisons unreliable: a non-performance
+// governor, turbo left on, or pinned CPUs sharing a physical core.
+std::vector<std::string> environmentWarnings(const nlohmann::json& environment, const std::vector<int>& pinned_cpus,
+                                             const EnvironmentSources& sources = EnvironmentSources{});
+
+// A NUMA node with at least one CPU, from /sys/devices/system/node.
+struct NumaNode {
+    int id = 0;
+    std::vector<int> cpus;
+    std::uint64_t memory_bytes = 0;
+};
+
+// Ordered by node ID. Empty when the kernel exposes no NUMA nodes, as on
+// other platforms; memory-only nodes are left out since nothing can be
+// bound to them.
+std::vector<NumaNode> numaTopology(const EnvironmentSources& sources = EnvironmentSources{});
+
+// Parses a kernel-style CPU list such as "0-3,8".
+std::vector<int> parseCpuList(std::string_view text);
+
+// Scheduling controls for the calling thread; threads and worker processes
+// it starts afterwards inherit them. Each throws std::runtime_error when the
+// platform refuses or lacks the control.
+void pinCurrentThread(const std::vector<int>& cpus);
+void setNice(int value);
+// The priority must stay below the SCHED_FIFO maximum; DecodeWatchdog runs
+// one level higher.
+void setFifoPriority(int priority);
+
+} // namespace bench
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "benchmark_types.h"
+#include <cstddef>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+// Tail-latency triage over a results.jsonl stream. Each (decoder, sample)
+// is folded across repetitions into a median decode time and a coefficient
+// of variation, leaving out records with an error other than a timeout; the
+// slowest samples per decoder and per decoder and ground
+// truth format are kept, plus those whose repetitions disagree the most.
+struct HotspotOptions {
+    std::size_t top = 10;
+    // Repetition-to-repetition stddev / mean above which a sample is noisy.
+    double cv_threshold = 0.25;
+    // Fewer repetitions than this say nothing useful about variance.
+    std::size_t min_repetitions = 3;
+};
+
+struct HotspotReason {
+    std::string decoder;
+    std::string kind;    // "slowest", "slowest_in_format" or "unstable"
+    std::string format;  // set for "slowest_in_format"
+    std::size_t rank = 0;
+    double median_ms = 0;
+    double cv = 0;
+    std::size_t repetitions = 0;
+};
+
+struct HotspotSample {
+    ManifestRecord record;  // stratum and weight cleared: not a random draw
+    std::vector<HotspotReason> reasons;
+    double worst_median_ms = 0;
+};
+
+struct HotspotReport {
+    std::vector<HotspotSample> samples;  // slowest worst_median_ms first
+    std::size_t records = 0;
+    std::size_t images = 0;
+    std::size_t decoders = 0;
+};
+
+HotspotReport findHotspots(const std::filesystem::path& jsonl, const HotspotOptions& options = HotspotOptions{});
+// Writes why each sample was picked, next to the manifest the samples form.
+void writeHotspotReport(const HotspotReport& report, const HotspotOptions& options, const std::filesystem::path& output);
+
+} // namespace bench
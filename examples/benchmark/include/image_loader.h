@@ -1,9 +1,43 @@
 #pragma once
 #include "benchmark_types.h"
+#include <cstdint>
 #include <filesystem>
+#include <memory>
+#include <span>
 #include <string>
+#include <vector>
 
 namespace bench {
+
+// Decodes benchmark images into RGB888. Backends that only handle one file
+// type (libjpeg-turbo, libpng) fall back to stb_image for everything else so
+// a mixed dataset still loads completely with any backend.
+class IImageLoader {
+public:
+    virtual ~IImageLoader() = default;
+    virtual std::string name() const = 0;
+    virtual bool decode(std::span<const std::uint8_t> bytes, ImageBuffer& output, std::string& error) = 0;
+    bool load(const std::filesystem::path& path, ImageBuffer& output, std::string& error);
+};
+
+// scale_denominator is 1, 2, 4 or 8. libjpeg-turbo applies it in the DCT
+// domain; the other backends decode at full size and box-filter afterwards.
+std::unique_ptr<IImageLoader> createImageLoader(const std::string& name, int scale_denominator);
+std::vector<std::string> availableImageLoaders();
+std::unique_ptr<IImageLoader> createStbImageLoader(int scale_denominator);
+#ifdef BENCHMARK_HAVE_LIBJPEG
+std::unique_ptr<IImageLoader> createJpegImageLoader(int scale_denominator);
+#endif
+#ifdef BENCHMARK_HAVE_LIBPNG
+std::unique_ptr<IImageLoader> createPngImageLoader(int scale_denominator);
+#endif
+
+bool readFileBytes(const std::filesystem::path& path, std::vector<std::uint8_t>& output, std::string& error);
+void downscaleImage(ImageBuffer& image, int factor);
+// Same result as downscaleImage(image, 2), written to a separate buffer that
+// keeps its allocation across calls. SSE2 or NEON when available.
+void halveImage(const ImageBuffer& input, ImageBuffer& output);
+
 bool loadImage(const std::filesystem::path& path, ImageBuffer& output, std::string& error);
 bool probeImage(const std::filesystem::path& path, int& width, int& height, std::string& error);
 }
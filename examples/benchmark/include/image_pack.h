@@ -0,0 +1,77 @@
+#pragma once
+
+#include "benchmark_types.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace bench {
+
+// One file holding every encoded image of a manifest, so a run maps a single
+// artifact instead of opening each image and hosts receive one copy.
+//
+// Layout (integers little-endian):
+//   0   "BARPACK1"
+//   8   u32 version, u32 alignment
+//   16  u64 entry count, u64 index offset, u64 index bytes
+//   64+ image blobs, each starting on an alignment boundary
+//   index: JSON {"entries":[{sample_id, relative_path, offset, length, sha256}]}
+// Identical images are stored once and share a blob.
+inline constexpr std::uint32_t kImagePackAlignment = 4096;
+
+struct PackEntry {
+    std::string sample_id;
+    std::string relative_path;
+    std::uint64_t offset = 0;
+    std::uint64_t length = 0;
+    std::string sha256;
+};
+
+struct PackSummary {
+    std::size_t images = 0;
+    std::size_t blobs = 0;
+    std::uint64_t image_bytes = 0;
+    std::uint64_t file_bytes = 0;
+};
+
+// Hashes every image while copying it and refuses to pack one whose bytes do
+// not match the manifest's image_sha256.
+PackSummary writeImagePack(const std::filesystem::path& image_root, const std::vector<ManifestRecord>& records,
+                           const std::filesystem::path& output);
+
+// Read-only view of a pack through mmap. The file is advised for sequential
+// readahead on open and prefetch() asks the kernel to fault in the next
+// image while the current one decodes. Without mmap the file is read into
+// memory instead.
+class ImagePack {
+public:
+    explicit ImagePack(const std::filesystem::path& path);
+    ~ImagePack();
+    ImagePack(const ImagePack&) = delete;
+    ImagePack& operator=(const ImagePack&) = delete;
+
+    const PackEntry* find(const std::string& sample_id) const;
+    std::span<const std::uint8_t> bytes(const PackEntry& entry) const;
+    void prefetch(const PackEntry& entry) const;
+    // Every manifest record must be packed with the same image_sha256.
+    void checkManifest(const std::vector<ManifestRecord>& records) const;
+    // Re-hashes the blobs the records use; throws on the first mismatch.
+    std::size_t verify(const std::vector<ManifestRecord>& records) const;
+    std::size_t size() const { return entries_.size(); }
+    std::uint64_t fileBytes() const { return size_; }
+
+private:
+    std::filesystem::path path_;
+    const std::uint8_t* data_ = nullptr;
+    std::uint64_t size_ = 0;
+    std::vector<std::uint8_t> fallback_;
+    std::vector<PackEntry> entries_;
+    std::unordered_map<std::string, std::size_t> index_;
+};
+
+} // namespace bench
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "decoder_adapter.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+
+namespace bench {
+
+// Anonymous shared memory (memfd) that holds the image being decoded. The
+// harness stages each image once and every worker process maps the same
+// pages, so decoders read the pixels in place.
+class SharedImageBuffer {
+public:
+    SharedImageBuffer();
+    ~SharedImageBuffer();
+    SharedImageBuffer(const SharedImageBuffer&) = delete;
+    SharedImageBuffer& operator=(const SharedImageBuffer&) = delete;
+
+    // Copies the pixels into the shared region, growing it when needed, and
+    // returns a view of them. Staging replaces the previously staged image,
+    // so does IsolatedDecoder::decode() of an image the buffer does not hold:
+    // an adapter that feeds its worker derived images, such as a cascade's
+    // pyramid levels, needs a buffer of its own.
+    ImageBuffer stage(const ImageBuffer& image);
+    bool holds(const ImageBuffer& image) const;
+    int fd() const { return fd_; }
+
+private:
+    int fd_ = -1;
+    std::uint8_t* data_ = nullptr;
+    std::size_t capacity_ = 0;
+};
+
+// Runs an adapter in a forked worker process. The factory is invoked in the
+// child, so the decoder library is initialized there and its heap and caches
+// are never shared with the harness or the other decoder. Requests and
+// results travel over a socket pair; pixels stay in the SharedImageBuffer.
+// A worker that dies mid-decode yields a decoder error for that image and is
+// restarted before the next one; cancel() kills the worker outright. POSIX
+// systems with memfd (Linux) only.
+class IsolatedDecoder final : public IDecoderAdapter {
+public:
+    using Factory = std::function<std::unique_ptr<IDecoderAdapter>()>;
+
+    IsolatedDecoder(Factory factory, std::shared_ptr<SharedImageBuffer> images);
+    ~IsolatedDecoder() override;
+    IsolatedDecoder(const IsolatedDecoder&) = delete;
+    IsolatedDecoder& operator=(const IsolatedDecoder&) = delete;
+
+    std::string name() const override { return name_; }
+    std::string version() const override { return version_; }
+    DecodeRun decode(const ImageBuffer& image) override;
+    bool setDeadline(std::chrono::milliseconds timeout) override;
+    bool cancel() override;
+    std::size_t restarts() const { return restarts_; }
+
+private:
+    void spawn();
+    std::string reap();
+    bool recover(std::string& error);
+
+    Factory factory_;
+    std::shared_ptr<SharedImageBuffer> images_;
+    std::string name_;
+    std::string version_;
+    std::optional<std::chrono::milliseconds> deadline_;
+    std::atomic<int> pid_{-1};
+    std::atomic<bool> killed_{false};
+    int socket_ = -1;
+    std::size_t restarts_ = 0;
+};
+
+} // namespace bench
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace bench {
+
+// Minimal streaming JSON emitter. Values are appended straight into a
+// caller-owned buffer, so a record can be serialized repeatedly into the same
+// allocation without building a DOM. Invalid UTF-8 in strings is replaced by
+// U+FFFD instead of producing an unparseable document.
+class JsonWriter {
+public:
+    explicit JsonWriter(std::string& output) : out_(output) {}
+
+    JsonWriter& beginObject() { separate(); out_.push_back('{'); comma_ = false; return *this; }
+    JsonWriter& endObject() { out_.push_back('}'); comma_ = true; return *this; }
+    JsonWriter& beginArray() { separate(); out_.push_back('['); comma_ = false; return *this; }
+    JsonWriter& endArray() { out_.push_back(']'); comma_ = true; return *this; }
+    JsonWriter& key(std::string_view name);
+
+    JsonWriter& value(std::string_view text);
+    JsonWriter& value(const char* text) { return value(std::string_view(text)); }
+    JsonWriter& value(const std::string& text) { return value(std::string_view(text)); }
+    JsonWriter& value(bool flag);
+    JsonWriter& value(int number) { return integer(number); }
+    JsonWriter& value(long number) { return integer(number); }
+    JsonWriter& value(long long number) { return integer(number); }
+    JsonWriter& value(unsigned number) { return unsignedInteger(number); }
+    JsonWriter& value(unsigned long number) { return unsignedInteger(number); }
+    JsonWriter& value(unsigned long long number) { return unsignedInteger(number); }
+    JsonWriter& value(double number);
+    JsonWriter& null();
+    template <typename T>
+    JsonWriter& value(const std::optional<T>& optional) { return optional ? value(*optional) : null(); }
+    JsonWriter& hexValue(std::span<const std::uint8_t> bytes);
+    // Appends an already serialized JSON value verbatim.
+    JsonWriter& raw(std::string_view json);
+
+    template <typename T>
+    JsonWriter& field(std::string_view name, const T& item) { key(name); return value(item); }
+
+private:
+    JsonWriter& integer(long long number);
+    JsonWriter& unsignedInteger(unsigned long long number);
+    void separate() { if (comma_) out_.push_back(','); comma_ = true; }
+
+    std::string& out_;
+    bool comma_ = false;
+};
+
+void appendJsonEscaped(std::string& output, std::string_view text);
+void appendHex(std::string& output, std::span<const std::uint8_t> bytes);
+
+} // namespace bench
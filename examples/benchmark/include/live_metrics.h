@@ -0,0 +1,78 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace bench {
+
+struct LiveMetricsOptions {
+    // Prometheus text file rewritten every interval (textfile-collector
+    // style: written to a temporary and renamed); empty disables it.
+    std::filesystem::path textfile;
+    // Serves GET /metrics on 127.0.0.1; 0 picks a free port. POSIX only.
+    std::optional<int> http_port;
+    std::chrono::milliseconds interval{10000};
+    // Decode times kept per decoder for the rolling latency quantiles.
+    std::size_t latency_window = 1024;
+};
+
+// Progress counters for a long run, readable while it is still going. The
+// run loop reports every record and every finished sample; a background
+// thread refreshes the text file and answers scrapes.
+class LiveMetrics {
+public:
+    LiveMetrics(std::size_t total_samples, LiveMetricsOptions options);
+    ~LiveMetrics();
+    LiveMetrics(const LiveMetrics&) = delete;
+    LiveMetrics& operator=(const LiveMetrics&) = delete;
+
+    void record(const std::string& decoder, std::int64_t decode_ns, std::size_t correct, std::size_t eligible,
+                bool error, bool timed_out);
+    // A sample whose records were all written; resumed ones do not count
+    // toward the throughput.
+    void sampleDone(bool resumed = false);
+    // For adaptive repetitions: at most this many more samples will finish.
+    // The total is then exported as bench_samples_max and the ETA becomes an
+    // upper bound; call it again as images converge.
+    void setRemainingMax(std::size_t remaining);
+    std::string render() const;
+    void writeTextfile() const;
+    int port() const { return port_; }
+
+private:
+    struct DecoderStats {
+        std::uint64_t decodes = 0, errors = 0, timeouts = 0, correct = 0, eligible = 0;
+        std::int64_t decode_ns = 0;
+        std::vector<std::int64_t> window;
+        std::size_t next = 0;
+    };
+
+    void run();
+    void serveOne();
+
+    std::size_t total_;
+    bool maximum_ = false;
+    const LiveMetricsOptions options_;
+    const std::chrono::steady_clock::time_point started_ = std::chrono::steady_clock::now();
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    std::map<std::string, DecoderStats> decoders_;
+    std::size_t done_ = 0;
+    std::size_t resumed_ = 0;
+    double recent_rate_ = 0;
+    bool stop_ = false;
+    int listen_fd_ = -1;
+    int port_ = 0;
+    std::thread thread_;
+};
+
+} // namespace bench
@@ -1,9 +1,101 @@
 #pragma once
+#include <array>
+#include <cstdint>
 #include <filesystem>
+#include <functional>
 #include <nlohmann/json.hpp>
+#include <span>
+#include <string>
 #include <utility>
 #include <vector>
 
 namespace bench {
-std::pair<double,double> wilsonInterval(std::uint64_t successes,std::uint64_t total);
+// Successes may be fractional, e.g. a symbol read in half its repetitions.
+std::pair<double,double> wilsonInterval(double successes,std::uint64_t total);
+// Newcombe hybrid score interval for p_candidate - p_baseline, built from the
+// two Wilson intervals above.
+std::pair<double,double> newcombeDifferenceInterval(double baseline_successes,std::uint64_t baseline_total,
+                                                    double candidate_successes,std::uint64_t candidate_total);
+
+// Wilcoxon signed-rank test on paired differences. Zero differences are
+// dropped, ties get average ranks, and the p-value is two-sided from the
+// tie-corrected normal approximation with continuity correction. Positive z
+// means the differences are mostly positive.
+struct WilcoxonResult {
+    std::size_t nonzero=0;
+    double w_plus=0;
+    double z=0;
+    double p_value=1;
+};
+WilcoxonResult wilcoxonSignedRank(const std::vector<double>& differences);
+
+// Two-sided 95% Student t critical value: tabulated up to 30 degrees of
+// freedom, then the first Cornish-Fisher term around the normal quantile.
+double studentT95(std::size_t degrees_of_freedom);
+
+// Percentile bootstrap over n paired observations. The statistic is handed
+// the resampled observation indices of each replicate and may be called from
+// several threads at once. Replicate r draws from its own stream derived from
+// (seed, r), so intervals do not depend on the thread count; threads=0 uses
+// every hardware thread.
+std::pair<double,double> bootstrapInterval(std::size_t n,const std::function<double(std::span<const std::size_t>)>& statistic,
+                                           int resamples=2000,std::uint64_t seed=1,double confidence=0.95,int threads=0);
+
+// 95% bootstrap intervals for the mean and the nearest-rank quantiles of a
+// sorted latency sample, in the sample's units. A replicate only needs how
+// often each observation was drawn, so it is a count vector scanned once for
+// every statistic instead of a sorted copy.
+struct LatencyIntervals {
+    std::pair<double,double> mean{0,0};
+    std::vector<std::pair<double,double>> quantiles;
+};
+LatencyIntervals bootstrapLatency(std::span<const std::int64_t> sorted,std::span<const double> quantiles,
+                                  int resamples=1000,std::uint64_t seed=1,int threads=0);
+
+// Fixed-memory latency histogram for streaming quantiles. Buckets are
+// log-linear (32 sub-buckets per power of two), so any quantile is reported
+// within about 3% of the exact value regardless of how many samples arrive.
+class LatencyHistogram {
+public:
+    void add(std::int64_t ns);
+    void merge(const LatencyHistogram& other);
+    std::uint64_t count() const { return count_; }
+    std::int64_t total() const { return total_; }
+    double mean() const { return count_?double(total_)/double(count_):0.0; }
+    std::int64_t quantile(double q) const;
+    // One bucket midpoint per recorded sample, in ascending order.
+    std::vector<std::int64_t> values() const;
+    static constexpr int kSubBits=5;
+    static constexpr int kBuckets=64<<kSubBits;
+private:
+    std::vector<std::uint64_t> buckets_;
+    std::uint64_t count_=0;
+    std::int64_t total_=0;
+};
+
+// Stratified ratio estimate sum(w*y)/sum(w*x) over a weighted subset, where
+// w is how many population units each sampled unit stands for. The standard
+// error is the linearized one for stratified sampling without replacement;
+// strata holding a single sampled unit borrow the pooled residual variance.
+// Use x=1 for a mean (latency) and x=eligible instances for recall.
+struct StratifiedUnit {
+    std::string stratum;
+    double weight=1;
+    double y=0;
+    double x=1;
+};
+struct StratifiedEstimate {
+    double value=0;
+    double standard_error=0;
+    double population=0;
+    std::size_t samples=0;
+    std::size_t strata=0;
+};
+StratifiedEstimate stratifiedRatio(const std::vector<StratifiedUnit>& units);
+
+// Half-open bucket edges [edge[i-1], edge[i]); values below the first edge and
+// at or above the last edge get their own open-ended buckets.
+std::size_t bucketIndex(const std::vector<double>& edges,double value);
+std::string bucketLabel(const std::vector<double>& edges,std::size_t index);
+std::vector<double> parseBucketEdges(const std::string& text);
 }
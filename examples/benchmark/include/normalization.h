@@ -11,6 +11,11 @@ std::string normalizedPayload(std::string_view format, std::string_view payload)
 bool isUnreliablePlaceholder(std::string_view payload);
 bool isSpecificBarberFormat(std::string_view value);
 bool isPayloadStructurallyValid(std::string_view format, std::string_view payload);
+// Decoder names may carry a configuration label ("dynamsoft-dbr:SpeedFirst");
+// format support depends only on the family before the colon. A racing
+// decoder ("race:zxing-cpp+dynamsoft-dbr") supports its members' union, and
+// a cascade ("cascade:dynamsoft-dbr:SpeedFirst") what its inner decoder does.
+std::string_view decoderFamily(std::string_view decoder);
 bool isFormatSupported(std::string_view decoder, std::string_view canonical_format);
 const std::unordered_set<std::string>& zxingSupportedFormats();
 const std::unordered_set<std::string>& dbrSupportedFormats();
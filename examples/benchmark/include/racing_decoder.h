@@ -0,0 +1,74 @@
+#pragma once
+
+#include "decoder_adapter.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace bench {
+
+// Runs several adapters concurrently on the same image and answers with the
+// first one that returns results without an error. Each member keeps its own
+// thread for the decoder's lifetime. Once a winner is in, cancel() is called
+// on the other members when cancel_losers is set, but neither the ZXing nor
+// the DBR adapter can be interrupted, and isolated members are not cancelled
+// because that kills the worker and the next race would wait for a respawn.
+// In practice losers run to completion and their results are discarded.
+// decode() returns after every member has stopped, so the caller's image is
+// never read after it returns. decode_time is the time to the winning answer
+// (or to the last member when none finds anything), and wall_time is the time
+// until the slowest member stopped, which is what limits throughput.
+// thread_cpu_time sums every member's decode thread, losers included;
+// process_cpu_time is this process's CPU over the race, so it misses isolated
+// members' workers.
+//
+// The name is "race:<member>+<member>..."; isFormatSupported() treats a race
+// as supporting the union of its members' formats. Records name the winning
+// member in DecodeRun::resolved_by, or "none".
+class RacingDecoder final : public IDecoderAdapter {
+public:
+    explicit RacingDecoder(std::vector<std::unique_ptr<IDecoderAdapter>> members, bool cancel_losers = true);
+    ~RacingDecoder() override;
+    RacingDecoder(const RacingDecoder&) = delete;
+    RacingDecoder& operator=(const RacingDecoder&) = delete;
+
+    std::string name() const override { return name_; }
+    std::string version() const override { return version_; }
+    DecodeRun decode(const ImageBuffer& image) override;
+    // Native only when every member enforces it natively.
+    bool setDeadline(std::chrono::milliseconds timeout) override;
+    bool cancel() override;
+
+private:
+    struct Lane {
+        std::unique_ptr<IDecoderAdapter> decoder;
+        std::string name;
+        std::thread thread;
+        DecodeRun run;
+        std::chrono::steady_clock::time_point finished;
+        bool busy = false;
+    };
+
+    void runLane(std::size_t index);
+
+    std::vector<Lane> lanes_;
+    std::string name_;
+    std::string version_;
+    std::mutex mutex_;
+    std::condition_variable start_;
+    std::condition_variable done_;
+    const ImageBuffer* image_ = nullptr;
+    std::uint64_t generation_ = 0;
+    std::size_t pending_ = 0;
+    std::optional<std::size_t> winner_;
+    bool cancel_losers_ = true;
+    bool stop_ = false;
+};
+
+} // namespace bench
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace bench {
+
+// Set of result keys (see recordKey) for resume checks on large result
+// streams. Keys are indexed by a 64-bit hash in a flat open-addressing table;
+// the full keys live in a single arena and are compared only when a probe hits
+// a slot with the same hash, so a lookup costs one hash and usually one cache
+// line.
+class RecordKeySet {
+public:
+    bool insert(std::string_view key);
+    bool contains(std::string_view key) const;
+    std::size_t count(std::string_view key) const { return contains(key) ? 1 : 0; }
+    std::size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    void clear();
+
+private:
+    struct Slot {
+        std::uint64_t hash = 0;
+        std::uint64_t offset = 0;
+        std::uint32_t length = 0;
+    };
+    std::size_t find(std::string_view key, std::uint64_t hash) const;
+    void grow();
+
+    std::vector<Slot> slots_;
+    std::string arena_;
+    std::size_t size_ = 0;
+};
+
+std::uint64_t keyHash(std::string_view key);
+
+// Extracts the recordKey of one results.jsonl line by scanning for the
+// top-level sample_id, decoder and repetition fields, without building a DOM.
+// Lines the scanner cannot handle cheaply (escaped strings, missing fields)
+// fall back to a full parse, which throws on malformed input.
+std::string scanRecordKey(std::string_view line);
+
+} // namespace bench
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace bench {
+
+// Hardware tier a run emulates. "host" leaves the machine alone; "edge"
+// models a 2-core, 1 GB device: the run is confined to two CPUs, a cgroup v2
+// cpu.max quota of two CPUs is applied when the cgroup can be delegated, and
+// every decoder worker gets a 1 GB memory cap.
+struct ResourceProfile {
+    std::string name = "host";
+    std::size_t cpus = 0;                 // CPUs to confine the run to; 0 keeps all
+    std::optional<double> cpu_quota;      // cpu.max bandwidth in CPUs
+    std::size_t memory_limit_bytes = 0;   // per decoder worker; 0 = unlimited
+};
+
+// Presets for "host" and "edge"; anything else throws.
+ResourceProfile resourceProfile(std::string_view name);
+
+// The CPUs this thread may run on, ascending.
+std::vector<int> allowedCpus();
+
+// Lets the calling process map at most `bytes` more than it maps now
+// (RLIMIT_AS). Called first thing in a forked worker, so what the worker
+// inherits from the harness, such as an image pack mapping or the cache
+// thrash buffer, does not count against the cap.
+void limitAddressSpace(std::size_t bytes);
+
+// A leaf cgroup v2 group next to the harness that holds the decoder workers,
+// with cpu.max and memory.max set from a profile. create() returns null and
+// fills `reason` when cgroup v2 is absent or the subtree is not delegated
+// to this user, so callers can fall back to RLIMIT_AS.
+class WorkerCgroup {
+public:
+    static std::unique_ptr<WorkerCgroup> create(const ResourceProfile& profile, std::string& reason,
+                                                const std::filesystem::path& cgroup_root = "/sys/fs/cgroup",
+                                                const std::filesystem::path& proc = "/proc");
+    ~WorkerCgroup();
+    WorkerCgroup(const WorkerCgroup&) = delete;
+    WorkerCgroup& operator=(const WorkerCgroup&) = delete;
+
+    // Moves the calling process into the group; call it in the worker.
+    void join() const;
+    // The memory controller's oom_kill count, so a SIGKILLed worker can be
+    // told apart from one that crashed.
+    std::uint64_t oomKills() const;
+    bool limitsMemory() const { return memory_limited_; }
+    const std::filesystem::path& path() const { return path_; }
+
+private:
+    WorkerCgroup(std::filesystem::path path, bool memory_limited) : path_(std::move(path)), memory_limited_(memory_limited) {}
+    std::filesystem::path path_;
+    bool memory_limited_ = false;
+};
+
+} // namespace bench
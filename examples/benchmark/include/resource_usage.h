@@ -0,0 +1,21 @@
+#pragma once
+
+#include "benchmark_types.h"
+#include <cstdint>
+
+namespace bench {
+
+// CPU clocks and scheduler counters sampled around a decoder call. Wall time
+// alone hides decoders that fan out to internal threads; the process CPU
+// delta includes those threads while the thread CPU delta does not.
+struct ResourceSnapshot {
+    std::int64_t thread_cpu_ns = 0;
+    std::int64_t process_cpu_ns = 0;
+    std::int64_t voluntary_context_switches = 0;
+    std::int64_t involuntary_context_switches = 0;
+};
+
+ResourceSnapshot captureResources();
+void recordResourceDelta(DecodeRun& run, const ResourceSnapshot& begin, const ResourceSnapshot& end);
+
+} // namespace bench
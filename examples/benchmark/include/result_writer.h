@@ -1,10 +1,12 @@
 #pragma once
 
 #include "benchmark_types.h"
+#include "record_keys.h"
 #include <filesystem>
-#include <set>
+#include <optional>
 #include <string>
 #include <string_view>
+#include <vector>
 
 namespace bench {
 
@@ -15,16 +17,38 @@ struct RawResultRecord {
     std::string decoder;
     std::string decoder_version;
     std::string config_sha256;
+    // environmentHash() of the machine the record was measured on.
+    std::string environment_sha256;
     int repetition = 0;
+    std::string image_loader;
+    int image_scale = 1;
     std::int64_t image_load_ns = 0;
+    // "warm", "cold" or "both"; see --cache-state. In "both" mode run holds
+    // the warm decode and cold_decode_ns the evicted one before it.
+    std::string cache_state = "warm";
+    std::optional<std::int64_t> cold_decode_ns;
+    // Hardware tier from --profile ("host" or "edge").
+    std::string profile = "host";
+    // Node from --numa-node the runner was bound to; unset when unbound.
+    std::optional<int> numa_node;
     DecodeRun run;
     std::vector<MatchItem> matches;
 };
 
+// Edges for the latency/recall breakdowns in summary.json. Megapixels are
+// measured on the decoded image, so --loader-scale moves images down a bucket.
+struct SummaryOptions {
+    std::vector<double> megapixel_buckets{0.5, 1, 2, 4, 8, 16};
+    std::vector<double> ppe_buckets{1.5, 2, 3, 4, 6};
+    // Replicates behind every latency *_ci95 interval; 0 disables them.
+    int bootstrap_resamples = 1000;
+};
+
 std::string recordKey(std::string_view sample_id, std::string_view decoder, int repetition);
-std::set<std::string> completedKeys(const std::filesystem::path& jsonl);
+RecordKeySet completedKeys(const std::filesystem::path& jsonl);
 void appendResult(const std::filesystem::path& jsonl, const RawResultRecord& record);
-void generateSummary(const std::filesystem::path& jsonl, const std::filesystem::path& output);
+void generateSummary(const std::filesystem::path& jsonl, const std::filesystem::path& output,
+                     const SummaryOptions& options = SummaryOptions{});
 void generateResultsJson(const std::filesystem::path& jsonl,
                          const std::filesystem::path& summary,
                          const std::filesystem::path& output);
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "benchmark_types.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+// Stratified quick-run selection. Images are grouped by format set, symbol
+// count, megapixel bucket, smallest-PPE bucket and annotation source; the
+// size is split across strata in proportion to their population with at
+// least one image each, and images are drawn at random within a stratum.
+// Every selected image carries weight = stratum population / stratum picks,
+// so weighted means over the subset estimate the full manifest.
+struct SubsetOptions {
+    std::size_t size = 100;
+    std::uint64_t seed = 1;
+    std::vector<double> megapixel_buckets{0.5, 1, 2, 4, 8, 16};
+    std::vector<double> ppe_buckets{1.5, 2, 3, 4, 6};
+};
+
+struct SubsetResult {
+    std::vector<ManifestRecord> records;    // manifest order, stratum and weight set
+    std::vector<std::string> dimensions;    // stratification dimensions actually used
+    std::size_t strata = 0;
+    std::size_t population = 0;
+};
+
+// The stratum key of one image over the first `dimensions` of
+// format, symbols, megapixels, ppe and source.
+std::string subsetStratum(const ManifestRecord& record, const SubsetOptions& options, std::size_t dimensions = 5);
+
+// When there are more strata than the requested size, the trailing
+// dimensions are dropped (source first, format last) until every stratum
+// can get an image. A size at or above the population returns it whole.
+SubsetResult selectSubset(const std::vector<ManifestRecord>& population, const SubsetOptions& options);
+
+} // namespace bench
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "benchmark_types.h"
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace bench {
+
+// One symbol rasterized at one pixel per matrix cell; 1 marks a dark cell.
+// Linear symbologies may be returned with a single row.
+struct SymbolMatrix {
+    int width = 0;
+    int height = 0;
+    std::vector<std::uint8_t> cells;
+    bool dark(int x, int y) const { return cells[static_cast<std::size_t>(y) * width + x] != 0; }
+};
+
+// Renders a payload into a SymbolMatrix. Implementations must be safe to call
+// from several generator threads at once.
+class ISymbolEncoder {
+public:
+    virtual ~ISymbolEncoder() = default;
+    virtual std::string name() const = 0;
+    virtual std::vector<std::string> formats() const = 0;
+    virtual bool encode(std::string_view canonical_format, std::string_view text,
+                        SymbolMatrix& output, std::string& error) const = 0;
+};
+
+std::unique_ptr<ISymbolEncoder> createZxingEncoder();
+
+struct SynthOptions {
+    std::filesystem::path output;
+    std::size_t count = 1000;
+    std::vector<std::string> formats;
+    std::vector<double> module_sizes{2, 3, 4, 6};
+    double max_rotation_deg = 30.0;
+    double max_blur = 1.5;
+    double max_noise = 8.0;
+    int max_symbols = 3;
+    int width = 1280;
+    int height = 960;
+    std::string image_format = "jpg";
+    std::uint64_t seed = 1;
+    int threads = 1;
+};
+
+struct SynthSummary {
+    std::size_t images = 0;
+    std::size_t symbols = 0;
+    std::size_t skipped_symbols = 0;
+};
+
+// Random payload that is structurally valid for the canonical format,
+// including GTIN check digits.
+std::string syntheticPayload(std::string_view canonical_format, std::mt19937_64& rng);
+
+// Writes <output>/images/... and <output>/manifest.jsonl. Every image is
+// derived from (seed, index) alone, so output is identical for any thread
+// count and a corpus can be regenerated instead of copied.
+SynthSummary generateSyntheticCorpus(const SynthOptions& options, const ISymbolEncoder& encoder);
+
+} // namespace bench
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+
+namespace bench {
+
+namespace detail {
+extern std::atomic<bool> trace_enabled;
+}
+
+// Span recorder for the run loop, exported in Chrome trace-event format so a
+// run can be opened in chrome://tracing or Perfetto. Each recording thread
+// owns a fixed ring of events_per_thread spans and appends to it without
+// locking; when a ring is full its oldest spans are overwritten.
+void startTrace(std::size_t events_per_thread = 1 << 16);
+void stopTrace();
+inline bool traceEnabled() { return detail::trace_enabled.load(std::memory_order_relaxed); }
+
+// Labels the calling thread in the exported trace.
+void nameTraceThread(std::string_view name);
+std::int64_t traceClock();
+void recordTraceSpan(const char* name, std::string_view sample_id, std::string_view detail,
+                     std::int64_t begin_ns, std::int64_t end_ns);
+
+// Writes every span still held in the rings and returns how many were
+// written. Call it while the recording threads are idle.
+std::size_t writeTrace(const std::filesystem::path& output);
+
+// Records the lifetime of a scope. When tracing is off the span costs one
+// relaxed load. name must be a string literal; sample_id and detail are
+// copied when the span closes, so they only need to outlive the span.
+class TraceSpan {
+public:
+    explicit TraceSpan(const char* name, std::string_view sample_id = {}, std::string_view detail = {})
+    {
+        if (!traceEnabled()) return;
+        name_ = name;
+        sample_id_ = sample_id;
+        detail_ = detail;
+        begin_ = traceClock();
+    }
+    ~TraceSpan()
+    {
+        if (name_) recordTraceSpan(name_, sample_id_, detail_, begin_, traceClock());
+    }
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    const char* name_ = nullptr;
+    std::string_view sample_id_;
+    std::string_view detail_;
+    std::int64_t begin_ = 0;
+};
+
+} // namespace bench
@@ -0,0 +1,138 @@
+#include "adaptive_repetitions.h"
+
+#include "json_writer.h"
+#include "metrics.h"
+
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+namespace bench {
+using json = nlohmann::json;
+
+AdaptiveRepetitions::AdaptiveRepetitions(AdaptiveOptions options) : options_(options)
+{
+    if (!(options_.relative_precision > 0)) throw std::runtime_error("--adaptive-precision must be positive");
+    if (options_.min_repetitions < 2) throw std::runtime_error("adaptive repetitions need at least two runs per image");
+    if (options_.max_repetitions < options_.min_repetitions)
+        throw std::runtime_error("--repetitions must be at least --min-repetitions in adaptive mode");
+}
+
+void AdaptiveRepetitions::load(const std::filesystem::path& jsonl)
+{
+    std::ifstream in(jsonl, std::ios::binary);
+    if (!in) return;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty()) continue;
+        const auto value = json::parse(line);
+        const bool failed = !value["error"].is_null() || value.value("timed_out", false);
+        add(value.at("sample_id").get<std::string>(), value.at("decoder").get<std::string>(),
+            value.value("decode_ns", std::int64_t{0}), failed);
+    }
+}
+
+void AdaptiveRepetitions::add(const std::string& sample_id, const std::string& decoder, std::int64_t decode_ns, bool failed)
+{
+    auto& unit = units_[{decoder, sample_id}];
+    ++unit.calls;
+    if (failed) { unit.failed = true; return; }
+    ++unit.count;
+    const double delta = static_cast<double>(decode_ns) - unit.mean_ns;
+    unit.mean_ns += delta / static_cast<double>(unit.count);
+    unit.m2 += delta * (static_cast<double>(decode_ns) - unit.mean_ns);
+}
+
+double AdaptiveRepetitions::relativeHalfWidth(const Unit& unit) const
+{
+    if (unit.count < 2) return std::numeric_limits<double>::infinity();
+    if (unit.mean_ns <= 0) return 0;
+    const double standard_error = std::sqrt(unit.m2 / static_cast<double>(unit.count - 1) / static_cast<double>(unit.count));
+    return studentT95(unit.count - 1) * standard_error / unit.mean_ns;
+}
+
+double AdaptiveRepetitions::relativeHalfWidth(const std::string& sample_id, const std::string& decoder) const
+{
+    const auto found = units_.find({decoder, sample_id});
+    return found == units_.end() ? std::numeric_limits<double>::infinity() : relativeHalfWidth(found->second);
+}
+
+bool AdaptiveRepetitions::needsMore(const std::string& sample_id, const std::string& decoder) const
+{
+    const auto found = units_.find({decoder, sample_id});
+    if (found == units_.end()) return true;
+    const auto& unit = found->second;
+    if (unit.failed) return false;
+    const auto calls = static_cast<int>(unit.calls);
+    if (calls < options_.min_repetitions) return true;
+    return calls < options_.max_repetitions && relativeHalfWidth(unit) > options_.relative_precision;
+}
+
+AdaptiveReport AdaptiveRepetitions::report() const
+{
+    AdaptiveReport result;
+    std::size_t units = 0;
+    int overall_max = 0;
+    std::vector<double> widths;
+    for (auto it = units_.begin(); it != units_.end();) {
+        AdaptiveDecoderReport decoder;
+        decoder.decoder = it->first.first;
+        double mean_sum = 0;
+        std::size_t timed = 0;
+        widths.clear();
+        for (; it != units_.end() && it->first.first == decoder.decoder; ++it) {
+            const auto& unit = it->second;
+            ++decoder.units;
+            decoder.decode_calls += unit.calls;
+            if (unit.failed) ++decoder.failed;
+            else if (relativeHalfWidth(unit) <= options_.relative_precision) ++decoder.converged;
+            else ++decoder.capped;
+            if (!unit.failed) decoder.max_repetitions_used = std::max(decoder.max_repetitions_used, static_cast<int>(unit.calls));
+            if (unit.count) { mean_sum += unit.mean_ns / 1e6; ++timed; }
+            if (unit.count >= 2) widths.push_back(relativeHalfWidth(unit));
+        }
+        decoder.fixed_equivalent_calls = decoder.units * static_cast<std::size_t>(decoder.max_repetitions_used);
+        decoder.mean_decode_ms = timed ? mean_sum / static_cast<double>(timed) : 0;
+        if (!widths.empty()) {
+            const auto middle = widths.begin() + static_cast<std::ptrdiff_t>(widths.size() / 2);
+            std::nth_element(widths.begin(), middle, widths.end());
+            decoder.median_relative_half_width = *middle;
+        }
+        units += decoder.units;
+        overall_max = std::max(overall_max, decoder.max_repetitions_used);
+        result.decode_calls += decoder.decode_calls;
+        result.decoders.push_back(std::move(decoder));
+    }
+    result.fixed_equivalent_calls = units * static_cast<std::size_t>(overall_max);
+    return result;
+}
+
+void writeAdaptiveReport(const AdaptiveReport& report, const AdaptiveOptions& options, const std::filesystem::path& output)
+{
+    std::string buffer;
+    JsonWriter out(buffer);
+    out.beginObject().field("relative_precision", options.relative_precision)
+       .field("min_repetitions", options.min_repetitions).field("max_repetitions", options.max_repetitions)
+       .field("decode_calls", report.decode_calls).field("fixed_equivalent_calls", report.fixed_equivalent_calls)
+       .field("saved_calls", report.savedCalls()).key("decoders").beginObject();
+    for (const auto& decoder : report.decoders) {
+        out.key(decoder.decoder).beginObject()
+           .field("images", decoder.units).field("converged", decoder.converged).field("capped", decoder.capped)
+           .field("failed", decoder.failed).field("decode_calls", decoder.decode_calls)
+           .field("max_repetitions_used", decoder.max_repetitions_used)
+           .field("fixed_equivalent_calls", decoder.fixed_equivalent_calls)
+           .field("mean_decode_ms", decoder.mean_decode_ms)
+           .field("median_relative_half_width", decoder.median_relative_half_width).endObject();
+    }
+    out.endObject().endObject();
+    buffer.push_back('\n');
+    if (output.has_parent_path()) std::filesystem::create_directories(output.parent_path());
+    std::ofstream file(output, std::ios::binary);
+    file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    if (!file) throw std::runtime_error("cannot write adaptive report: " + output.string());
+}
+
+} // namespace bench
@@ -41,11 +41,13 @@ json manifestJson(const ManifestRecord& record)
 {
     json truth = json::array();
     for (const auto& gt : record.ground_truth) truth.push_back(groundTruthJson(gt));
-    return {
+    json result = {
         {"sample_id", record.sample_id}, {"relative_path", record.relative_path},
         {"annotation_file", record.annotation_file}, {"image_sha256", record.image_sha256},
         {"width", record.width}, {"height", record.height}, {"ground_truth", truth}
     };
+    if (!record.stratum.empty()) { result["stratum"] = record.stratum; result["weight"] = record.weight; }
+    return result;
 }
 
 ManifestRecord parseManifestRecord(const json& item)
@@ -56,6 +58,7 @@ ManifestRecord parseManifestRecord(const json& item)
     r.annotation_file = item.at("annotation_file").get<std::string>();
     r.image_sha256 = item.value("image_sha256", "");
     r.width = item.value("width", 0); r.height = item.value("height", 0);
+    r.stratum = item.value("stratum", ""); r.weight = item.value("weight", 1.0);
     for (const auto& value : item.at("ground_truth")) {
         GroundTruth gt;
         gt.annotation_id = value.at("annotation_id").get<std::string>();
@@ -113,6 +116,16 @@ void BarberDataset::writeManifest(const std::filesystem::path& path,
     for (const auto& record : records) out << manifestJson(record).dump() << '\n';
 }
 
+std::string BarberDataset::manifestLine(const ManifestRecord& record)
+{
+    return manifestJson(record).dump();
+}
+
+ManifestRecord BarberDataset::parseManifestLine(std::string_view line)
+{
+    return parseManifestRecord(json::parse(line));
+}
+
 std::vector<ManifestRecord> BarberDataset::readManifest(const std::filesystem::path& path)
 {
     std::ifstream in(path, std::ios::binary);
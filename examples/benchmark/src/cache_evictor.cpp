@@ -0,0 +1,93 @@
+#include "cache_evictor.h"
+
+#include <algorithm>
+#include <charconv>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#include <immintrin.h>
+#define BENCH_HAVE_CLFLUSH 1
+#endif
+
+namespace bench {
+namespace {
+
+constexpr std::size_t kCacheLine = 64;
+
+void flushLines(std::span<const std::uint8_t> buffer)
+{
+#if defined(BENCH_HAVE_CLFLUSH)
+    for (std::size_t offset = 0; offset < buffer.size(); offset += kCacheLine) _mm_clflush(buffer.data() + offset);
+    _mm_mfence();
+#elif defined(__aarch64__)
+    for (std::size_t offset = 0; offset < buffer.size(); offset += kCacheLine)
+        asm volatile("dc civac, %0" : : "r"(buffer.data() + offset) : "memory");
+    asm volatile("dsb ish" : : : "memory");
+#else
+    // No user-space flush here; the thrash pass alone has to evict the image.
+    (void)buffer;
+#endif
+}
+
+} // namespace
+
+std::size_t parseCacheSize(std::string_view text)
+{
+    while (!text.empty() && (text.back() == '\n' || text.back() == ' ')) text.remove_suffix(1);
+    std::size_t value = 0;
+    const auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (result.ec != std::errc()) return 0;
+    const std::string_view unit(result.ptr, static_cast<std::size_t>(text.data() + text.size() - result.ptr));
+    if (unit.empty()) return value;
+    if (unit == "K") return value << 10;
+    if (unit == "M") return value << 20;
+    if (unit == "G") return value << 30;
+    return 0;
+}
+
+std::size_t lastLevelCacheBytes()
+{
+    const std::filesystem::path root = "/sys/devices/system/cpu/cpu0/cache";
+    std::error_code error;
+    int best_level = 0;
+    std::size_t best_size = 0;
+    for (const auto& entry : std::filesystem::directory_iterator(root, error)) {
+        if (entry.path().filename().string().rfind("index", 0) != 0) continue;
+        std::ifstream level_file(entry.path() / "level"), size_file(entry.path() / "size"), type_file(entry.path() / "type");
+        int level = 0;
+        std::string size, type;
+        if (!(level_file >> level) || !(size_file >> size)) continue;
+        type_file >> type;
+        if (type == "Instruction") continue;
+        if (level > best_level || (level == best_level && parseCacheSize(size) > best_size)) {
+            best_level = level;
+            best_size = parseCacheSize(size);
+        }
+    }
+    return best_size;
+}
+
+CacheEvictor::CacheEvictor(std::size_t thrash_bytes)
+{
+    if (!thrash_bytes) {
+        const auto llc = lastLevelCacheBytes();
+        thrash_bytes = llc ? std::min(2 * llc, kMaxDefaultThrash) : std::size_t{64} << 20;
+    }
+    // Written once so every page is backed by real memory; untouched pages
+    // would all map to the shared zero page and evict nothing.
+    thrash_.assign(std::max(thrash_bytes, kCacheLine), 1);
+}
+
+void CacheEvictor::evict(std::span<const std::uint8_t> buffer)
+{
+    flushLines(buffer);
+    // Reads only: dirty lines would make the timed decode pay for their
+    // write-back as it evicts them.
+    std::uint64_t sum = 0;
+    for (std::size_t offset = 0; offset < thrash_.size(); offset += kCacheLine) sum += thrash_[offset];
+    sink_ += sum;
+}
+
+} // namespace bench
@@ -0,0 +1,148 @@
+#include "cascade_decoder.h"
+
+#include "image_loader.h"
+#include "resource_usage.h"
+#include "trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <optional>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+
+namespace bench {
+namespace {
+
+constexpr int kMinimumLevelSide = 32;
+
+void checkLevels(const std::vector<int>& factors)
+{
+    if (factors.empty()) throw std::runtime_error("a cascade needs at least one level");
+    for (std::size_t i = 0; i < factors.size(); ++i) {
+        const int factor = factors[i];
+        if (factor < 1 || (factor & (factor - 1)) != 0)
+            throw std::runtime_error("cascade levels must be powers of two: " + std::to_string(factor));
+        if (i && factor >= factors[i - 1])
+            throw std::runtime_error("cascade levels must go from coarse to fine, such as 4,2,1");
+    }
+}
+
+} // namespace
+
+CascadeDecoder::CascadeDecoder(std::unique_ptr<IDecoderAdapter> inner, std::vector<int> factors, std::size_t expected_symbols)
+    : inner_(std::move(inner)), factors_(std::move(factors)), expected_(std::max<std::size_t>(1, expected_symbols))
+{
+    checkLevels(factors_);
+}
+
+const ImageBuffer* CascadeDecoder::level(const ImageBuffer& image, int factor)
+{
+    std::size_t depth = 0;
+    while ((1 << (depth + 1)) <= factor) ++depth;
+    if (pyramid_.size() < depth) pyramid_.resize(depth);
+    for (; built_ < depth; ++built_) halveImage(built_ ? pyramid_[built_ - 1] : image, pyramid_[built_]);
+    const auto& result = pyramid_[depth - 1];
+    return std::min(result.width, result.height) >= kMinimumLevelSide ? &result : nullptr;
+}
+
+DecodeRun CascadeDecoder::decode(const ImageBuffer& image)
+{
+    const auto resources_begin = captureResources();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cancelled_ = false;
+    }
+    built_ = 0;
+    DecodeRun result;
+    result.resolved_by = "none";
+    std::chrono::nanoseconds thread_cpu{0};
+    std::set<std::pair<std::string, std::string>> seen;
+    std::optional<std::string> error;
+    bool any_succeeded = false;
+    for (const int factor : factors_) {
+        const auto label = cascadeLevelName(factor);
+        const ImageBuffer* source = &image;
+        if (factor > 1) {
+            const auto pyramid_resources = captureResources();
+            const auto begin = std::chrono::steady_clock::now();
+            source = level(image, factor);
+            result.decode_time += std::chrono::steady_clock::now() - begin;
+            thread_cpu += std::chrono::nanoseconds(captureResources().thread_cpu_ns - pyramid_resources.thread_cpu_ns);
+            if (!source) continue;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (cancelled_) break;
+            busy_ = true;
+        }
+        DecodeRun run;
+        try {
+            TraceSpan span("cascade_decode", {}, label);
+            run = inner_->decode(*source);
+        } catch (const std::exception& e) {
+            run.error = e.what();
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            busy_ = false;
+        }
+        result.decode_time += run.decode_time;
+        thread_cpu += run.thread_cpu_time;
+        for (auto& barcode : run.results) {
+            if (!seen.emplace(barcode.canonical_format, barcode.text).second) continue;
+            // Pixel x of a level covers full-resolution pixels
+            // [x * factor, (x + 1) * factor); its centre is used.
+            for (auto& corner : barcode.position) {
+                corner.x = std::clamp(corner.x * factor + (factor - 1) / 2, 0, std::max(0, image.width - 1));
+                corner.y = std::clamp(corner.y * factor + (factor - 1) / 2, 0, std::max(0, image.height - 1));
+            }
+            result.results.push_back(std::move(barcode));
+        }
+        if (run.timed_out) {
+            result.timed_out = true;
+            error = run.error;
+            break;
+        }
+        // A coarse level that fails is not fatal; the next level may still
+        // decode.
+        if (run.error) { error = label + ": " + *run.error; continue; }
+        any_succeeded = true;
+        if (result.results.size() >= expected_) { result.resolved_by = label; break; }
+    }
+    if (result.timed_out || !any_succeeded) result.error = error;
+    recordResourceDelta(result, resources_begin, captureResources());
+    result.thread_cpu_time = thread_cpu;
+    return result;
+}
+
+bool CascadeDecoder::cancel()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    cancelled_ = true;
+    // Isolated decoders kill their worker on cancel(), so the inner decoder
+    // is only told while one of its calls is in flight.
+    return busy_ ? inner_->cancel() : true;
+}
+
+std::vector<int> parseCascadeLevels(std::string_view text)
+{
+    std::vector<int> result;
+    std::stringstream list{std::string(text)};
+    for (std::string item; std::getline(list, item, ',');) {
+        try {
+            result.push_back(std::stoi(item));
+        } catch (const std::logic_error&) {
+            throw std::runtime_error("invalid cascade level: " + item);
+        }
+    }
+    checkLevels(result);
+    return result;
+}
+
+std::string cascadeLevelName(int factor)
+{
+    return "1/" + std::to_string(factor);
+}
+
+} // namespace bench
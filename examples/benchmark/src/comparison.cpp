@@ -0,0 +1,202 @@
+#include "comparison.h"
+
+#include "json_writer.h"
+#include "metrics.h"
+#include "normalization.h"
+
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace bench {
+using json = nlohmann::json;
+namespace {
+
+struct Tally {
+    double correct = 0;
+    std::uint64_t eligible = 0;
+};
+
+struct SampleRuns {
+    double decode_ns = 0;
+    int runs = 0;
+    std::map<std::string, Tally> recall;
+};
+
+using DecoderSamples = std::map<std::string, std::unordered_map<std::string, SampleRuns>>;
+
+DecoderSamples loadSamples(const std::filesystem::path& jsonl)
+{
+    std::ifstream in(jsonl, std::ios::binary);
+    if (!in) throw std::runtime_error("cannot read results: " + jsonl.string());
+    DecoderSamples samples;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty()) continue;
+        const auto value = json::parse(line);
+        auto& sample = samples[value.at("decoder").get<std::string>()][value.at("sample_id").get<std::string>()];
+        sample.decode_ns += value.value("decode_ns", 0.0);
+        ++sample.runs;
+        const auto& truth = value["ground_truth"];
+        for (const auto& match : value.at("matches")) {
+            if (match["truth_index"].is_null()) continue;
+            const auto format = canonicalFormat(truth.at(match["truth_index"].get<std::size_t>()).value("format", ""));
+            const bool correct = match.at("outcome").get<std::string>() == "correct";
+            for (const auto& key : {format, std::string("ALL")}) {
+                auto& tally = sample.recall[key];
+                ++tally.eligible;
+                if (correct) ++tally.correct;
+            }
+        }
+    }
+    // Every repetition re-scores the same symbols, so the counts are folded
+    // back to one repetition's worth; otherwise the recall interval would
+    // narrow with --repetitions and count noisy (adaptive) samples more. A
+    // symbol read in some repetitions only keeps that fraction.
+    for (auto& [decoder, by_sample] : samples)
+        for (auto& [sample_id, sample] : by_sample)
+            for (auto& [format, tally] : sample.recall) {
+                tally.correct /= sample.runs;
+                tally.eligible /= static_cast<std::uint64_t>(sample.runs);
+            }
+    return samples;
+}
+
+double median(std::vector<double> values)
+{
+    if (values.empty()) return 0;
+    const auto middle = values.begin() + static_cast<std::ptrdiff_t>(values.size() / 2);
+    std::nth_element(values.begin(), middle, values.end());
+    if (values.size() % 2) return *middle;
+    return (*middle + *std::max_element(values.begin(), middle)) / 2;
+}
+
+void writeInterval(JsonWriter& out, std::string_view name, const std::pair<double, double>& interval)
+{
+    out.key(name).beginArray().value(interval.first).value(interval.second).endArray();
+}
+
+} // namespace
+
+bool ComparisonReport::regressed() const
+{
+    return std::any_of(latency.begin(), latency.end(), [](const auto& item) { return item.regressed; }) ||
+           std::any_of(recall.begin(), recall.end(), [](const auto& item) { return item.regressed; });
+}
+
+ComparisonReport compareResults(const std::filesystem::path& baseline_jsonl,
+                                const std::filesystem::path& candidate_jsonl,
+                                const ComparisonOptions& options)
+{
+    const auto baseline = loadSamples(baseline_jsonl);
+    const auto candidate = loadSamples(candidate_jsonl);
+    ComparisonReport report;
+    for (const auto& [decoder, samples] : baseline) {
+        const auto other = candidate.find(decoder);
+        if (other == candidate.end()) { report.baseline_only += samples.size(); continue; }
+        std::vector<double> base_ms, cand_ms, deltas;
+        std::map<std::string, std::pair<Tally, Tally>> formats;
+        for (const auto& [sample_id, runs] : samples) {
+            const auto match = other->second.find(sample_id);
+            if (match == other->second.end()) { ++report.baseline_only; continue; }
+            base_ms.push_back(runs.decode_ns / runs.runs / 1e6);
+            cand_ms.push_back(match->second.decode_ns / match->second.runs / 1e6);
+            deltas.push_back(cand_ms.back() - base_ms.back());
+            for (const auto& [format, tally] : runs.recall) {
+                formats[format].first.correct += tally.correct; formats[format].first.eligible += tally.eligible;
+            }
+            for (const auto& [format, tally] : match->second.recall) {
+                formats[format].second.correct += tally.correct; formats[format].second.eligible += tally.eligible;
+            }
+        }
+        for (const auto& [sample_id, runs] : other->second)
+            if (!samples.count(sample_id)) ++report.candidate_only;
+        if (deltas.empty()) continue;
+
+        LatencyComparison latency;
+        latency.decoder = decoder;
+        latency.pairs = deltas.size();
+        auto relativeChange = [&](std::span<const std::size_t> indices) {
+            double base = 0, cand = 0;
+            for (auto i : indices) { base += base_ms[i]; cand += cand_ms[i]; }
+            return base > 0 ? cand / base - 1 : 0.0;
+        };
+        std::vector<std::size_t> all(deltas.size());
+        for (std::size_t i = 0; i < all.size(); ++i) all[i] = i;
+        for (std::size_t i = 0; i < all.size(); ++i) { latency.baseline_mean_ms += base_ms[i]; latency.candidate_mean_ms += cand_ms[i]; }
+        latency.baseline_mean_ms /= double(all.size());
+        latency.candidate_mean_ms /= double(all.size());
+        latency.relative_change = relativeChange(all);
+        latency.relative_change_ci95 = bootstrapInterval(all.size(), relativeChange, options.bootstrap_resamples, options.seed);
+        latency.median_delta_ms = median(deltas);
+        latency.median_delta_ci95 = bootstrapInterval(all.size(), [&](std::span<const std::size_t> indices) {
+            std::vector<double> resampled;
+            resampled.reserve(indices.size());
+            for (auto i : indices) resampled.push_back(deltas[i]);
+            return median(std::move(resampled));
+        }, options.bootstrap_resamples, options.seed);
+        const auto wilcoxon = wilcoxonSignedRank(deltas);
+        latency.wilcoxon_z = wilcoxon.z;
+        latency.wilcoxon_p = wilcoxon.p_value;
+        latency.regressed = latency.relative_change > options.latency_threshold && wilcoxon.z > 0 && wilcoxon.p_value < 0.05;
+        report.latency.push_back(latency);
+
+        for (const auto& [format, pair] : formats) {
+            RecallComparison recall;
+            recall.decoder = decoder;
+            recall.format = format;
+            recall.baseline_correct = pair.first.correct; recall.baseline_eligible = pair.first.eligible;
+            recall.candidate_correct = pair.second.correct; recall.candidate_eligible = pair.second.eligible;
+            if (!recall.baseline_eligible || !recall.candidate_eligible) continue;
+            recall.delta = recall.candidate_correct / recall.candidate_eligible -
+                           recall.baseline_correct / recall.baseline_eligible;
+            recall.delta_ci95 = newcombeDifferenceInterval(recall.baseline_correct, recall.baseline_eligible,
+                                                           recall.candidate_correct, recall.candidate_eligible);
+            recall.regressed = recall.delta_ci95.second < 0;
+            report.recall.push_back(recall);
+        }
+    }
+    for (const auto& [decoder, samples] : candidate)
+        if (!baseline.count(decoder)) report.candidate_only += samples.size();
+    return report;
+}
+
+void writeComparison(const ComparisonReport& report, const std::filesystem::path& output)
+{
+    std::string buffer;
+    JsonWriter out(buffer);
+    out.beginObject().field("regressed", report.regressed())
+       .field("baseline_only_samples", report.baseline_only).field("candidate_only_samples", report.candidate_only)
+       .key("latency").beginArray();
+    for (const auto& item : report.latency) {
+        out.beginObject().field("decoder", item.decoder).field("pairs", item.pairs)
+           .field("baseline_mean_ms", item.baseline_mean_ms).field("candidate_mean_ms", item.candidate_mean_ms)
+           .field("relative_change", item.relative_change);
+        writeInterval(out, "relative_change_ci95", item.relative_change_ci95);
+        out.field("median_delta_ms", item.median_delta_ms);
+        writeInterval(out, "median_delta_ci95", item.median_delta_ci95);
+        out.field("wilcoxon_z", item.wilcoxon_z).field("wilcoxon_p", item.wilcoxon_p)
+           .field("regressed", item.regressed).endObject();
+    }
+    out.endArray().key("recall").beginArray();
+    for (const auto& item : report.recall) {
+        out.beginObject().field("decoder", item.decoder).field("format", item.format)
+           .field("baseline_correct", item.baseline_correct).field("baseline_eligible", item.baseline_eligible)
+           .field("candidate_correct", item.candidate_correct).field("candidate_eligible", item.candidate_eligible)
+           .field("delta", item.delta);
+        writeInterval(out, "delta_ci95", item.delta_ci95);
+        out.field("regressed", item.regressed).endObject();
+    }
+    out.endArray().endObject();
+    buffer.push_back('\n');
+    if (output.has_parent_path()) std::filesystem::create_directories(output.parent_path());
+    std::ofstream file(output, std::ios::binary);
+    file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    if (!file) throw std::runtime_error("cannot write comparison: " + output.string());
+}
+
+} // namespace bench
@@ -0,0 +1,104 @@
+#include "decode_watchdog.h"
+
+#include "trace.h"
+
+#include <algorithm>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace bench {
+
+DecodeWatchdog::DecodeWatchdog(std::chrono::milliseconds timeout)
+    : timeout_(timeout), thread_([this] { watch(); })
+{
+#ifdef __linux__
+    // Under --sched-fifo the thread inherits the runner's priority, and equal
+    // FIFO threads never preempt each other, so a spinning decode would keep
+    // the deadline from firing. Raise it one level from here rather than in
+    // watch(): on a single CPU the new thread may not run before that decode.
+    if (::sched_getscheduler(0) == SCHED_FIFO) {
+        sched_param parameter{};
+        if (::sched_getparam(0, &parameter) == 0 && parameter.sched_priority < ::sched_get_priority_max(SCHED_FIFO)) {
+            ++parameter.sched_priority;
+            ::pthread_setschedparam(thread_.native_handle(), SCHED_FIFO, &parameter);
+        }
+    }
+#endif
+}
+
+DecodeWatchdog::~DecodeWatchdog()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    thread_.join();
+}
+
+DecodeRun DecodeWatchdog::decode(IDecoderAdapter& decoder, const ImageBuffer& image)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        active_ = &decoder;
+        deadline_ = std::chrono::steady_clock::now() + timeout_;
+        fired_ = false;
+    }
+    wake_.notify_all();
+    const auto begin = std::chrono::steady_clock::now();
+    auto run = decoder.decode(image);
+    const auto elapsed = std::chrono::steady_clock::now() - begin;
+    bool fired = false;
+    {
+        // cancel() runs under this lock, so it can never reach the adapter
+        // after decode() has returned and the next image has started.
+        std::lock_guard<std::mutex> lock(mutex_);
+        active_ = nullptr;
+        fired = fired_;
+    }
+    if (fired || run.timed_out || run.decode_time > timeout_) {
+        run.timed_out = true;
+        run.results.clear();
+        // An interrupted decode may not have timed itself; it ran at least
+        // until it was stopped.
+        run.decode_time = std::max(run.decode_time, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed));
+        run.error = "decode_timeout: exceeded " + std::to_string(timeout_.count()) + " ms";
+    }
+    return run;
+}
+
+std::size_t DecodeWatchdog::overruns() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return overruns_;
+}
+
+std::size_t DecodeWatchdog::cancelled() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return cancelled_;
+}
+
+void DecodeWatchdog::watch()
+{
+    nameTraceThread("watchdog");
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stop_) {
+        if (!active_ || fired_) {
+            wake_.wait(lock);
+            continue;
+        }
+        const auto deadline = deadline_;
+        if (wake_.wait_until(lock, deadline) != std::cv_status::timeout) continue;
+        if (!active_ || fired_ || deadline_ != deadline) continue;
+        fired_ = true;
+        ++overruns_;
+        TraceSpan span("cancel");
+        if (active_->cancel()) ++cancelled_;
+    }
+}
+
+} // namespace bench
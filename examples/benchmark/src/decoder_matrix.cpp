@@ -0,0 +1,92 @@
+#include "decoder_matrix.h"
+
+#include <nlohmann/json.hpp>
+#include <fstream>
+#include <functional>
+#include <numeric>
+#include <random>
+#include <set>
+#include <stdexcept>
+
+namespace bench {
+using json = nlohmann::json;
+namespace {
+
+class RenamedDecoder final : public IDecoderAdapter {
+public:
+    RenamedDecoder(std::unique_ptr<IDecoderAdapter> inner, std::string name)
+        : inner_(std::move(inner)), name_(std::move(name)) {}
+
+    std::string name() const override { return name_; }
+    std::string version() const override { return inner_->version(); }
+    DecodeRun decode(const ImageBuffer& image) override { return inner_->decode(image); }
+    bool setDeadline(std::chrono::milliseconds timeout) override { return inner_->setDeadline(timeout); }
+    bool cancel() override { return inner_->cancel(); }
+
+private:
+    std::unique_ptr<IDecoderAdapter> inner_;
+    std::string name_;
+};
+
+} // namespace
+
+std::string DecoderConfig::name() const
+{
+    return label.empty() ? family : family + ":" + label;
+}
+
+std::vector<DecoderConfig> readDecoderMatrix(const std::filesystem::path& path)
+{
+    std::ifstream in(path);
+    if (!in) throw std::runtime_error("cannot read config matrix: " + path.string());
+    const auto document = json::parse(in);
+    if (!document.contains("decoders") || !document["decoders"].is_array() || document["decoders"].empty())
+        throw std::runtime_error("config matrix needs a non-empty \"decoders\" array: " + path.string());
+    std::vector<DecoderConfig> result;
+    std::set<std::string> names;
+    for (const auto& entry : document["decoders"]) {
+        DecoderConfig config;
+        config.family = entry.at("family").get<std::string>();
+        if (config.family != "zxing-cpp" && config.family != "dynamsoft-dbr")
+            throw std::runtime_error("unknown decoder family in config matrix: " + config.family);
+        config.label = entry.value("label", "");
+        if (config.label.find_first_of(":|+") != std::string::npos)
+            throw std::runtime_error("config matrix labels cannot contain ':', '|' or '+': " + config.label);
+        config.template_name = entry.value("template", config.template_name);
+        if (entry.contains("config")) {
+            config.config = entry["config"].get<std::string>();
+            if (config.config.is_relative()) config.config = path.parent_path() / config.config;
+        }
+        if (!names.insert(config.name()).second)
+            throw std::runtime_error("duplicate decoder in config matrix: " + config.name() + " (give each entry a distinct label)");
+        // ZXing options are fixed in the adapter; its config file is only
+        // hashed, so differing files would label identical decoders apart.
+        for (const auto& other : result)
+            if (config.family == "zxing-cpp" && other.family == "zxing-cpp" && other.config != config.config)
+                throw std::runtime_error("zxing-cpp entries in a config matrix cannot differ in config; ZXing options are fixed in the adapter");
+        result.push_back(std::move(config));
+    }
+    return result;
+}
+
+std::unique_ptr<IDecoderAdapter> renameDecoder(std::unique_ptr<IDecoderAdapter> decoder, std::string name)
+{
+    if (decoder->name() == name) return decoder;
+    return std::make_unique<RenamedDecoder>(std::move(decoder), std::move(name));
+}
+
+std::vector<std::size_t> decoderOrder(std::string_view sample_id, int repetition, std::size_t count)
+{
+    std::vector<std::size_t> order(count);
+    std::iota(order.begin(), order.end(), std::size_t{0});
+    std::mt19937 random(static_cast<unsigned>(std::hash<std::string>{}(std::string(sample_id)) ^ static_cast<std::size_t>(repetition)));
+    // j = i - r % (i + 1) keeps the draw uniform and, for two decoders,
+    // swaps exactly when r is odd as the original two-way shuffle did.
+    for (std::size_t i = count; i-- > 1;) {
+        const auto j = i - random() % (i + 1);
+        std::swap(order[i], order[j]);
+    }
+    return order;
+}
+
+} // namespace bench
@@ -1,5 +1,6 @@
 #include "decoder_adapter.h"
 #include "normalization.h"
+#include "resource_usage.h"
 
 #include <DynamsoftCaptureVisionRouter.h>
 #include <DynamsoftUtility.h>
@@ -53,21 +54,35 @@ public:
         if (router_) router_->StopCapturing(false, true);
     }
 
+    bool setDeadline(std::chrono::milliseconds timeout) override
+    {
+        // Capture() is synchronous and cannot be interrupted from another
+        // thread, but the router enforces its own per-image time budget.
+        SimplifiedCaptureVisionSettings settings{};
+        if (router_->GetSimplifiedSettings(template_name_.c_str(), &settings) != EC_OK) return false;
+        settings.timeout = static_cast<int>(timeout.count());
+        char error[1024] = {};
+        return router_->UpdateSettings(template_name_.c_str(), &settings, error, sizeof(error)) == EC_OK;
+    }
+
     std::string name() const override { return "dynamsoft-dbr"; }
     std::string version() const override { return CBarcodeReaderModule::GetVersion(); }
 
     DecodeRun decode(const ImageBuffer& image) override
     {
         DecodeRun run;
-        CImageData input(image.rgb.size(), image.rgb.data(), image.width, image.height,
+        CImageData input(image.size(), image.data(), image.width, image.height,
                          image.stride, IPF_RGB_888);
+        const auto resources = captureResources();
         const auto begin = std::chrono::steady_clock::now();
         CCapturedResult* captured = router_->Capture(&input, template_name_.c_str());
         run.decode_time = std::chrono::steady_clock::now() - begin;
+        recordResourceDelta(run, resources, captureResources());
         if (!captured) {
             run.error = "Dynamsoft returned a null captured result";
             return run;
         }
+        if (captured->GetErrorCode() == EC_TIMEOUT) run.timed_out = true;
         if (captured->GetErrorCode() != EC_OK) {
             run.error = captured->GetErrorString() ? captured->GetErrorString() : "Dynamsoft decode error";
             captured->Release();
@@ -86,6 +101,9 @@ public:
                 if (bytes && item->GetBytesLength() > 0)
                     result.raw_bytes.assign(bytes, bytes + item->GetBytesLength());
                 result.confidence = item->GetConfidence();
+                const auto location = item->GetLocation();
+                for (int corner = 0; corner < 4; ++corner)
+                    result.position.push_back({location.points[corner][0], location.points[corner][1]});
                 run.results.push_back(std::move(result));
             }
             decoded->Release();
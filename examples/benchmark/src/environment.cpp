@@ -0,0 +1,325 @@
+#include "environment.h"
+
+#include "hash.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <ctime>
+#include <fstream>
+#include <map>
+#include <regex>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <cstring>
+#include <sys/resource.h>
+#include <sys/utsname.h>
+#include <unistd.h>
+#endif
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+#ifndef BENCHMARK_BUILD_TYPE
+#define BENCHMARK_BUILD_TYPE ""
+#endif
+#ifndef BENCHMARK_CXX_FLAGS
+#define BENCHMARK_CXX_FLAGS ""
+#endif
+
+namespace bench {
+using json = nlohmann::json;
+namespace {
+
+std::string readLine(const std::filesystem::path& path)
+{
+    std::ifstream in(path);
+    std::string line;
+    std::getline(in, line);
+    while (!line.empty() && std::isspace(static_cast<unsigned char>(line.back()))) line.pop_back();
+    return line;
+}
+
+std::string trim(std::string value)
+{
+    const auto begin = value.find_first_not_of(" \t");
+    const auto end = value.find_last_not_of(" \t\r\n");
+    return begin == std::string::npos ? std::string() : value.substr(begin, end - begin + 1);
+}
+
+std::string compiler()
+{
+#if defined(__clang__)
+    return std::string("Clang ") + __clang_version__;
+#elif defined(__GNUC__)
+    return "GCC " + std::to_string(__GNUC__) + "." + std::to_string(__GNUC_MINOR__) + "." + std::to_string(__GNUC_PATCHLEVEL__);
+#elif defined(_MSC_VER)
+    return "Microsoft Visual C++ " + std::to_string(_MSC_VER / 100) + "." + std::to_string(_MSC_VER % 100);
+#else
+    return "unknown";
+#endif
+}
+
+std::string architecture()
+{
+#if defined(__x86_64__) || defined(_M_X64)
+    return "x64";
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    return "arm64";
+#elif defined(__i386__) || defined(_M_IX86)
+    return "x86";
+#elif defined(__arm__)
+    return "arm";
+#else
+    return "unknown";
+#endif
+}
+
+std::string timestamp()
+{
+    const auto now = std::time(nullptr);
+    std::tm local{};
+#ifdef _WIN32
+    localtime_s(&local, &now);
+#else
+    localtime_r(&now, &local);
+#endif
+    char text[32];
+    std::strftime(text, sizeof text, "%Y-%m-%dT%H:%M:%S%z", &local);
+    std::string result = text;
+    // strftime's %z has no colon; ISO 8601 as in the hand-written file does.
+    if (result.size() > 2) result.insert(result.size() - 2, ":");
+    return result;
+}
+
+// Linux-only details from /proc and /sys.
+void captureLinux(json& environment, const EnvironmentSources& sources)
+{
+    std::ifstream cpuinfo(sources.proc / "cpuinfo");
+    std::set<std::pair<std::string, std::string>> cores;
+    std::string physical_id, line;
+    int processors = 0;
+    while (std::getline(cpuinfo, line)) {
+        const auto colon = line.find(':');
+        if (colon == std::string::npos) continue;
+        const auto key = trim(line.substr(0, colon)), value = trim(line.substr(colon + 1));
+        if (key == "processor") ++processors;
+        else if ((key == "model name" || key == "Hardware" || key == "Model") && !environment.contains("processor")) environment["processor"] = value;
+        else if (key == "physical id") physical_id = value;
+        else if (key == "core id") cores.insert({physical_id, value});
+    }
+    if (processors) environment["logical_processors"] = processors;
+    if (!cores.empty()) environment["physical_cores"] = cores.size();
+
+    std::ifstream meminfo(sources.proc / "meminfo");
+    while (std::getline(meminfo, line)) {
+        if (line.rfind("MemTotal:", 0) != 0) continue;
+        const double kib = std::stod(line.substr(9));
+        environment["memory_gb"] = std::round(kib / 1024 / 1024 * 10) / 10;
+        break;
+    }
+
+    const auto cpu = sources.sys / "devices/system/cpu";
+    std::map<std::string, int> governors;
+    const std::regex cpu_directory("cpu[0-9]+");
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(cpu, error)) {
+        if (!std::regex_match(entry.path().filename().string(), cpu_directory)) continue;
+        const auto governor = readLine(entry.path() / "cpufreq/scaling_governor");
+        if (!governor.empty()) ++governors[governor];
+    }
+    if (!governors.empty()) environment["cpufreq_governors"] = governors;
+    if (const auto driver = readLine(cpu / "cpu0/cpufreq/scaling_driver"); !driver.empty()) environment["cpufreq_driver"] = driver;
+    // intel_pstate inverts the flag; acpi-cpufreq and amd-pstate use boost.
+    if (const auto no_turbo = readLine(cpu / "intel_pstate/no_turbo"); !no_turbo.empty()) environment["turbo"] = no_turbo == "0" ? "enabled" : "disabled";
+    else if (const auto boost = readLine(cpu / "cpufreq/boost"); !boost.empty()) environment["turbo"] = boost == "1" ? "enabled" : "disabled";
+    if (const auto smt = readLine(cpu / "smt/control"); !smt.empty()) environment["smt"] = smt;
+    environment["isolated_cpus"] = readLine(cpu / "isolated");
+    environment["nohz_full_cpus"] = readLine(cpu / "nohz_full");
+    if (const auto nodes = numaTopology(sources); !nodes.empty()) environment["numa_nodes"] = nodes.size();
+}
+
+} // namespace
+
+json captureEnvironment(const EnvironmentSources& sources)
+{
+    json environment = {
+        {"measured_at", timestamp()},
+        {"logical_processors", std::thread::hardware_concurrency()},
+        {"compiler", compiler()},
+        {"architecture", architecture()},
+        {"configuration", BENCHMARK_BUILD_TYPE},
+        {"build_flags", BENCHMARK_CXX_FLAGS},
+#ifdef NDEBUG
+        {"assertions", false},
+#else
+        {"assertions", true},
+#endif
+    };
+#ifdef _WIN32
+    environment["operating_system"] = "Windows";
+#else
+    utsname name{};
+    if (::uname(&name) == 0) {
+        environment["operating_system"] = name.sysname;
+        environment["kernel"] = std::string(name.release) + " " + name.version;
+    }
+#endif
+#ifdef __linux__
+    captureLinux(environment, sources);
+#else
+    (void)sources;
+#endif
+    return environment;
+}
+
+std::string environmentHash(const json& environment)
+{
+    auto stable = environment;
+    stable.erase("measured_at");
+    return sha256(stable.dump());
+}
+
+std::vector<std::string> environmentWarnings(const json& environment, const std::vector<int>& pinned_cpus,
+                                             const EnvironmentSources& sources)
+{
+    std::vector<std::string> warnings;
+    if (environment.contains("cpufreq_governors")) {
+        for (const auto& [governor, count] : environment["cpufreq_governors"].items()) {
+            if (governor == "performance") continue;
+            warnings.push_back(std::to_string(count.get<int>()) + " CPUs use the '" + governor +
+                               "' cpufreq governor; clock speed follows load, so set 'performance' before comparing latency");
+        }
+    }
+    if (environment.value("turbo", "") == "enabled")
+        warnings.push_back("turbo/boost is enabled; clock speed depends on temperature and how many cores are busy");
+    const std::set<int> pinned(pinned_cpus.begin(), pinned_cpus.end());
+    for (const int cpu : pinned_cpus) {
+        const auto siblings = parseCpuList(readLine(sources.sys / "devices/system/cpu" / ("cpu" + std::to_string(cpu)) / "topology/thread_siblings_list"));
+        for (const int sibling : siblings) {
+            if (sibling > cpu && pinned.count(sibling))
+                warnings.push_back("pinned CPUs " + std::to_string(cpu) + " and " + std::to_string(sibling) +
+                                   " are SMT siblings of one physical core");
+        }
+    }
+    return warnings;
+}
+
+std::vector<NumaNode> numaTopology(const EnvironmentSources& sources)
+{
+    std::vector<NumaNode> nodes;
+    const std::regex node_directory("node([0-9]+)");
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(sources.sys / "devices/system/node", error)) {
+        std::smatch match;
+        const auto name = entry.path().filename().string();
+        if (!std::regex_match(name, match, node_directory)) continue;
+        NumaNode node;
+        node.id = std::stoi(match[1].str());
+        node.cpus = parseCpuList(readLine(entry.path() / "cpulist"));
+        if (node.cpus.empty()) continue;
+        // "Node 0 MemTotal:       32780516 kB"
+        std::ifstream meminfo(entry.path() / "meminfo");
+        for (std::string line; std::getline(meminfo, line);) {
+            const auto key = line.find("MemTotal:");
+            if (key == std::string::npos) continue;
+            node.memory_bytes = std::stoull(line.substr(key + 9)) * 1024;
+            break;
+        }
+        nodes.push_back(std::move(node));
+    }
+    std::sort(nodes.begin(), nodes.end(), [](const auto& a, const auto& b) { return a.id < b.id; });
+    return nodes;
+}
+
+std::vector<int> parseCpuList(std::string_view text)
+{
+    std::vector<int> result;
+    std::stringstream list{std::string(text)};
+    for (std::string item; std::getline(list, item, ',');) {
+        item = trim(item);
+        if (item.empty()) continue;
+        const auto dash = item.find('-');
+        try {
+            const int first = std::stoi(item.substr(0, dash));
+            const int last = dash == std::string::npos ? first : std::stoi(item.substr(dash + 1));
+            if (first < 0 || last < first) throw std::invalid_argument(item);
+            for (int cpu = first; cpu <= last; ++cpu) result.push_back(cpu);
+        } catch (const std::logic_error&) {
+            throw std::runtime_error("invalid CPU list entry: " + item);
+        }
+    }
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    return result;
+}
+
+void pinCurrentThread(const std::vector<int>& cpus)
+{
+    if (cpus.empty()) throw std::runtime_error("no CPUs to pin to");
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (const int cpu : cpus) {
+        if (cpu >= CPU_SETSIZE) throw std::runtime_error("CPU index out of range: " + std::to_string(cpu));
+        CPU_SET(cpu, &set);
+    }
+    if (::sched_setaffinity(0, sizeof set, &set) != 0)
+        throw std::runtime_error(std::string("sched_setaffinity failed: ") + std::strerror(errno));
+#elif defined(_WIN32)
+    DWORD_PTR mask = 0;
+    for (const int cpu : cpus) {
+        if (cpu >= 64) throw std::runtime_error("CPU index out of range: " + std::to_string(cpu));
+        mask |= DWORD_PTR{1} << cpu;
+    }
+    if (!::SetThreadAffinityMask(::GetCurrentThread(), mask)) throw std::runtime_error("SetThreadAffinityMask failed");
+#else
+    throw std::runtime_error("CPU pinning is not supported on this platform");
+#endif
+}
+
+void setNice(int value)
+{
+#ifdef _WIN32
+    (void)value;
+    throw std::runtime_error("--nice is not supported on Windows");
+#else
+    // On Linux the nice value belongs to the calling thread; later threads
+    // and forked workers inherit it.
+    errno = 0;
+    if (::setpriority(PRIO_PROCESS, 0, value) != 0)
+        throw std::runtime_error("setpriority(" + std::to_string(value) + ") failed: " + std::strerror(errno) +
+                                 (errno == EACCES || errno == EPERM ? " (negative values need CAP_SYS_NICE)" : ""));
+#endif
+}
+
+void setFifoPriority(int priority)
+{
+#ifdef __linux__
+    // The decode watchdog runs one level above the runner, so a decode that
+    // spins on a single pinned CPU can still be cancelled.
+    if (priority >= ::sched_get_priority_max(SCHED_FIFO))
+        throw std::runtime_error("SCHED_FIFO priority " + std::to_string(priority) + " leaves no higher priority for the watchdog; use at most " +
+                                 std::to_string(::sched_get_priority_max(SCHED_FIFO) - 1));
+    sched_param parameter{};
+    parameter.sched_priority = priority;
+    if (::sched_setscheduler(0, SCHED_FIFO, &parameter) != 0)
+        throw std::runtime_error("SCHED_FIFO priority " + std::to_string(priority) + " failed: " + std::strerror(errno) +
+                                 (errno == EPERM ? " (needs CAP_SYS_NICE or an RLIMIT_RTPRIO allowance)" : ""));
+#else
+    (void)priority;
+    throw std::runtime_error("--sched-fifo is only supported on Linux");
+#endif
+}
+
+} // namespace bench
@@ -0,0 +1,151 @@
+#include "hotspots.h"
+
+#include "barber_dataset.h"
+#include "json_writer.h"
+#include "normalization.h"
+
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace bench {
+using json = nlohmann::json;
+namespace {
+
+struct SampleTimes {
+    std::vector<double> decode_ms;
+    double median_ms = 0;
+    double cv = 0;
+};
+
+double median(std::vector<double> values)
+{
+    if (values.empty()) return 0;
+    const auto middle = values.begin() + static_cast<std::ptrdiff_t>(values.size() / 2);
+    std::nth_element(values.begin(), middle, values.end());
+    if (values.size() % 2) return *middle;
+    return (*middle + *std::max_element(values.begin(), middle)) / 2;
+}
+
+double coefficientOfVariation(const std::vector<double>& values)
+{
+    if (values.size() < 2) return 0;
+    double mean = 0;
+    for (const double value : values) mean += value;
+    mean /= static_cast<double>(values.size());
+    if (mean <= 0) return 0;
+    double squares = 0;
+    for (const double value : values) squares += (value - mean) * (value - mean);
+    return std::sqrt(squares / static_cast<double>(values.size() - 1)) / mean;
+}
+
+} // namespace
+
+HotspotReport findHotspots(const std::filesystem::path& jsonl, const HotspotOptions& options)
+{
+    std::ifstream in(jsonl, std::ios::binary);
+    if (!in) throw std::runtime_error("cannot read results: " + jsonl.string());
+    HotspotReport report;
+    // Manifest fields are the same for every record of a sample, so each
+    // sample is parsed once.
+    std::unordered_map<std::string, std::size_t> index;
+    std::vector<ManifestRecord> records;
+    std::vector<std::set<std::string>> formats;
+    std::map<std::string, std::map<std::size_t, SampleTimes>> decoders;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty()) continue;
+        const auto value = json::parse(line);
+        ++report.records;
+        const auto sample_id = value.at("sample_id").get<std::string>();
+        auto [slot, added] = index.emplace(sample_id, records.size());
+        if (added) {
+            auto record = BarberDataset::parseManifestLine(line);
+            record.stratum.clear();
+            record.weight = 1.0;
+            std::set<std::string> sample_formats;
+            for (const auto& gt : record.ground_truth) sample_formats.insert(canonicalFormat(gt.format));
+            records.push_back(std::move(record));
+            formats.push_back(std::move(sample_formats));
+        }
+        // A failed load or decoder error has no meaningful decode time; a
+        // timeout does, since it ran for the whole deadline.
+        if (!value["error"].is_null() && !value.value("timed_out", false)) continue;
+        decoders[value.at("decoder").get<std::string>()][slot->second].decode_ms.push_back(value.value("decode_ns", 0.0) / 1e6);
+    }
+    report.images = records.size();
+    report.decoders = decoders.size();
+
+    std::map<std::size_t, std::vector<HotspotReason>> reasons;
+    auto keep = [&](std::vector<std::pair<double, std::size_t>> ranked, const std::string& decoder,
+                    const std::string& kind, const std::string& format, const std::map<std::size_t, SampleTimes>& times) {
+        // Ties break on manifest order so the export is deterministic.
+        std::sort(ranked.begin(), ranked.end(), [](const auto& a, const auto& b) {
+            return a.first != b.first ? a.first > b.first : a.second < b.second;
+        });
+        for (std::size_t rank = 0; rank < std::min(options.top, ranked.size()); ++rank) {
+            const auto sample = ranked[rank].second;
+            const auto& t = times.at(sample);
+            reasons[sample].push_back({decoder, kind, format, rank + 1, t.median_ms, t.cv, t.decode_ms.size()});
+        }
+    };
+    for (auto& [decoder, times] : decoders) {
+        std::vector<std::pair<double, std::size_t>> slowest, unstable;
+        std::map<std::string, std::vector<std::pair<double, std::size_t>>> by_format;
+        for (auto& [sample, t] : times) {
+            t.median_ms = median(t.decode_ms);
+            t.cv = coefficientOfVariation(t.decode_ms);
+            slowest.emplace_back(t.median_ms, sample);
+            for (const auto& format : formats[sample]) by_format[format].emplace_back(t.median_ms, sample);
+            if (t.decode_ms.size() >= options.min_repetitions && t.cv >= options.cv_threshold)
+                unstable.emplace_back(t.cv, sample);
+        }
+        keep(std::move(slowest), decoder, "slowest", "", times);
+        for (auto& [format, ranked] : by_format) keep(std::move(ranked), decoder, "slowest_in_format", format, times);
+        keep(std::move(unstable), decoder, "unstable", "", times);
+    }
+
+    for (auto& [sample, why] : reasons) {
+        HotspotSample hotspot;
+        hotspot.record = records[sample];
+        for (const auto& reason : why) hotspot.worst_median_ms = std::max(hotspot.worst_median_ms, reason.median_ms);
+        hotspot.reasons = std::move(why);
+        report.samples.push_back(std::move(hotspot));
+    }
+    std::stable_sort(report.samples.begin(), report.samples.end(),
+                     [](const auto& a, const auto& b) { return a.worst_median_ms > b.worst_median_ms; });
+    return report;
+}
+
+void writeHotspotReport(const HotspotReport& report, const HotspotOptions& options, const std::filesystem::path& output)
+{
+    std::string buffer;
+    JsonWriter out(buffer);
+    out.beginObject().field("records", report.records).field("images", report.images).field("decoders", report.decoders)
+       .field("top", options.top).field("cv_threshold", options.cv_threshold).field("min_repetitions", options.min_repetitions)
+       .key("samples").beginArray();
+    for (const auto& sample : report.samples) {
+        out.beginObject().field("sample_id", sample.record.sample_id).field("relative_path", sample.record.relative_path)
+           .field("worst_median_ms", sample.worst_median_ms).key("reasons").beginArray();
+        for (const auto& reason : sample.reasons) {
+            out.beginObject().field("decoder", reason.decoder).field("kind", reason.kind);
+            if (!reason.format.empty()) out.field("format", reason.format);
+            out.field("rank", reason.rank).field("median_ms", reason.median_ms).field("cv", reason.cv)
+               .field("repetitions", reason.repetitions).endObject();
+        }
+        out.endArray().endObject();
+    }
+    out.endArray().endObject();
+    buffer.push_back('\n');
+    if (output.has_parent_path()) std::filesystem::create_directories(output.parent_path());
+    std::ofstream file(output, std::ios::binary);
+    file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    if (!file) throw std::runtime_error("cannot write hotspot report: " + output.string());
+}
+
+} // namespace bench
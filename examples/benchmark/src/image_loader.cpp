@@ -2,13 +2,180 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BENCH_HALVE_SSE2 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define BENCH_HALVE_NEON 1
+#endif
+
 namespace bench {
+namespace {
+
+// One output row of a 2:1 box filter over the first `pairs` pixel pairs of
+// two RGB rows, rounded as (sum + 2) / 4 like downscaleImage.
+void halveRow(const std::uint8_t* top,const std::uint8_t* bottom,std::uint8_t* out,int pairs)
+{
+    int x=0;
+#if defined(BENCH_HALVE_SSE2)
+    // Each 16-bit lane adds a byte to the byte three further on, the same
+    // channel of the neighbouring pixel; the lanes of even pixels are kept.
+    const __m128i zero=_mm_setzero_si128(),two=_mm_set1_epi16(2);
+    const auto chunk=[&](std::size_t at){
+        const auto load=[](const std::uint8_t* p){return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));};
+        const __m128i a=load(top+at),b=load(top+at+3),c=load(bottom+at),d=load(bottom+at+3);
+        const __m128i lo=_mm_add_epi16(_mm_add_epi16(_mm_unpacklo_epi8(a,zero),_mm_unpacklo_epi8(b,zero)),
+                                       _mm_add_epi16(_mm_unpacklo_epi8(c,zero),_mm_unpacklo_epi8(d,zero)));
+        const __m128i hi=_mm_add_epi16(_mm_add_epi16(_mm_unpackhi_epi8(a,zero),_mm_unpackhi_epi8(b,zero)),
+                                       _mm_add_epi16(_mm_unpackhi_epi8(c,zero),_mm_unpackhi_epi8(d,zero)));
+        return _mm_packus_epi16(_mm_srli_epi16(_mm_add_epi16(lo,two),2),_mm_srli_epi16(_mm_add_epi16(hi,two),2));
+    };
+    alignas(16) std::uint8_t sums[48];
+    // Eight pairs read 51 bytes, so the last full pair is left to the tail.
+    for(;x+9<=pairs;x+=8){
+        const auto at=static_cast<std::size_t>(x)*6;
+        for(int k=0;k<3;++k)_mm_store_si128(reinterpret_cast<__m128i*>(sums+16*k),chunk(at+16*k));
+        for(int k=0;k<8;++k)for(int c=0;c<3;++c)out[(x+k)*3+c]=sums[6*k+c];
+    }
+#elif defined(BENCH_HALVE_NEON)
+    // vld3 splits the channels, so neighbouring pixels are neighbouring lanes.
+    for(;x+16<=pairs;x+=16){
+        const auto at=static_cast<std::size_t>(x)*6;
+        const uint8x16x3_t t0=vld3q_u8(top+at),t1=vld3q_u8(top+at+48);
+        const uint8x16x3_t b0=vld3q_u8(bottom+at),b1=vld3q_u8(bottom+at+48);
+        uint8x16x3_t result;
+        for(int c=0;c<3;++c)
+            result.val[c]=vcombine_u8(vrshrn_n_u16(vpadalq_u8(vpaddlq_u8(t0.val[c]),b0.val[c]),2),
+                                      vrshrn_n_u16(vpadalq_u8(vpaddlq_u8(t1.val[c]),b1.val[c]),2));
+        vst3q_u8(out+static_cast<std::size_t>(x)*3,result);
+    }
+#endif
+    for(;x<pairs;++x)for(int c=0;c<3;++c)
+        out[x*3+c]=static_cast<std::uint8_t>((top[x*6+c]+top[x*6+3+c]+bottom[x*6+c]+bottom[x*6+3+c]+2)>>2);
+}
+
+class StbImageLoader final : public IImageLoader {
+public:
+    explicit StbImageLoader(int scale) : scale_(scale) {}
+    std::string name() const override { return "stb"; }
+    bool decode(std::span<const std::uint8_t> bytes, ImageBuffer& output, std::string& error) override
+    {
+        int w=0,h=0,n=0;
+        auto* data=stbi_load_from_memory(bytes.data(),static_cast<int>(bytes.size()),&w,&h,&n,3);
+        if(!data){error=stbi_failure_reason()?stbi_failure_reason():"stb_image failed";return false;}
+        output.width=w;output.height=h;output.stride=w*3;
+        output.rgb.assign(data,data+static_cast<std::size_t>(output.stride)*h);stbi_image_free(data);
+        downscaleImage(output,scale_);
+        return true;
+    }
+private:
+    int scale_;
+};
+
+} // namespace
+
+bool IImageLoader::load(const std::filesystem::path& path, ImageBuffer& output, std::string& error)
+{
+    thread_local std::vector<std::uint8_t> bytes;
+    if(!readFileBytes(path,bytes,error))return false;
+    return decode(bytes,output,error);
+}
+
+std::unique_ptr<IImageLoader> createStbImageLoader(int scale_denominator)
+{
+    return std::make_unique<StbImageLoader>(scale_denominator);
+}
+
+std::vector<std::string> availableImageLoaders()
+{
+    std::vector<std::string> names{"stb"};
+#ifdef BENCHMARK_HAVE_LIBJPEG
+    names.push_back("libjpeg-turbo");
+#endif
+#ifdef BENCHMARK_HAVE_LIBPNG
+    names.push_back("libpng");
+#endif
+    return names;
+}
+
+std::unique_ptr<IImageLoader> createImageLoader(const std::string& name, int scale_denominator)
+{
+    if(scale_denominator!=1&&scale_denominator!=2&&scale_denominator!=4&&scale_denominator!=8)
+        throw std::runtime_error("unsupported loader scale 1/"+std::to_string(scale_denominator)+" (use 1, 2, 4 or 8)");
+    if(name.empty()||name=="stb")return createStbImageLoader(scale_denominator);
+#ifdef BENCHMARK_HAVE_LIBJPEG
+    if(name=="libjpeg-turbo")return createJpegImageLoader(scale_denominator);
+#endif
+#ifdef BENCHMARK_HAVE_LIBPNG
+    if(name=="libpng")return createPngImageLoader(scale_denominator);
+#endif
+    std::string known;
+    for(const auto& value:availableImageLoaders())known+=(known.empty()?"":", ")+value;
+    throw std::runtime_error("unknown or unavailable image loader: "+name+" (available: "+known+")");
+}
+
+bool readFileBytes(const std::filesystem::path& path, std::vector<std::uint8_t>& output, std::string& error)
+{
+    std::ifstream input(path,std::ios::binary|std::ios::ate);
+    if(!input){error="cannot open image: "+path.string();return false;}
+    const auto size=static_cast<std::size_t>(input.tellg());
+    output.resize(size);input.seekg(0);
+    if(!input.read(reinterpret_cast<char*>(output.data()),static_cast<std::streamsize>(size))){error="cannot read image: "+path.string();return false;}
+    return true;
+}
+
+void downscaleImage(ImageBuffer& image, int factor)
+{
+    if(factor<=1||image.width<=0||image.height<=0)return;
+    // Match libjpeg's ceil(dimension / factor) output size so every backend
+    // produces the same geometry for a given scale.
+    const int w=(image.width+factor-1)/factor,h=(image.height+factor-1)/factor;
+    std::vector<std::uint8_t> output(static_cast<std::size_t>(w)*h*3);
+    for(int y=0;y<h;++y){
+        const int y0=y*factor,y1=std::min(image.height,y0+factor);
+        for(int x=0;x<w;++x){
+            const int x0=x*factor,x1=std::min(image.width,x0+factor);
+            unsigned sum[3]={0,0,0};
+            for(int sy=y0;sy<y1;++sy){
+                const auto* row=image.rgb.data()+static_cast<std::size_t>(sy)*image.stride;
+                for(int sx=x0;sx<x1;++sx)for(int c=0;c<3;++c)sum[c]+=row[sx*3+c];
+            }
+            const unsigned count=static_cast<unsigned>((y1-y0)*(x1-x0));
+            auto* out=output.data()+(static_cast<std::size_t>(y)*w+x)*3;
+            for(int c=0;c<3;++c)out[c]=static_cast<std::uint8_t>((sum[c]+count/2)/count);
+        }
+    }
+    image.rgb=std::move(output);image.width=w;image.height=h;image.stride=w*3;
+}
+
+void halveImage(const ImageBuffer& input, ImageBuffer& output)
+{
+    const int w=(input.width+1)/2,h=(input.height+1)/2;
+    output.view=nullptr;output.width=w;output.height=h;output.stride=w*3;
+    output.rgb.resize(static_cast<std::size_t>(w)*h*3);
+    for(int y=0;y<h;++y){
+        const auto* top=input.data()+static_cast<std::size_t>(2*y)*input.stride;
+        // An odd last row or column is paired with itself, which rounds the
+        // same as downscaleImage averaging the two or one pixels left.
+        const auto* bottom=2*y+1<input.height?top+input.stride:top;
+        auto* out=output.rgb.data()+static_cast<std::size_t>(y)*output.stride;
+        halveRow(top,bottom,out,input.width/2);
+        if(input.width%2){
+            const std::uint8_t* last[2]={top+(input.width-1)*3,bottom+(input.width-1)*3};
+            for(int c=0;c<3;++c)out[(w-1)*3+c]=static_cast<std::uint8_t>((2*last[0][c]+2*last[1][c]+2)>>2);
+        }
+    }
+}
+
 bool loadImage(const std::filesystem::path& path, ImageBuffer& output, std::string& error)
 {
-    int w=0,h=0,n=0; auto* data=stbi_load(path.string().c_str(),&w,&h,&n,3);
-    if(!data){error=stbi_failure_reason()?stbi_failure_reason():"stb_image failed";return false;}
-    output.width=w;output.height=h;output.stride=w*3;
-    output.rgb.assign(data,data+static_cast<std::size_t>(output.stride)*h);stbi_image_free(data);return true;
+    StbImageLoader loader(1);
+    return loader.load(path,output,error);
 }
 bool probeImage(const std::filesystem::path& path, int& width, int& height, std::string& error)
 {
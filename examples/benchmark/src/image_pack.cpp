@@ -0,0 +1,227 @@
+#include "image_pack.h"
+
+#include "hash.h"
+#include "image_loader.h"
+
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <string_view>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace bench {
+using json = nlohmann::json;
+namespace {
+
+constexpr char kMagic[8] = {'B', 'A', 'R', 'P', 'A', 'C', 'K', '1'};
+constexpr std::uint32_t kVersion = 1;
+constexpr std::size_t kHeaderBytes = 64;
+
+template <typename T>
+void putLittle(std::uint8_t* out, T value)
+{
+    for (std::size_t i = 0; i < sizeof(T); ++i) out[i] = static_cast<std::uint8_t>(value >> (8 * i));
+}
+
+template <typename T>
+T getLittle(const std::uint8_t* in)
+{
+    T value = 0;
+    for (std::size_t i = 0; i < sizeof(T); ++i) value |= static_cast<T>(in[i]) << (8 * i);
+    return value;
+}
+
+std::string_view asText(std::span<const std::uint8_t> bytes)
+{
+    return {reinterpret_cast<const char*>(bytes.data()), bytes.size()};
+}
+
+} // namespace
+
+PackSummary writeImagePack(const std::filesystem::path& image_root, const std::vector<ManifestRecord>& records,
+                           const std::filesystem::path& output)
+{
+    if (output.has_parent_path()) std::filesystem::create_directories(output.parent_path());
+    // Written beside the target and renamed at the end, so an interrupted
+    // pack never looks complete.
+    auto partial = output;
+    partial += ".partial";
+    std::ofstream file(partial, std::ios::binary | std::ios::trunc);
+    if (!file) throw std::runtime_error("cannot write image pack: " + partial.string());
+    const std::array<char, kHeaderBytes> zeros{};
+    file.write(zeros.data(), zeros.size());
+
+    PackSummary summary;
+    std::uint64_t position = kHeaderBytes;
+    std::map<std::string, std::pair<std::uint64_t, std::uint64_t>> blobs;  // sha256 -> (offset, length)
+    std::set<std::string> sample_ids;
+    json entries = json::array();
+    std::vector<std::uint8_t> bytes;
+    std::string error;
+    for (const auto& record : records) {
+        if (!sample_ids.insert(record.sample_id).second) throw std::runtime_error("duplicate sample_id in manifest: " + record.sample_id);
+        if (!readFileBytes(image_root / record.relative_path, bytes, error)) throw std::runtime_error(error);
+        const auto digest = sha256(asText(bytes));
+        if (!record.image_sha256.empty() && record.image_sha256 != digest)
+            throw std::runtime_error("image does not match manifest image_sha256: " + record.relative_path);
+        auto [blob, added] = blobs.emplace(digest, std::pair<std::uint64_t, std::uint64_t>{0, bytes.size()});
+        if (added) {
+            const auto padding = (kImagePackAlignment - position % kImagePackAlignment) % kImagePackAlignment;
+            for (auto left = padding; left;) {
+                const auto chunk = std::min<std::uint64_t>(left, zeros.size());
+                file.write(zeros.data(), static_cast<std::streamsize>(chunk));
+                left -= chunk;
+            }
+            position += padding;
+            blob->second.first = position;
+            file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+            position += bytes.size();
+            summary.image_bytes += bytes.size();
+            ++summary.blobs;
+        }
+        entries.push_back({{"sample_id", record.sample_id}, {"relative_path", record.relative_path},
+                           {"offset", blob->second.first}, {"length", blob->second.second}, {"sha256", digest}});
+        ++summary.images;
+    }
+    const auto index = json{{"entries", entries}}.dump();
+    file.write(index.data(), static_cast<std::streamsize>(index.size()));
+
+    std::array<std::uint8_t, kHeaderBytes> header{};
+    std::memcpy(header.data(), kMagic, sizeof kMagic);
+    putLittle<std::uint32_t>(header.data() + 8, kVersion);
+    putLittle<std::uint32_t>(header.data() + 12, kImagePackAlignment);
+    putLittle<std::uint64_t>(header.data() + 16, summary.images);
+    putLittle<std::uint64_t>(header.data() + 24, position);
+    putLittle<std::uint64_t>(header.data() + 32, index.size());
+    file.seekp(0);
+    file.write(reinterpret_cast<const char*>(header.data()), header.size());
+    file.close();
+    if (!file) throw std::runtime_error("cannot write image pack: " + partial.string());
+    std::filesystem::rename(partial, output);
+    summary.file_bytes = position + index.size();
+    return summary;
+}
+
+ImagePack::ImagePack(const std::filesystem::path& path) : path_(path)
+{
+#ifdef _WIN32
+    std::string error;
+    if (!readFileBytes(path, fallback_, error)) throw std::runtime_error(error);
+    data_ = fallback_.data();
+    size_ = fallback_.size();
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) throw std::runtime_error("cannot open image pack: " + path.string());
+    struct stat info {};
+    if (::fstat(fd, &info) != 0 || info.st_size <= 0) {
+        ::close(fd);
+        throw std::runtime_error("cannot read image pack: " + path.string());
+    }
+    size_ = static_cast<std::uint64_t>(info.st_size);
+#ifdef POSIX_FADV_SEQUENTIAL
+    // Images are read in manifest order, which is the order they were packed.
+    ::posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    void* address = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (address == MAP_FAILED) throw std::runtime_error("cannot map image pack: " + path.string());
+    data_ = static_cast<const std::uint8_t*>(address);
+#endif
+
+    try {
+        if (size_ < kHeaderBytes || std::memcmp(data_, kMagic, sizeof kMagic) != 0)
+            throw std::runtime_error("not an image pack: " + path.string());
+        if (getLittle<std::uint32_t>(data_ + 8) != kVersion)
+            throw std::runtime_error("unsupported image pack version: " + path.string());
+        const auto count = getLittle<std::uint64_t>(data_ + 16);
+        const auto index_offset = getLittle<std::uint64_t>(data_ + 24);
+        const auto index_bytes = getLittle<std::uint64_t>(data_ + 32);
+        if (index_offset < kHeaderBytes || index_offset > size_ || index_bytes > size_ - index_offset)
+            throw std::runtime_error("truncated image pack: " + path.string());
+        const auto index = json::parse(asText({data_ + index_offset, index_bytes}));
+        for (const auto& item : index.at("entries")) {
+            PackEntry entry;
+            entry.sample_id = item.at("sample_id").get<std::string>();
+            entry.relative_path = item.value("relative_path", "");
+            entry.offset = item.at("offset").get<std::uint64_t>();
+            entry.length = item.at("length").get<std::uint64_t>();
+            entry.sha256 = item.at("sha256").get<std::string>();
+            if (entry.offset < kHeaderBytes || entry.offset > index_offset || entry.length > index_offset - entry.offset)
+                throw std::runtime_error("image pack entry out of bounds: " + entry.sample_id);
+            index_.emplace(entry.sample_id, entries_.size());
+            entries_.push_back(std::move(entry));
+        }
+        if (entries_.size() != count) throw std::runtime_error("image pack index is incomplete: " + path.string());
+    } catch (...) {
+#ifndef _WIN32
+        ::munmap(const_cast<std::uint8_t*>(data_), size_);
+#endif
+        throw;
+    }
+}
+
+ImagePack::~ImagePack()
+{
+#ifndef _WIN32
+    if (data_) ::munmap(const_cast<std::uint8_t*>(data_), size_);
+#endif
+}
+
+const PackEntry* ImagePack::find(const std::string& sample_id) const
+{
+    const auto found = index_.find(sample_id);
+    return found == index_.end() ? nullptr : &entries_[found->second];
+}
+
+std::span<const std::uint8_t> ImagePack::bytes(const PackEntry& entry) const
+{
+    return {data_ + entry.offset, static_cast<std::size_t>(entry.length)};
+}
+
+void ImagePack::prefetch(const PackEntry& entry) const
+{
+#if !defined(_WIN32) && defined(MADV_WILLNEED)
+    // madvise wants a page-aligned start; the alignment only guarantees 4 KiB.
+    static const auto page = static_cast<std::uint64_t>(::sysconf(_SC_PAGESIZE));
+    const auto begin = entry.offset / page * page;
+    ::madvise(const_cast<std::uint8_t*>(data_) + begin, static_cast<std::size_t>(entry.offset + entry.length - begin), MADV_WILLNEED);
+#else
+    (void)entry;
+#endif
+}
+
+void ImagePack::checkManifest(const std::vector<ManifestRecord>& records) const
+{
+    for (const auto& record : records) {
+        const auto* entry = find(record.sample_id);
+        if (!entry) throw std::runtime_error("image pack has no entry for sample: " + record.sample_id);
+        if (!record.image_sha256.empty() && record.image_sha256 != entry->sha256)
+            throw std::runtime_error("image pack does not match manifest image_sha256: " + record.sample_id);
+    }
+}
+
+std::size_t ImagePack::verify(const std::vector<ManifestRecord>& records) const
+{
+    std::set<std::uint64_t> checked;
+    for (const auto& record : records) {
+        const auto* entry = find(record.sample_id);
+        if (!entry) throw std::runtime_error("image pack has no entry for sample: " + record.sample_id);
+        if (!checked.insert(entry->offset).second) continue;
+        if (sha256(asText(bytes(*entry))) != entry->sha256)
+            throw std::runtime_error("image pack blob is corrupt: " + record.sample_id + " in " + path_.string());
+    }
+    return checked.size();
+}
+
+} // namespace bench
@@ -0,0 +1,448 @@
+#include "isolated_decoder.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#ifdef __linux__
+#include <cerrno>
+#include <csignal>
+#include <filesystem>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace bench {
+
+#ifdef __linux__
+namespace {
+
+struct Request {
+    char kind = 'R';
+    int width = 0;
+    int height = 0;
+    int stride = 0;
+    std::uint64_t bytes = 0;
+    std::int64_t deadline_ms = 0;
+};
+
+template <typename T>
+void put(std::string& out, const T& value)
+{
+    static_assert(std::is_trivially_copyable_v<T>);
+    out.append(reinterpret_cast<const char*>(&value), sizeof value);
+}
+
+void putString(std::string& out, std::string_view text)
+{
+    put<std::uint64_t>(out, text.size());
+    out.append(text);
+}
+
+class Reader {
+public:
+    explicit Reader(std::string_view data) : data_(data) {}
+
+    template <typename T>
+    T get()
+    {
+        T value;
+        std::memcpy(&value, take(sizeof value).data(), sizeof value);
+        return value;
+    }
+    std::string getString() { return std::string(take(get<std::uint64_t>())); }
+
+private:
+    std::string_view take(std::size_t size)
+    {
+        if (size > data_.size()) throw std::runtime_error("truncated decoder worker message");
+        const auto part = data_.substr(0, size);
+        data_.remove_prefix(size);
+        return part;
+    }
+
+    std::string_view data_;
+};
+
+void encodeRun(std::string& out, const DecodeRun& run)
+{
+    put<std::uint64_t>(out, run.results.size());
+    for (const auto& result : run.results) {
+        putString(out, result.canonical_format);
+        putString(out, std::string_view(reinterpret_cast<const char*>(result.raw_bytes.data()), result.raw_bytes.size()));
+        putString(out, result.text);
+        put<std::uint8_t>(out, result.confidence.has_value());
+        put<double>(out, result.confidence.value_or(0));
+        put<std::uint64_t>(out, result.position.size());
+        for (const auto& corner : result.position) {
+            put<std::int32_t>(out, corner.x);
+            put<std::int32_t>(out, corner.y);
+        }
+    }
+    put<std::int64_t>(out, run.decode_time.count());
+    put<std::int64_t>(out, run.thread_cpu_time.count());
+    put<std::int64_t>(out, run.process_cpu_time.count());
+    put<std::int64_t>(out, run.voluntary_context_switches);
+    put<std::int64_t>(out, run.involuntary_context_switches);
+    put<std::uint8_t>(out, run.error.has_value());
+    putString(out, run.error.value_or(""));
+    put<std::uint8_t>(out, run.timed_out);
+    putString(out, run.resolved_by);
+    put<std::int64_t>(out, run.wall_time.count());
+}
+
+DecodeRun decodeRun(std::string_view payload)
+{
+    Reader in(payload);
+    DecodeRun run;
+    run.results.resize(in.get<std::uint64_t>());
+    for (auto& result : run.results) {
+        result.canonical_format = in.getString();
+        const auto raw = in.getString();
+        result.raw_bytes.assign(raw.begin(), raw.end());
+        result.text = in.getString();
+        const bool has_confidence = in.get<std::uint8_t>();
+        const auto confidence = in.get<double>();
+        if (has_confidence) result.confidence = confidence;
+        result.position.resize(in.get<std::uint64_t>());
+        for (auto& corner : result.position) {
+            corner.x = in.get<std::int32_t>();
+            corner.y = in.get<std::int32_t>();
+        }
+    }
+    run.decode_time = std::chrono::nanoseconds(in.get<std::int64_t>());
+    run.thread_cpu_time = std::chrono::nanoseconds(in.get<std::int64_t>());
+    run.process_cpu_time = std::chrono::nanoseconds(in.get<std::int64_t>());
+    run.voluntary_context_switches = in.get<std::int64_t>();
+    run.involuntary_context_switches = in.get<std::int64_t>();
+    const bool has_error = in.get<std::uint8_t>();
+    auto error = in.getString();
+    if (has_error) run.error = std::move(error);
+    run.timed_out = in.get<std::uint8_t>();
+    run.resolved_by = in.getString();
+    run.wall_time = std::chrono::nanoseconds(in.get<std::int64_t>());
+    return run;
+}
+
+bool sendAll(int fd, const void* data, std::size_t size)
+{
+    const auto* bytes = static_cast<const char*>(data);
+    while (size) {
+        const auto sent = ::send(fd, bytes, size, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent <= 0) return false;
+        bytes += sent;
+        size -= static_cast<std::size_t>(sent);
+    }
+    return true;
+}
+
+bool receiveAll(int fd, void* data, std::size_t size)
+{
+    auto* bytes = static_cast<char*>(data);
+    while (size) {
+        const auto received = ::recv(fd, bytes, size, 0);
+        if (received < 0 && errno == EINTR) continue;
+        if (received <= 0) return false;
+        bytes += received;
+        size -= static_cast<std::size_t>(received);
+    }
+    return true;
+}
+
+bool sendMessage(int fd, const std::string& payload)
+{
+    const std::uint64_t size = payload.size();
+    return sendAll(fd, &size, sizeof size) && sendAll(fd, payload.data(), payload.size());
+}
+
+bool receiveMessage(int fd, std::string& payload)
+{
+    std::uint64_t size = 0;
+    if (!receiveAll(fd, &size, sizeof size)) return false;
+    payload.resize(size);
+    return receiveAll(fd, payload.data(), payload.size());
+}
+
+// A worker must not keep the harness's other descriptors open. Holding a
+// sibling worker's socket, for one, would hide that sibling's crash.
+void closeInheritedDescriptors(int keep_socket, int keep_images)
+{
+    std::vector<int> descriptors;
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator("/proc/self/fd", error)) {
+        const int fd = std::atoi(entry.path().filename().c_str());
+        if (fd > 2 && fd != keep_socket && fd != keep_images) descriptors.push_back(fd);
+    }
+    for (int fd : descriptors) ::close(fd);
+}
+
+[[noreturn]] void workerMain(const IsolatedDecoder::Factory& factory, int socket, int image_fd)
+{
+    closeInheritedDescriptors(socket, image_fd);
+    std::string payload;
+    std::unique_ptr<IDecoderAdapter> adapter;
+    try {
+        adapter = factory();
+        put<std::uint8_t>(payload, 1);
+        putString(payload, adapter->name());
+        putString(payload, adapter->version());
+    } catch (const std::exception& e) {
+        payload.clear();
+        put<std::uint8_t>(payload, 0);
+        putString(payload, e.what());
+    }
+    if (!sendMessage(socket, payload) || !adapter) ::_exit(1);
+
+    const std::uint8_t* mapped = nullptr;
+    std::size_t mapped_size = 0;
+    Request request;
+    while (receiveAll(socket, &request, sizeof request)) {
+        payload.clear();
+        if (request.kind == 'D') {
+            put<std::uint8_t>(payload, adapter->setDeadline(std::chrono::milliseconds(request.deadline_ms)));
+        } else {
+            // The harness only ever grows the region, so a larger request
+            // means the mapping has to be refreshed.
+            if (request.bytes > mapped_size) {
+                if (mapped) ::munmap(const_cast<std::uint8_t*>(mapped), mapped_size);
+                void* address = ::mmap(nullptr, request.bytes, PROT_READ, MAP_SHARED, image_fd, 0);
+                if (address == MAP_FAILED) ::_exit(2);
+                mapped = static_cast<const std::uint8_t*>(address);
+                mapped_size = request.bytes;
+            }
+            ImageBuffer image;
+            image.view = mapped;
+            image.width = request.width;
+            image.height = request.height;
+            image.stride = request.stride;
+            DecodeRun run;
+            try {
+                run = adapter->decode(image);
+            } catch (const std::bad_alloc&) {
+                run.error = "decoder_oom: allocation failed under the worker memory limit";
+            } catch (const std::exception& e) {
+                run.error = e.what();
+            }
+            encodeRun(payload, run);
+        }
+        if (!sendMessage(socket, payload)) break;
+    }
+    ::_exit(0);
+}
+
+std::string describeStatus(int status)
+{
+    if (WIFSIGNALED(status)) {
+        const char* name = ::strsignal(WTERMSIG(status));
+        return "worker killed by signal " + std::to_string(WTERMSIG(status)) + (name ? std::string(" (") + name + ")" : "");
+    }
+    if (WIFEXITED(status)) return "worker exited with status " + std::to_string(WEXITSTATUS(status));
+    return "worker stopped";
+}
+
+} // namespace
+
+SharedImageBuffer::SharedImageBuffer()
+    : fd_(::memfd_create("bench-image", 0))
+{
+    if (fd_ < 0) throw std::runtime_error(std::string("memfd_create failed: ") + std::strerror(errno));
+}
+
+SharedImageBuffer::~SharedImageBuffer()
+{
+    if (data_) ::munmap(data_, capacity_);
+    ::close(fd_);
+}
+
+ImageBuffer SharedImageBuffer::stage(const ImageBuffer& image)
+{
+    const auto size = image.size();
+    if (size > capacity_) {
+        const auto page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+        const auto capacity = (std::max(size, capacity_ * 2) + page - 1) / page * page;
+        if (::ftruncate(fd_, static_cast<off_t>(capacity)) != 0)
+            throw std::runtime_error(std::string("cannot grow shared image buffer: ") + std::strerror(errno));
+        void* address = ::mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+        if (address == MAP_FAILED)
+            throw std::runtime_error(std::string("cannot map shared image buffer: ") + std::strerror(errno));
+        if (data_) ::munmap(data_, capacity_);
+        data_ = static_cast<std::uint8_t*>(address);
+        capacity_ = capacity;
+    }
+    if (size && image.data() != data_) std::memcpy(data_, image.data(), size);
+    ImageBuffer view;
+    view.view = data_;
+    view.width = image.width;
+    view.height = image.height;
+    view.stride = image.stride;
+    return view;
+}
+
+bool SharedImageBuffer::holds(const ImageBuffer& image) const
+{
+    return data_ && image.view == data_ && image.size() <= capacity_;
+}
+
+IsolatedDecoder::IsolatedDecoder(Factory factory, std::shared_ptr<SharedImageBuffer> images)
+    : factory_(std::move(factory)), images_(std::move(images))
+{
+    if (!images_) images_ = std::make_shared<SharedImageBuffer>();
+    spawn();
+}
+
+IsolatedDecoder::~IsolatedDecoder()
+{
+    if (socket_ >= 0) ::close(socket_);
+    const int pid = pid_.exchange(-1);
+    if (pid > 0) {
+        ::kill(pid, SIGKILL);
+        int status = 0;
+        while (::waitpid(pid, &status, 0) < 0 && errno == EINTR) {}
+    }
+}
+
+void IsolatedDecoder::spawn()
+{
+    int sockets[2];
+    if (::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sockets) != 0)
+        throw std::runtime_error(std::string("socketpair failed: ") + std::strerror(errno));
+    const pid_t pid = ::fork();
+    if (pid < 0) {
+        ::close(sockets[0]);
+        ::close(sockets[1]);
+        throw std::runtime_error(std::string("fork failed: ") + std::strerror(errno));
+    }
+    if (pid == 0) workerMain(factory_, sockets[1], images_->fd());
+    ::close(sockets[1]);
+    socket_ = sockets[0];
+    pid_ = pid;
+
+    std::string hello;
+    if (!receiveMessage(socket_, hello)) throw std::runtime_error("decoder worker failed to start: " + reap());
+    Reader in(hello);
+    if (!in.get<std::uint8_t>()) {
+        const auto error = in.getString();
+        reap();
+        throw std::runtime_error(error);
+    }
+    name_ = in.getString();
+    version_ = in.getString();
+    if (deadline_) setDeadline(*deadline_);
+}
+
+std::string IsolatedDecoder::reap()
+{
+    if (socket_ >= 0) ::close(socket_);
+    socket_ = -1;
+    const int pid = pid_.exchange(-1);
+    if (pid <= 0) return "worker not running";
+    int status = 0;
+    while (::waitpid(pid, &status, 0) < 0) {
+        if (errno != EINTR) return "worker lost";
+    }
+    return describeStatus(status);
+}
+
+// Replaces a worker that died or was killed. Returns false, with the reason
+// in error, when no worker could be started.
+bool IsolatedDecoder::recover(std::string& error)
+{
+    if (killed_.exchange(false) && pid_ > 0) reap();
+    if (pid_ > 0) return true;
+    try {
+        spawn();
+        ++restarts_;
+        return true;
+    } catch (const std::exception& e) {
+        error = e.what();
+        return false;
+    }
+}
+
+DecodeRun IsolatedDecoder::decode(const ImageBuffer& image)
+{
+    DecodeRun run;
+    std::string error;
+    if (!recover(error)) {
+        run.error = "decoder_worker_unavailable: " + error;
+        return run;
+    }
+    const auto staged = images_->holds(image) ? image : images_->stage(image);
+    Request request;
+    request.width = staged.width;
+    request.height = staged.height;
+    request.stride = staged.stride;
+    request.bytes = staged.size();
+    std::string payload;
+    const auto begin = std::chrono::steady_clock::now();
+    if (sendAll(socket_, &request, sizeof request) && receiveMessage(socket_, payload)) return decodeRun(payload);
+
+    // The worker never reported its own time, so charge the sample the wall
+    // time until it died; a zero would drag latency statistics down.
+    run.decode_time = std::chrono::steady_clock::now() - begin;
+    const bool killed = killed_.exchange(false);
+    const auto status = reap();
+    run.timed_out = killed;
+    run.error = killed ? "decode_cancelled: " + status : "decoder_crash: " + status;
+    // Restart now so the replacement's start-up is never mistaken for part
+    // of the next image; a failure is retried and reported on the next call.
+    recover(error);
+    return run;
+}
+
+bool IsolatedDecoder::setDeadline(std::chrono::milliseconds timeout)
+{
+    deadline_ = timeout;
+    if (pid_ <= 0) return false;
+    Request request;
+    request.kind = 'D';
+    request.deadline_ms = timeout.count();
+    std::string payload;
+    if (!sendAll(socket_, &request, sizeof request) || !receiveMessage(socket_, payload)) return false;
+    return Reader(payload).get<std::uint8_t>() != 0;
+}
+
+bool IsolatedDecoder::cancel()
+{
+    const int pid = pid_.load();
+    if (pid <= 0) return false;
+    killed_ = true;
+    return ::kill(pid, SIGKILL) == 0;
+}
+
+#else
+
+SharedImageBuffer::SharedImageBuffer()
+{
+    throw std::runtime_error("process-isolated decoders require Linux");
+}
+
+SharedImageBuffer::~SharedImageBuffer() = default;
+
+ImageBuffer SharedImageBuffer::stage(const ImageBuffer& image) { return image; }
+
+bool SharedImageBuffer::holds(const ImageBuffer&) const { return false; }
+
+IsolatedDecoder::IsolatedDecoder(Factory, std::shared_ptr<SharedImageBuffer>)
+{
+    throw std::runtime_error("process-isolated decoders require Linux");
+}
+
+IsolatedDecoder::~IsolatedDecoder() = default;
+DecodeRun IsolatedDecoder::decode(const ImageBuffer&) { return {}; }
+bool IsolatedDecoder::setDeadline(std::chrono::milliseconds) { return false; }
+bool IsolatedDecoder::cancel() { return false; }
+void IsolatedDecoder::spawn() {}
+std::string IsolatedDecoder::reap() { return {}; }
+bool IsolatedDecoder::recover(std::string&) { return false; }
+
+#endif
+
+} // namespace bench
@@ -0,0 +1,85 @@
+#include "image_loader.h"
+
+#include <csetjmp>
+#include <cstdio>
+#include <cstring>
+#include <jpeglib.h>
+
+namespace bench {
+namespace {
+
+struct JpegError {
+    jpeg_error_mgr manager;
+    std::jmp_buf jump;
+    char message[JMSG_LENGTH_MAX];
+};
+
+void onJpegError(j_common_ptr info)
+{
+    auto* error=reinterpret_cast<JpegError*>(info->err);
+    (*info->err->format_message)(info,error->message);
+    std::longjmp(error->jump,1);
+}
+
+bool isJpeg(std::span<const std::uint8_t> bytes)
+{
+    return bytes.size()>3&&bytes[0]==0xff&&bytes[1]==0xd8&&bytes[2]==0xff;
+}
+
+// Kept free of objects with non-trivial destructors: libjpeg reports errors
+// by longjmp, which must not skip C++ cleanup.
+bool decodeJpeg(std::span<const std::uint8_t> bytes, int scale, ImageBuffer& output, char* message)
+{
+    jpeg_decompress_struct info;
+    JpegError error;
+    info.err=jpeg_std_error(&error.manager);
+    error.manager.error_exit=onJpegError;
+    error.message[0]=0;
+    if(setjmp(error.jump)){
+        std::memcpy(message,error.message,JMSG_LENGTH_MAX);
+        jpeg_destroy_decompress(&info);
+        return false;
+    }
+    jpeg_create_decompress(&info);
+    jpeg_mem_src(&info,bytes.data(),static_cast<unsigned long>(bytes.size()));
+    jpeg_read_header(&info,TRUE);
+    info.out_color_space=JCS_RGB;
+    info.scale_num=1;info.scale_denom=static_cast<unsigned>(scale);
+    info.dct_method=JDCT_ISLOW;
+    jpeg_start_decompress(&info);
+    output.width=static_cast<int>(info.output_width);output.height=static_cast<int>(info.output_height);
+    output.stride=output.width*3;
+    output.rgb.resize(static_cast<std::size_t>(output.stride)*output.height);
+    while(info.output_scanline<info.output_height){
+        JSAMPROW row=output.rgb.data()+static_cast<std::size_t>(info.output_scanline)*output.stride;
+        jpeg_read_scanlines(&info,&row,1);
+    }
+    jpeg_finish_decompress(&info);
+    jpeg_destroy_decompress(&info);
+    return true;
+}
+
+class JpegImageLoader final : public IImageLoader {
+public:
+    explicit JpegImageLoader(int scale) : scale_(scale), fallback_(createStbImageLoader(scale)) {}
+    std::string name() const override { return "libjpeg-turbo"; }
+    bool decode(std::span<const std::uint8_t> bytes, ImageBuffer& output, std::string& error) override
+    {
+        if(!isJpeg(bytes))return fallback_->decode(bytes,output,error);
+        char message[JMSG_LENGTH_MAX]={};
+        if(decodeJpeg(bytes,scale_,output,message))return true;
+        error=std::string("libjpeg: ")+message;return false;
+    }
+private:
+    int scale_;
+    std::unique_ptr<IImageLoader> fallback_;
+};
+
+} // namespace
+
+std::unique_ptr<IImageLoader> createJpegImageLoader(int scale_denominator)
+{
+    return std::make_unique<JpegImageLoader>(scale_denominator);
+}
+
+} // namespace bench
@@ -0,0 +1,240 @@
+#include "json_writer.h"
+
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BENCH_JSON_SSE2 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define BENCH_JSON_NEON 1
+#endif
+
+namespace bench {
+namespace {
+
+constexpr char kHexDigits[] = "0123456789abcdef";
+
+// Length of the plain-ASCII prefix that can be copied without escaping:
+// no control characters, quotes, backslashes or bytes >= 0x80.
+std::size_t plainPrefix(const char* data, std::size_t size)
+{
+    std::size_t i = 0;
+#if defined(BENCH_JSON_SSE2)
+    const __m128i space = _mm_set1_epi8(0x20);
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i slash = _mm_set1_epi8('\\');
+    for (; i + 16 <= size; i += 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        // Signed compare: bytes >= 0x80 are negative and fall below 0x20 too.
+        const __m128i special = _mm_or_si128(_mm_cmplt_epi8(chunk, space),
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, slash)));
+        const int mask = _mm_movemask_epi8(special);
+        if (mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+            unsigned long bit = 0; _BitScanForward(&bit, static_cast<unsigned long>(mask));
+            return i + bit;
+#else
+            return i + static_cast<std::size_t>(__builtin_ctz(static_cast<unsigned>(mask)));
+#endif
+        }
+    }
+#elif defined(BENCH_JSON_NEON)
+    const uint8x16_t space = vdupq_n_u8(0x20), high = vdupq_n_u8(0x80);
+    const uint8x16_t quote = vdupq_n_u8('"'), slash = vdupq_n_u8('\\');
+    for (; i + 16 <= size; i += 16) {
+        const uint8x16_t chunk = vld1q_u8(reinterpret_cast<const std::uint8_t*>(data + i));
+        const uint8x16_t special = vorrq_u8(vorrq_u8(vcltq_u8(chunk, space), vcgeq_u8(chunk, high)),
+                                            vorrq_u8(vceqq_u8(chunk, quote), vceqq_u8(chunk, slash)));
+        if (vmaxvq_u8(special)) break;
+    }
+#endif
+    for (; i < size; ++i) {
+        const auto c = static_cast<unsigned char>(data[i]);
+        if (c < 0x20 || c >= 0x80 || c == '"' || c == '\\') break;
+    }
+    return i;
+}
+
+// Length of a valid UTF-8 sequence starting at data, or 0 when invalid.
+std::size_t utf8Sequence(const unsigned char* data, std::size_t size)
+{
+    const unsigned char c = data[0];
+    std::size_t length = 0;
+    std::uint32_t min = 0;
+    if (c >= 0xc2 && c <= 0xdf) { length = 2; min = 0x80; }
+    else if (c >= 0xe0 && c <= 0xef) { length = 3; min = 0x800; }
+    else if (c >= 0xf0 && c <= 0xf4) { length = 4; min = 0x10000; }
+    else return 0;
+    if (length > size) return 0;
+    std::uint32_t code = c & (0x7f >> length);
+    for (std::size_t i = 1; i < length; ++i) {
+        if ((data[i] & 0xc0) != 0x80) return 0;
+        code = (code << 6) | (data[i] & 0x3f);
+    }
+    if (code < min || code > 0x10ffff || (code >= 0xd800 && code <= 0xdfff)) return 0;
+    return length;
+}
+
+void appendChars(std::string& output, const char* begin, const char* end)
+{
+    output.append(begin, static_cast<std::size_t>(end - begin));
+}
+
+} // namespace
+
+void appendJsonEscaped(std::string& output, std::string_view text)
+{
+    output.push_back('"');
+    const char* data = text.data();
+    std::size_t size = text.size();
+    while (size) {
+        const auto plain = plainPrefix(data, size);
+        output.append(data, plain);
+        data += plain; size -= plain;
+        if (!size) break;
+        const auto c = static_cast<unsigned char>(*data);
+        if (c >= 0x80) {
+            const auto length = utf8Sequence(reinterpret_cast<const unsigned char*>(data), size);
+            if (length) output.append(data, length);
+            else output.append("\xef\xbf\xbd");
+            data += length ? length : 1; size -= length ? length : 1;
+            continue;
+        }
+        switch (c) {
+        case '"': output.append("\\\""); break;
+        case '\\': output.append("\\\\"); break;
+        case '\b': output.append("\\b"); break;
+        case '\f': output.append("\\f"); break;
+        case '\n': output.append("\\n"); break;
+        case '\r': output.append("\\r"); break;
+        case '\t': output.append("\\t"); break;
+        default: {
+            const char escaped[] = {'\\', 'u', '0', '0', kHexDigits[c >> 4], kHexDigits[c & 0x0f]};
+            output.append(escaped, sizeof(escaped));
+        }
+        }
+        ++data; --size;
+    }
+    output.push_back('"');
+}
+
+void appendHex(std::string& output, std::span<const std::uint8_t> bytes)
+{
+    const auto start = output.size();
+    output.resize(start + bytes.size() * 2);
+    char* out = output.data() + start;
+    std::size_t i = 0;
+#if defined(BENCH_JSON_SSE2)
+    const __m128i nibble = _mm_set1_epi8(0x0f);
+    const __m128i nine = _mm_set1_epi8(9);
+    const __m128i zero = _mm_set1_epi8('0');
+    const __m128i letter = _mm_set1_epi8('a' - '0' - 10);
+    auto ascii = [&](__m128i value) {
+        return _mm_add_epi8(_mm_add_epi8(value, zero), _mm_and_si128(_mm_cmpgt_epi8(value, nine), letter));
+    };
+    for (; i + 16 <= bytes.size(); i += 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes.data() + i));
+        const __m128i hi = ascii(_mm_and_si128(_mm_srli_epi16(chunk, 4), nibble));
+        const __m128i lo = ascii(_mm_and_si128(chunk, nibble));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 2), _mm_unpacklo_epi8(hi, lo));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 2 + 16), _mm_unpackhi_epi8(hi, lo));
+    }
+#elif defined(BENCH_JSON_NEON)
+    const uint8x16_t digits = vld1q_u8(reinterpret_cast<const std::uint8_t*>(kHexDigits));
+    for (; i + 16 <= bytes.size(); i += 16) {
+        const uint8x16_t chunk = vld1q_u8(bytes.data() + i);
+        uint8x16x2_t pair;
+        pair.val[0] = vqtbl1q_u8(digits, vshrq_n_u8(chunk, 4));
+        pair.val[1] = vqtbl1q_u8(digits, vandq_u8(chunk, vdupq_n_u8(0x0f)));
+        vst2q_u8(reinterpret_cast<std::uint8_t*>(out + i * 2), pair);
+    }
+#endif
+    for (; i < bytes.size(); ++i) {
+        out[i * 2] = kHexDigits[bytes[i] >> 4];
+        out[i * 2 + 1] = kHexDigits[bytes[i] & 0x0f];
+    }
+}
+
+JsonWriter& JsonWriter::key(std::string_view name)
+{
+    separate();
+    appendJsonEscaped(out_, name);
+    out_.push_back(':');
+    comma_ = false;
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(std::string_view text)
+{
+    separate();
+    appendJsonEscaped(out_, text);
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(bool flag)
+{
+    separate();
+    out_.append(flag ? "true" : "false");
+    return *this;
+}
+
+JsonWriter& JsonWriter::integer(long long number)
+{
+    separate();
+    std::array<char, 24> buffer;
+    const auto result = std::to_chars(buffer.data(), buffer.data() + buffer.size(), number);
+    appendChars(out_, buffer.data(), result.ptr);
+    return *this;
+}
+
+JsonWriter& JsonWriter::unsignedInteger(unsigned long long number)
+{
+    separate();
+    std::array<char, 24> buffer;
+    const auto result = std::to_chars(buffer.data(), buffer.data() + buffer.size(), number);
+    appendChars(out_, buffer.data(), result.ptr);
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(double number)
+{
+    if (!std::isfinite(number)) return null();
+    separate();
+    std::array<char, 32> buffer;
+    const auto result = std::to_chars(buffer.data(), buffer.data() + buffer.size(), number);
+    appendChars(out_, buffer.data(), result.ptr);
+    // Keep a fractional marker so readers see a floating-point value.
+    if (std::memchr(buffer.data(), '.', static_cast<std::size_t>(result.ptr - buffer.data())) == nullptr &&
+        std::memchr(buffer.data(), 'e', static_cast<std::size_t>(result.ptr - buffer.data())) == nullptr)
+        out_.append(".0");
+    return *this;
+}
+
+JsonWriter& JsonWriter::null()
+{
+    separate();
+    out_.append("null");
+    return *this;
+}
+
+JsonWriter& JsonWriter::hexValue(std::span<const std::uint8_t> bytes)
+{
+    separate();
+    out_.push_back('"');
+    appendHex(out_, bytes);
+    out_.push_back('"');
+    return *this;
+}
+
+JsonWriter& JsonWriter::raw(std::string_view json)
+{
+    separate();
+    out_.append(json);
+    return *this;
+}
+
+} // namespace bench
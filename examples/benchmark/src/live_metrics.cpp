@@ -0,0 +1,260 @@
+#include "live_metrics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace bench {
+namespace {
+
+std::string label(const std::string& value)
+{
+    std::string escaped;
+    for (const char c : value) {
+        if (c == '\\' || c == '"') escaped.push_back('\\');
+        if (c == '\n') { escaped += "\\n"; continue; }
+        escaped.push_back(c);
+    }
+    return escaped;
+}
+
+void header(std::ostringstream& out, const char* name, const char* type, const char* help)
+{
+    out << "# HELP " << name << ' ' << help << "\n# TYPE " << name << ' ' << type << '\n';
+}
+
+void sample(std::ostringstream& out, const std::string& name, double value)
+{
+    out << name << ' ';
+    if (std::isnan(value)) out << "NaN";
+    else out << value;
+    out << '\n';
+}
+
+} // namespace
+
+LiveMetrics::LiveMetrics(std::size_t total_samples, LiveMetricsOptions options)
+    : total_(total_samples), options_(std::move(options))
+{
+    if (options_.interval.count() <= 0) throw std::runtime_error("metrics interval must be positive");
+    if (!options_.latency_window) throw std::runtime_error("metrics latency window must be positive");
+    if (options_.http_port) {
+#ifdef _WIN32
+        throw std::runtime_error("--metrics-port is not supported on Windows; use --metrics-file");
+#else
+        listen_fd_ = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (listen_fd_ < 0) throw std::runtime_error(std::string("cannot open metrics socket: ") + std::strerror(errno));
+        const int reuse = 1;
+        ::setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof reuse);
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = htons(static_cast<std::uint16_t>(*options_.http_port));
+        socklen_t length = sizeof address;
+        if (::bind(listen_fd_, reinterpret_cast<sockaddr*>(&address), sizeof address) != 0 || ::listen(listen_fd_, 8) != 0 ||
+            ::getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+            const std::string error = std::strerror(errno);
+            ::close(listen_fd_);
+            throw std::runtime_error("cannot listen on 127.0.0.1:" + std::to_string(*options_.http_port) + ": " + error);
+        }
+        port_ = ntohs(address.sin_port);
+#endif
+    }
+    thread_ = std::thread([this] { run(); });
+}
+
+LiveMetrics::~LiveMetrics()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    thread_.join();
+#ifndef _WIN32
+    if (listen_fd_ >= 0) ::close(listen_fd_);
+#endif
+    // The last snapshot shows the finished run rather than the last tick.
+    if (!options_.textfile.empty()) {
+        try { writeTextfile(); } catch (const std::exception&) {}
+    }
+}
+
+void LiveMetrics::record(const std::string& decoder, std::int64_t decode_ns, std::size_t correct, std::size_t eligible,
+                         bool error, bool timed_out)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& stats = decoders_[decoder];
+    ++stats.decodes;
+    stats.decode_ns += decode_ns;
+    stats.correct += correct;
+    stats.eligible += eligible;
+    if (error) ++stats.errors;
+    if (timed_out) ++stats.timeouts;
+    if (stats.window.size() < options_.latency_window) stats.window.push_back(decode_ns);
+    else stats.window[stats.next] = decode_ns;
+    stats.next = (stats.next + 1) % options_.latency_window;
+}
+
+void LiveMetrics::sampleDone(bool resumed)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++done_;
+    if (resumed) ++resumed_;
+}
+
+void LiveMetrics::setRemainingMax(std::size_t remaining)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    total_ = done_ + remaining;
+    maximum_ = true;
+}
+
+std::string LiveMetrics::render() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - started_).count();
+    const auto processed = done_ - resumed_;
+    const double overall_rate = elapsed > 0 ? double(processed) / elapsed : 0.0;
+    const double rate = recent_rate_ > 0 ? recent_rate_ : overall_rate;
+    const auto remaining = total_ > done_ ? total_ - done_ : 0;
+    std::ostringstream out;
+    out.precision(9);
+    if (maximum_) {
+        header(out, "bench_samples_max", "gauge", "Most samples (images x repetitions) this run can reach; adaptive repetitions stop converged images early.");
+        sample(out, "bench_samples_max", double(total_));
+    } else {
+        header(out, "bench_samples", "gauge", "Samples (images x repetitions) in this run.");
+        sample(out, "bench_samples", double(total_));
+    }
+    header(out, "bench_samples_done", "gauge", "Samples finished, including ones resumed from an earlier run.");
+    sample(out, "bench_samples_done", double(done_));
+    header(out, "bench_elapsed_seconds", "gauge", "Wall time since the run loop started.");
+    sample(out, "bench_elapsed_seconds", elapsed);
+    header(out, "bench_images_per_second", "gauge", "Samples finished per second over the last metrics interval.");
+    sample(out, "bench_images_per_second", rate);
+    header(out, "bench_eta_seconds", "gauge", maximum_ ? "Longest time to finish at the current rate."
+                                                       : "Estimated time to finish at the current rate.");
+    sample(out, "bench_eta_seconds", remaining == 0 ? 0.0 : rate > 0 ? double(remaining) / rate
+                                                                     : std::numeric_limits<double>::quiet_NaN());
+
+    header(out, "bench_decodes_total", "counter", "Decoder calls recorded.");
+    for (const auto& [name, stats] : decoders_)
+        sample(out, "bench_decodes_total{decoder=\"" + label(name) + "\"}", double(stats.decodes));
+    header(out, "bench_decode_errors_total", "counter", "Decoder calls that ended with an error, timeouts included.");
+    for (const auto& [name, stats] : decoders_)
+        sample(out, "bench_decode_errors_total{decoder=\"" + label(name) + "\"}", double(stats.errors));
+    header(out, "bench_decode_timeouts_total", "counter", "Decoder calls that overran the deadline.");
+    for (const auto& [name, stats] : decoders_)
+        sample(out, "bench_decode_timeouts_total{decoder=\"" + label(name) + "\"}", double(stats.timeouts));
+    header(out, "bench_recall", "gauge", "Correct ground truth instances over eligible ones so far.");
+    for (const auto& [name, stats] : decoders_)
+        sample(out, "bench_recall{decoder=\"" + label(name) + "\"}", stats.eligible ? double(stats.correct) / stats.eligible : 0.0);
+    header(out, "bench_decode_latency_seconds", "summary", "Decode latency; quantiles cover the most recent calls only.");
+    for (const auto& [name, stats] : decoders_) {
+        auto window = stats.window;
+        std::sort(window.begin(), window.end());
+        const auto prefix = "bench_decode_latency_seconds";
+        const auto decoder = "decoder=\"" + label(name) + "\"";
+        for (const double q : {0.5, 0.9, 0.99}) {
+            std::ostringstream quantile;
+            quantile << q;
+            const double value = window.empty() ? std::numeric_limits<double>::quiet_NaN()
+                : double(window[static_cast<std::size_t>(q * double(window.size() - 1))]) / 1e9;
+            sample(out, std::string(prefix) + "{" + decoder + ",quantile=\"" + quantile.str() + "\"}", value);
+        }
+        sample(out, std::string(prefix) + "_sum{" + decoder + "}", double(stats.decode_ns) / 1e9);
+        sample(out, std::string(prefix) + "_count{" + decoder + "}", double(stats.decodes));
+    }
+    return out.str();
+}
+
+void LiveMetrics::writeTextfile() const
+{
+    const auto text = render();
+    auto temporary = options_.textfile;
+    temporary += ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary);
+        file << text;
+        if (!file) throw std::runtime_error("cannot write metrics: " + temporary.string());
+    }
+    std::filesystem::rename(temporary, options_.textfile);
+}
+
+void LiveMetrics::run()
+{
+    auto next_tick = started_ + options_.interval;
+    auto last_tick = started_;
+    std::size_t last_processed = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (listen_fd_ < 0) wake_.wait_until(lock, next_tick, [this] { return stop_; });
+            if (stop_) return;
+        }
+#ifndef _WIN32
+        if (listen_fd_ >= 0) {
+            pollfd request{listen_fd_, POLLIN, 0};
+            if (::poll(&request, 1, 100) > 0) serveOne();
+        }
+#endif
+        const auto now = std::chrono::steady_clock::now();
+        if (now < next_tick) continue;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            const auto processed = done_ - resumed_;
+            recent_rate_ = double(processed - last_processed) / std::chrono::duration<double>(now - last_tick).count();
+            last_processed = processed;
+        }
+        last_tick = now;
+        next_tick = now + options_.interval;
+        // A full disk or a vanished directory must not end a multi-hour run.
+        if (!options_.textfile.empty()) {
+            try { writeTextfile(); } catch (const std::exception&) {}
+        }
+    }
+}
+
+void LiveMetrics::serveOne()
+{
+#ifndef _WIN32
+    const int client = ::accept(listen_fd_, nullptr, nullptr);
+    if (client < 0) return;
+    timeval timeout{1, 0};
+    ::setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof timeout);
+    std::string request;
+    char buffer[1024];
+    while (request.find("\r\n\r\n") == std::string::npos && request.size() < 8192) {
+        const auto received = ::recv(client, buffer, sizeof buffer, 0);
+        if (received <= 0) break;
+        request.append(buffer, static_cast<std::size_t>(received));
+    }
+    const bool found = request.rfind("GET /metrics ", 0) == 0 || request.rfind("GET / ", 0) == 0;
+    const auto body = found ? render() : std::string("not found\n");
+    const auto response = std::string(found ? "HTTP/1.1 200 OK\r\n" : "HTTP/1.1 404 Not Found\r\n") +
+        "Content-Type: text/plain; version=0.0.4\r\nContent-Length: " + std::to_string(body.size()) +
+        "\r\nConnection: close\r\n\r\n" + body;
+    for (std::size_t sent = 0; sent < response.size();) {
+        const auto written = ::send(client, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+        if (written <= 0) break;
+        sent += static_cast<std::size_t>(written);
+    }
+    ::close(client);
+#endif
+}
+
+} // namespace bench
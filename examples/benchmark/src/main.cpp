@@ -1,9 +1,26 @@
+#include "adaptive_repetitions.h"
 #include "barber_dataset.h"
+#include "cache_evictor.h"
+#include "cascade_decoder.h"
+#include "comparison.h"
+#include "decode_watchdog.h"
 #include "decoder_adapter.h"
+#include "decoder_matrix.h"
+#include "environment.h"
 #include "hash.h"
+#include "hotspots.h"
 #include "image_loader.h"
+#include "image_pack.h"
+#include "isolated_decoder.h"
+#include "live_metrics.h"
 #include "matcher.h"
+#include "metrics.h"
+#include "racing_decoder.h"
+#include "resource_profile.h"
 #include "result_writer.h"
+#include "subset.h"
+#include "synthetic_corpus.h"
+#include "trace.h"
 
 #include <algorithm>
 #include <array>
@@ -11,10 +28,20 @@
 #include <cstdlib>
 #include <filesystem>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
 #include <map>
+#include <optional>
 #include <random>
+#include <sstream>
 #include <stdexcept>
+#include <thread>
+
+#ifdef __linux__
+#include <cerrno>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
 
 namespace fs = std::filesystem;
 namespace {
@@ -49,6 +76,15 @@ std::string licenseKey(const Options& options)
     return value;
 }
 
+bench::SummaryOptions summaryOptions(const Options& options)
+{
+    bench::SummaryOptions result;
+    if(options.count("--megapixel-buckets"))result.megapixel_buckets=bench::parseBucketEdges(options.at("--megapixel-buckets"));
+    if(options.count("--ppe-buckets"))result.ppe_buckets=bench::parseBucketEdges(options.at("--ppe-buckets"));
+    if(options.count("--bootstrap-resamples"))result.bootstrap_resamples=std::stoi(options.at("--bootstrap-resamples"));
+    return result;
+}
+
 int audit(const Options& options)
 {
     bench::BarberDataset dataset;
@@ -70,6 +106,117 @@ int audit(const Options& options)
     return summary.missing_images?2:0;
 }
 
+int synth(const Options& options)
+{
+    bench::SynthOptions synth;
+    synth.output=require(options,"--output");
+    if(options.count("--count"))synth.count=std::stoull(options.at("--count"));
+    if(options.count("--formats")){
+        std::stringstream list(options.at("--formats"));
+        for(std::string format;std::getline(list,format,',');)if(!format.empty())synth.formats.push_back(format);
+    }
+    if(options.count("--module-sizes"))synth.module_sizes=bench::parseBucketEdges(options.at("--module-sizes"));
+    if(options.count("--max-rotation"))synth.max_rotation_deg=std::stod(options.at("--max-rotation"));
+    if(options.count("--max-blur"))synth.max_blur=std::stod(options.at("--max-blur"));
+    if(options.count("--max-noise"))synth.max_noise=std::stod(options.at("--max-noise"));
+    if(options.count("--max-symbols"))synth.max_symbols=std::stoi(options.at("--max-symbols"));
+    if(options.count("--size")){
+        const auto size=options.at("--size");const auto x=size.find('x');
+        if(x==std::string::npos)throw std::runtime_error("--size must be WIDTHxHEIGHT");
+        synth.width=std::stoi(size.substr(0,x));synth.height=std::stoi(size.substr(x+1));
+    }
+    if(options.count("--image-format"))synth.image_format=options.at("--image-format");
+    if(options.count("--seed"))synth.seed=std::stoull(options.at("--seed"));
+    synth.threads=options.count("--threads")?std::stoi(options.at("--threads")):static_cast<int>(std::max(1u,std::thread::hardware_concurrency()));
+    const auto encoder=bench::createZxingEncoder();
+    const auto begin=std::chrono::steady_clock::now();
+    const auto summary=bench::generateSyntheticCorpus(synth,*encoder);
+    const std::chrono::duration<double> elapsed=std::chrono::steady_clock::now()-begin;
+    std::cout<<"images="<<summary.images<<" symbols="<<summary.symbols<<" skipped_symbols="<<summary.skipped_symbols
+             <<" seconds="<<elapsed.count()<<'\n'
+             <<"run with --images "<<(synth.output/"images").string()<<" --manifest "<<(synth.output/"manifest.jsonl").string()<<'\n';
+    return 0;
+}
+
+int subset(const Options& options)
+{
+    bench::SubsetOptions settings;
+    settings.size=std::stoull(require(options,"--size"));
+    if(options.count("--seed"))settings.seed=std::stoull(options.at("--seed"));
+    if(options.count("--megapixel-buckets"))settings.megapixel_buckets=bench::parseBucketEdges(options.at("--megapixel-buckets"));
+    if(options.count("--ppe-buckets"))settings.ppe_buckets=bench::parseBucketEdges(options.at("--ppe-buckets"));
+    const fs::path output=require(options,"--output");
+    const auto result=bench::selectSubset(bench::BarberDataset::readManifest(require(options,"--manifest")),settings);
+    bench::BarberDataset::writeManifest(output,result.records);
+    std::cout<<"images="<<result.records.size()<<"/"<<result.population<<" strata="<<result.strata<<" dimensions=";
+    for(std::size_t i=0;i<result.dimensions.size();++i)std::cout<<(i?",":"")<<result.dimensions[i];
+    std::cout<<"\nwrote "<<output<<'\n';
+    return 0;
+}
+
+fs::path resultsStream(const fs::path& path)
+{
+    return fs::is_directory(path)?path/"results.jsonl":path;
+}
+
+int compare(const Options& options)
+{
+    const auto baseline=resultsStream(require(options,"--baseline"));
+    const auto candidate=resultsStream(require(options,"--candidate"));
+    bench::ComparisonOptions settings;
+    if(options.count("--latency-threshold"))settings.latency_threshold=std::stod(options.at("--latency-threshold"));
+    if(options.count("--resamples"))settings.bootstrap_resamples=std::stoi(options.at("--resamples"));
+    if(options.count("--seed"))settings.seed=std::stoull(options.at("--seed"));
+    const auto report=bench::compareResults(baseline,candidate,settings);
+    const fs::path output=options.count("--output")?fs::path(options.at("--output")):candidate.parent_path()/"comparison.json";
+    bench::writeComparison(report,output);
+    std::cout<<std::fixed<<std::setprecision(3);
+    for(const auto& item:report.latency)
+        std::cout<<item.decoder<<" latency: pairs="<<item.pairs<<" mean_ms="<<item.baseline_mean_ms<<"->"<<item.candidate_mean_ms
+                 <<" change="<<item.relative_change*100<<"% ci95=["<<item.relative_change_ci95.first*100<<"%,"<<item.relative_change_ci95.second*100<<"%]"
+                 <<" median_delta_ms="<<item.median_delta_ms<<" wilcoxon_p="<<item.wilcoxon_p<<(item.regressed?" REGRESSED":"")<<'\n';
+    for(const auto& item:report.recall)
+        std::cout<<item.decoder<<" recall "<<item.format<<": "<<item.baseline_correct<<"/"<<item.baseline_eligible<<"->"
+                 <<item.candidate_correct<<"/"<<item.candidate_eligible<<" delta="<<item.delta*100<<"pp ci95=["
+                 <<item.delta_ci95.first*100<<","<<item.delta_ci95.second*100<<"]"<<(item.regressed?" REGRESSED":"")<<'\n';
+    if(report.baseline_only||report.candidate_only)
+        std::cout<<"unpaired: baseline_only="<<report.baseline_only<<" candidate_only="<<report.candidate_only<<'\n';
+    std::cout<<"wrote "<<output<<'\n';
+    return report.regressed()?2:0;
+}
+
+int pack(const Options& options)
+{
+    const fs::path output=require(options,"--output");
+    const auto records=bench::BarberDataset::readManifest(require(options,"--manifest"));
+    const auto summary=bench::writeImagePack(require(options,"--images"),records,output);
+    std::cout<<"images="<<summary.images<<" blobs="<<summary.blobs<<" image_bytes="<<summary.image_bytes
+             <<" pack_bytes="<<summary.file_bytes<<"\nwrote "<<output<<'\n';
+    return 0;
+}
+
+int hotspots(const Options& options)
+{
+    bench::HotspotOptions settings;
+    if(options.count("--top"))settings.top=std::stoull(options.at("--top"));
+    if(options.count("--cv-threshold"))settings.cv_threshold=std::stod(options.at("--cv-threshold"));
+    if(options.count("--min-repetitions"))settings.min_repetitions=std::stoull(options.at("--min-repetitions"));
+    const fs::path output=require(options,"--output");
+    const auto report=bench::findHotspots(resultsStream(require(options,"--results")),settings);
+    std::vector<bench::ManifestRecord> records;
+    for(const auto& sample:report.samples)records.push_back(sample.record);
+    bench::BarberDataset::writeManifest(output,records);
+    auto reasons=output;reasons.replace_extension(".reasons.json");
+    bench::writeHotspotReport(report,settings,reasons);
+    std::cout<<std::fixed<<std::setprecision(3);
+    for(std::size_t i=0;i<std::min<std::size_t>(5,report.samples.size());++i)
+        std::cout<<report.samples[i].record.sample_id<<" worst_median_ms="<<report.samples[i].worst_median_ms
+                 <<" reasons="<<report.samples[i].reasons.size()<<'\n';
+    std::cout<<"images="<<records.size()<<"/"<<report.images<<" decoders="<<report.decoders<<" records="<<report.records<<'\n'
+             <<"wrote "<<output<<" and "<<reasons<<'\n';
+    return 0;
+}
+
 std::vector<bench::MatchItem> errorMatches(const bench::ManifestRecord& sample,bench::Outcome outcome)
 {
     std::vector<bench::MatchItem> result;
@@ -78,14 +225,169 @@ std::vector<bench::MatchItem> errorMatches(const bench::ManifestRecord& sample,b
     return result;
 }
 
+// The node's CPUs that this process may use; a cpuset can hide some.
+bench::NumaNode numaNode(const std::string& text)
+{
+    const int id=std::stoi(text);
+    for(auto node:bench::numaTopology()){
+        if(node.id!=id)continue;
+        const auto allowed=bench::allowedCpus();
+        std::erase_if(node.cpus,[&](int cpu){return !std::binary_search(allowed.begin(),allowed.end(),cpu);});
+        if(node.cpus.empty())throw std::runtime_error("none of NUMA node "+text+"'s CPUs are available to this process");
+        return node;
+    }
+    throw std::runtime_error("no NUMA node "+text+" with CPUs under /sys/devices/system/node");
+}
+
+// Starts this executable again with `arguments` and waits for it.
+int runSelf(const std::vector<std::string>& arguments)
+{
+#ifdef __linux__
+    std::vector<char*> argv{const_cast<char*>("barcode_benchmark")};
+    for(const auto& argument:arguments)argv.push_back(const_cast<char*>(argument.c_str()));
+    argv.push_back(nullptr);
+    std::cout<<std::flush;
+    const pid_t child=::fork();
+    if(child<0)throw std::runtime_error("fork failed");
+    if(child==0){::execv("/proc/self/exe",argv.data());::_exit(127);}
+    int status=0;
+    while(::waitpid(child,&status,0)<0)if(errno!=EINTR)throw std::runtime_error("waitpid failed");
+    return WIFEXITED(status)?WEXITSTATUS(status):128+WTERMSIG(status);
+#else
+    (void)arguments;
+    throw std::runtime_error("--numa-node each needs Linux");
+#endif
+}
+
+// --numa-node each: one full run per node, each in a fresh process so no
+// heap page first touched on an earlier node is reused, then numa.json
+// lines the nodes up per decoder.
+int executeEachNumaNode(const std::string& command,const Options& options)
+{
+    const auto nodes=bench::numaTopology();
+    if(nodes.empty())throw std::runtime_error("no NUMA nodes with CPUs under /sys/devices/system/node");
+    const fs::path output=require(options,"--output");
+    nlohmann::json report={{"nodes",nlohmann::json::object()}};
+    int result=0;
+    for(const auto& node:nodes){
+        const auto node_output=output/("numa-node"+std::to_string(node.id));
+        auto child=options;
+        child["--numa-node"]=std::to_string(node.id);
+        child["--output"]=node_output.string();
+        if(child.count("--trace"))child["--trace"]=(node_output/"trace.json").string();
+        // The text file stays in its directory so a textfile collector still
+        // finds it, but each node gets its own name.
+        if(child.count("--metrics-file")){
+            fs::path metrics=child["--metrics-file"];
+            child["--metrics-file"]=(metrics.parent_path()/(metrics.stem().string()+".numa-node"+std::to_string(node.id)+metrics.extension().string())).string();
+        }
+        std::vector<std::string> arguments{command};
+        for(const auto& [key,value]:child){arguments.push_back(key);arguments.push_back(value);}
+        std::cout<<"numa_node="<<node.id<<" output="<<node_output.string()<<'\n';
+        const auto begin=std::chrono::steady_clock::now();
+        const int status=runSelf(arguments);
+        const double wall_seconds=std::chrono::duration<double>(std::chrono::steady_clock::now()-begin).count();
+        auto& entry=report["nodes"][std::to_string(node.id)];
+        entry={{"cpus",node.cpus},{"memory_bytes",node.memory_bytes},{"output",node_output.string()},{"exit_status",status},
+               {"wall_seconds",wall_seconds}};
+        if(status!=0){if(!result)result=status;continue;}
+        std::ifstream in(node_output/"summary.json");
+        const auto summary=nlohmann::json::parse(in);
+        // Throughput is over the node run's wall time, so it includes image
+        // loading and every decoder sharing the node, unlike 1/mean latency.
+        std::size_t decodes=0;
+        for(const auto& [decoder,stats]:summary.at("decoders").items()){
+            if(!stats.contains("by_numa_node")||!stats["by_numa_node"].contains(std::to_string(node.id)))continue;
+            auto numbers=stats["by_numa_node"][std::to_string(node.id)];
+            numbers["coverage_adjusted_recall"]=stats.value("coverage_adjusted_recall",0.0);
+            numbers["decodes_per_second"]=wall_seconds>0?numbers["records"].get<double>()/wall_seconds:0.0;
+            decodes+=numbers["records"].get<std::size_t>();
+            entry["decoders"][decoder]=numbers;
+        }
+        entry["decodes_per_second"]=wall_seconds>0?double(decodes)/wall_seconds:0.0;
+    }
+    fs::create_directories(output);
+    std::ofstream(output/"numa.json")<<std::setw(2)<<report<<'\n';
+    std::cout<<std::fixed<<std::setprecision(3);
+    for(const auto& [node,entry]:report["nodes"].items()){
+        if(!entry.contains("decoders")){std::cout<<"node "<<node<<": exit_status="<<entry["exit_status"]<<'\n';continue;}
+        std::cout<<"node "<<node<<": wall_seconds="<<entry["wall_seconds"].get<double>()<<" decodes_per_second="<<entry["decodes_per_second"].get<double>()<<'\n';
+        for(const auto& [decoder,numbers]:entry["decoders"].items())
+            std::cout<<"node "<<node<<" "<<decoder<<": mean_ms="<<numbers["mean_decode_ms"].get<double>()
+                     <<" p95_ms="<<numbers["p95_decode_ms"].get<double>()<<" decodes_per_second="<<numbers["decodes_per_second"].get<double>()<<'\n';
+    }
+    std::cout<<"wrote "<<output/"numa.json"<<'\n';
+    return result;
+}
+
 int execute(const Options& options,bool smoke)
 {
-    const fs::path image_root=require(options,"--images");
+    // --pack replaces the image directory with a single packed file.
+    const fs::path image_root=options.count("--pack")?fs::path():fs::path(require(options,"--images"));
     const fs::path manifest=require(options,"--manifest");
     const fs::path output=require(options,"--output");
-    const fs::path dbr_config=options.count("--dbr-config")?options.at("--dbr-config"):"";
-    const std::string dbr_template_label=options.count("--dbr-template")?options.at("--dbr-template"):"ReadBarcodes_Default";
-    auto samples=bench::BarberDataset::readManifest(manifest);
+    std::vector<bench::DecoderConfig> configs;
+    if(options.count("--config-matrix")){
+        if(options.count("--dbr-config")||options.count("--dbr-template")||options.count("--zxing-config"))
+            throw std::runtime_error("--config-matrix replaces --dbr-config, --dbr-template and --zxing-config");
+        configs=bench::readDecoderMatrix(options.at("--config-matrix"));
+    }else{
+        bench::DecoderConfig zxing_config,dbr_config;
+        zxing_config.family="zxing-cpp";
+        if(options.count("--zxing-config"))zxing_config.config=options.at("--zxing-config");
+        dbr_config.family="dynamsoft-dbr";
+        if(options.count("--dbr-config"))dbr_config.config=options.at("--dbr-config");
+        if(options.count("--dbr-template"))dbr_config.template_name=options.at("--dbr-template");
+        configs={zxing_config,dbr_config};
+    }
+    // Scheduling controls go first so every thread and worker started below
+    // inherits them.
+    // --numa-node binds the runner before anything is allocated, so image
+    // buffers, decoder state and the workers started below are first touched
+    // on that node.
+    std::optional<bench::NumaNode> numa_node;
+    if(options.count("--numa-node")){
+        if(options.count("--pin-cpus"))throw std::runtime_error("--numa-node and --pin-cpus both choose CPUs; use one");
+        numa_node=numaNode(options.at("--numa-node"));
+        bench::pinCurrentThread(numa_node->cpus);
+        std::cout<<"numa_node="<<numa_node->id<<" cpus="<<numa_node->cpus.size()<<'\n';
+    }
+    std::vector<int> pin_cpus;
+    if(options.count("--pin-cpus")){
+        pin_cpus=bench::parseCpuList(options.at("--pin-cpus"));
+        bench::pinCurrentThread(pin_cpus);
+    }
+    auto profile=bench::resourceProfile(options.count("--profile")?options.at("--profile"):"host");
+    if(options.count("--profile-cpus"))profile.cpus=std::stoull(options.at("--profile-cpus"));
+    if(options.count("--profile-cpu-quota")){
+        const double quota=std::stod(options.at("--profile-cpu-quota"));
+        profile.cpu_quota=quota>0?std::optional<double>(quota):std::nullopt;
+    }
+    if(options.count("--profile-memory-mb"))profile.memory_limit_bytes=std::stoull(options.at("--profile-memory-mb"))<<20;
+    // An explicit --pin-cpus list wins over the profile's CPU count.
+    if(profile.cpus&&pin_cpus.empty()){
+        auto allowed=bench::allowedCpus();
+        if(allowed.size()<profile.cpus)throw std::runtime_error("profile "+profile.name+" needs "+std::to_string(profile.cpus)+" CPUs but only "+std::to_string(allowed.size())+" are available");
+        allowed.resize(profile.cpus);
+        bench::pinCurrentThread(allowed);
+        std::cout<<"profile="<<profile.name<<" cpus="<<allowed.front()<<"-"<<allowed.back()<<'\n';
+    }
+    if(options.count("--nice"))bench::setNice(std::stoi(options.at("--nice")));
+    if(options.count("--sched-fifo"))bench::setFifoPriority(std::stoi(options.at("--sched-fifo")));
+    auto environment=bench::captureEnvironment();
+    environment["run_controls"]={{"pin_cpus",pin_cpus},
+        {"nice",options.count("--nice")?nlohmann::json(std::stoi(options.at("--nice"))):nlohmann::json(nullptr)},
+        {"sched_fifo",options.count("--sched-fifo")?nlohmann::json(std::stoi(options.at("--sched-fifo"))):nlohmann::json(nullptr)},
+        {"profile",{{"name",profile.name},{"cpus",profile.cpus},
+                    {"cpu_quota",profile.cpu_quota?nlohmann::json(*profile.cpu_quota):nlohmann::json(nullptr)},
+                    {"memory_limit_mb",profile.memory_limit_bytes>>20}}}};
+    if(options.count("--pack"))environment["run_controls"]["image_pack"]=options.at("--pack");
+    if(numa_node)environment["run_controls"]["numa_node"]={{"id",numa_node->id},{"cpus",numa_node->cpus}};
+    const auto environment_hash=bench::environmentHash(environment);
+    for(const auto& warning:bench::environmentWarnings(environment,pin_cpus))std::cerr<<"warning: "<<warning<<'\n';
+    const fs::path trace_path=options.count("--trace")?options.at("--trace"):"";
+    if(!trace_path.empty()){bench::startTrace();bench::nameTraceThread("runner");}
+    auto samples=[&]{bench::TraceSpan span("manifest");return bench::BarberDataset::readManifest(manifest);}();
     if(smoke&&samples.size()!=10)throw std::runtime_error("smoke manifest must contain exactly 10 images");
     if(samples.empty())throw std::runtime_error("manifest contains no benchmark images");
     for(const auto& sample:samples){
@@ -93,64 +395,271 @@ int execute(const Options& options,bool smoke)
         if(std::any_of(sample.ground_truth.begin(),sample.ground_truth.end(),[](const auto& gt){return !gt.decode_eligible;}))
             throw std::runtime_error("manifest contains excluded ground truth: "+sample.relative_path);
     }
-    const int repetitions=options.count("--repetitions")?std::stoi(options.at("--repetitions")):1;
+    std::unique_ptr<bench::ImagePack> image_pack;
+    if(options.count("--pack")){
+        bench::TraceSpan span("pack_verify");
+        image_pack=std::make_unique<bench::ImagePack>(options.at("--pack"));
+        image_pack->checkManifest(samples);
+        const bool verify=!options.count("--pack-verify")||options.at("--pack-verify")!="0";
+        const auto verified=verify?image_pack->verify(samples):0;
+        std::cout<<"image_pack="<<options.at("--pack")<<" entries="<<image_pack->size()<<" bytes="<<image_pack->fileBytes()
+                 <<" verified_blobs="<<verified<<'\n';
+    }
+    const auto summary_options=summaryOptions(options);
+    // With --adaptive-precision, --repetitions is the cap per image rather
+    // than a fixed count.
+    std::unique_ptr<bench::AdaptiveRepetitions> adaptive;
+    if(options.count("--adaptive-precision")){
+        bench::AdaptiveOptions settings;
+        settings.relative_precision=std::stod(options.at("--adaptive-precision"));
+        if(options.count("--min-repetitions"))settings.min_repetitions=std::stoi(options.at("--min-repetitions"));
+        if(options.count("--repetitions"))settings.max_repetitions=std::stoi(options.at("--repetitions"));
+        adaptive=std::make_unique<bench::AdaptiveRepetitions>(settings);
+    }
+    const int repetitions=adaptive?adaptive->options().max_repetitions:options.count("--repetitions")?std::stoi(options.at("--repetitions")):1;
+    const int loader_scale=options.count("--loader-scale")?std::stoi(options.at("--loader-scale")):1;
+    auto loader=bench::createImageLoader(options.count("--loader")?options.at("--loader"):"stb",loader_scale);
     int max_symbols=1;
     for(const auto& sample:samples)max_symbols=std::max(max_symbols,static_cast<int>(sample.ground_truth.size()));
-    auto zxing=bench::createZxingDecoder(max_symbols);
-    auto dbr=bench::createDynamsoftDecoder(dbr_config.string(),dbr_template_label,licenseKey(options),max_symbols);
-    std::cout<<"ZXing-C++="<<zxing->version()<<" DBR="<<dbr->version()
+    const auto license=licenseKey(options);
+    std::shared_ptr<bench::SharedImageBuffer> shared_images;
+    // CPU quotas and memory caps apply to decoder workers, so either implies
+    // isolation.
+    if((options.count("--isolate-decoders")&&options.at("--isolate-decoders")!="0")||profile.cpu_quota||profile.memory_limit_bytes)
+        shared_images=std::make_shared<bench::SharedImageBuffer>();
+    // Workers join a cgroup with cpu.max and memory.max when the hierarchy is
+    // delegated to us; otherwise the memory cap falls back to RLIMIT_AS.
+    std::unique_ptr<bench::WorkerCgroup> cgroup;
+    if(profile.cpu_quota||profile.memory_limit_bytes){
+        std::string reason;
+        cgroup=bench::WorkerCgroup::create(profile,reason);
+        if(cgroup)std::cout<<"worker_cgroup="<<cgroup->path().string()<<'\n';
+        else std::cerr<<"warning: no cgroup limits ("<<reason<<")"<<(profile.memory_limit_bytes?"; capping worker address space instead":"")<<'\n';
+    }
+    const bool rlimit_memory=profile.memory_limit_bytes&&!(cgroup&&cgroup->limitsMemory());
+    // One adapter per configuration; each gets its own config_sha256.
+    std::vector<std::unique_ptr<bench::IDecoderAdapter>> decoders;
+    std::vector<std::string> config_hashes;
+    const bool race=options.count("--race")&&options.at("--race")!="0";
+    // With --race every configuration is built twice: once standalone and
+    // once as a member of the racing decoder, which needs its own instances.
+    std::vector<std::unique_ptr<bench::IDecoderAdapter>> race_members;
+    // --cascade adds a coarse-to-fine variant of every configuration, which
+    // escalates while fewer than --cascade-expected symbols were found.
+    std::vector<int> cascade_levels;
+    if(options.count("--cascade"))cascade_levels=bench::parseCascadeLevels(options.at("--cascade"));
+    const std::size_t cascade_expected=options.count("--cascade-expected")?std::stoul(options.at("--cascade-expected")):1;
+    std::vector<std::unique_ptr<bench::IDecoderAdapter>> cascades;
+    std::vector<std::string> cascade_hashes;
+    for(const auto& config:configs){
+        auto factory=[=]{
+            auto decoder=config.family=="zxing-cpp"?bench::createZxingDecoder(max_symbols)
+                :bench::createDynamsoftDecoder(config.config.string(),config.template_name,license,max_symbols);
+            return bench::renameDecoder(std::move(decoder),config.name());
+        };
+        // Worker processes each take one pinned CPU in turn; in-process
+        // decoders share the whole list with the runner thread. A cascade
+        // stages its downscaled levels for its worker, which would overwrite
+        // the runner's staged image, so its worker gets a buffer of its own.
+        auto create=[&](bool own_images=false)->std::unique_ptr<bench::IDecoderAdapter>{
+            if(!shared_images)return factory();
+            const int cpu=pin_cpus.empty()?-1:pin_cpus[(decoders.size()+race_members.size()+cascades.size())%pin_cpus.size()];
+            const auto* group=cgroup.get();
+            const auto memory_limit=rlimit_memory?profile.memory_limit_bytes:0;
+            return std::make_unique<bench::IsolatedDecoder>([=]{
+                if(cpu>=0)bench::pinCurrentThread({cpu});
+                if(group)group->join();
+                if(memory_limit)bench::limitAddressSpace(memory_limit);
+                return factory();
+            },own_images?std::make_shared<bench::SharedImageBuffer>():shared_images);
+        };
+        decoders.push_back(create());
+        if(race)race_members.push_back(create());
+        if(config.family=="zxing-cpp")
+            config_hashes.push_back(bench::sha256File(config.config.empty()?fs::path("configs/zxing_all_supported.json"):config.config));
+        else
+            config_hashes.push_back(config.config.empty()?"dbr-template:"+config.template_name:bench::sha256File(config.config));
+        if(!cascade_levels.empty()){
+            cascades.push_back(std::make_unique<bench::CascadeDecoder>(create(true),cascade_levels,cascade_expected));
+            cascade_hashes.push_back(bench::sha256(config_hashes.back()+"|cascade:"+options.at("--cascade")+"|"+std::to_string(cascade_expected)));
+        }
+    }
+    if(race){
+        std::string joined;
+        for(const auto& hash:config_hashes)joined+=hash+"+";
+        // Cancelling an isolated loser kills its worker, so every race would
+        // wait for a respawn; such losers finish on their own instead.
+        decoders.push_back(std::make_unique<bench::RacingDecoder>(std::move(race_members),!shared_images));
+        config_hashes.push_back(bench::sha256(joined));
+    }
+    for(std::size_t i=0;i<cascades.size();++i){
+        decoders.push_back(std::move(cascades[i]));
+        config_hashes.push_back(cascade_hashes[i]);
+    }
+    std::unique_ptr<bench::DecodeWatchdog> watchdog;
+    if(options.count("--decode-timeout-ms")){
+        const std::chrono::milliseconds timeout(std::stoll(options.at("--decode-timeout-ms")));
+        if(timeout.count()<=0)throw std::runtime_error("--decode-timeout-ms must be positive");
+        watchdog=std::make_unique<bench::DecodeWatchdog>(timeout);
+        for(const auto& decoder:decoders)
+            std::cout<<decoder->name()<<" deadline="<<(decoder->setDeadline(timeout)?"native":"watchdog")<<'\n';
+    }
+    const std::string cache_state=options.count("--cache-state")?options.at("--cache-state"):"warm";
+    if(cache_state!="warm"&&cache_state!="cold"&&cache_state!="both")
+        throw std::runtime_error("--cache-state must be warm, cold or both");
+    std::unique_ptr<bench::CacheEvictor> evictor;
+    if(cache_state!="warm"){
+        const std::size_t thrash_mb=options.count("--cache-thrash-mb")?std::stoull(options.at("--cache-thrash-mb")):0;
+        evictor=std::make_unique<bench::CacheEvictor>(thrash_mb<<20);
+        std::cout<<"cache_state="<<cache_state<<" thrash_mb="<<(evictor->thrashBytes()>>20)<<'\n';
+    }
+    for(const auto& decoder:decoders)std::cout<<decoder->name()<<"="<<decoder->version()<<' ';
+    std::cout<<"loader="<<loader->name()<<" scale=1/"<<loader_scale<<" isolated="<<(shared_images?"yes":"no")
              <<" images="<<samples.size()<<" repetitions="<<repetitions<<'\n';
     fs::create_directories(output);
+    std::ofstream(output/"environment.json")<<std::setw(2)<<environment<<'\n';
     const auto jsonl=output/"results.jsonl";
-    auto completed=bench::completedKeys(jsonl);
+    auto completed=[&]{bench::TraceSpan span("resume_scan");return bench::completedKeys(jsonl);}();
+    if(adaptive){bench::TraceSpan span("resume_scan");adaptive->load(jsonl);}
+    // A decode is due when it has no record yet and, in adaptive mode, its
+    // image and decoder still need a tighter interval.
+    auto due=[&](const std::string& sample_id,const std::string& decoder_name,int repetition){
+        return !completed.count(bench::recordKey(sample_id,decoder_name,repetition))&&(!adaptive||adaptive->needsMore(sample_id,decoder_name));
+    };
     const auto manifest_hash=bench::sha256File(manifest);
-    const auto zxing_config_hash=bench::sha256File(options.count("--zxing-config")?options.at("--zxing-config"):"configs/zxing_all_supported.json");
-    const auto dbr_config_hash=dbr_config.empty()?std::string("dbr-template:")+dbr_template_label:bench::sha256File(dbr_config);
+
+    std::unique_ptr<bench::LiveMetrics> metrics;
+    if(options.count("--metrics-file")||options.count("--metrics-port")){
+        bench::LiveMetricsOptions settings;
+        if(options.count("--metrics-file"))settings.textfile=options.at("--metrics-file");
+        if(options.count("--metrics-port"))settings.http_port=std::stoi(options.at("--metrics-port"));
+        if(options.count("--metrics-interval"))settings.interval=std::chrono::milliseconds(static_cast<std::int64_t>(std::stod(options.at("--metrics-interval"))*1000));
+        metrics=std::make_unique<bench::LiveMetrics>(samples.size()*static_cast<std::size_t>(repetitions),settings);
+        if(settings.http_port)std::cout<<"metrics=http://127.0.0.1:"<<metrics->port()<<"/metrics\n";
+    }
 
     for(int repetition=0;repetition<repetitions;++repetition){
+        if(adaptive){
+            std::size_t active=0,active_samples=0;
+            for(const auto& sample:samples){
+                std::size_t units=0;
+                for(const auto& decoder:decoders)units+=adaptive->needsMore(sample.sample_id,decoder->name());
+                active+=units;active_samples+=units>0;
+            }
+            if(!active)break;
+            std::cout<<"repetition="<<(repetition+1)<<" adaptive_active="<<active<<'\n';
+            // Converged images drop out of the remaining work, so the
+            // progress total shrinks toward what the run will really do.
+            if(metrics)metrics->setRemainingMax(active_samples*static_cast<std::size_t>(repetitions-repetition));
+        }
         std::size_t sample_index=0;
         for(const auto& sample:samples){
-            const auto zxing_key=bench::recordKey(sample.sample_id,zxing->name(),repetition);
-            const auto dbr_key=bench::recordKey(sample.sample_id,dbr->name(),repetition);
-            if(completed.count(zxing_key)&&completed.count(dbr_key)){
+            if(std::none_of(decoders.begin(),decoders.end(),[&](const auto& decoder){return due(sample.sample_id,decoder->name(),repetition);})){
                 ++sample_index;
+                // A converged image is not part of the adaptive total.
+                const bool converged=adaptive&&std::none_of(decoders.begin(),decoders.end(),[&](const auto& decoder){return adaptive->needsMore(sample.sample_id,decoder->name());});
+                if(metrics&&!converged)metrics->sampleDone(true);
                 continue;
             }
             bench::ImageBuffer image;std::string error;
             const auto load_begin=std::chrono::steady_clock::now();
-            const bool loaded=bench::loadImage(image_root/sample.relative_path,image,error);
+            const bool loaded=[&]{
+                bench::TraceSpan span("image_load",sample.sample_id);
+                if(!image_pack)return loader->load(image_root/sample.relative_path,image,error);
+                return loader->decode(image_pack->bytes(*image_pack->find(sample.sample_id)),image,error);
+            }();
             const auto load_ns=std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now()-load_begin).count();
-            std::array<bench::IDecoderAdapter*,2> decoders={zxing.get(),dbr.get()};
-            std::mt19937 order(static_cast<unsigned>(std::hash<std::string>{}(sample.sample_id)^static_cast<std::size_t>(repetition)));
-            if(order()&1)std::swap(decoders[0],decoders[1]);
-            for(auto* decoder:decoders){
-                const auto key=bench::recordKey(sample.sample_id,decoder->name(),repetition);
-                if(completed.count(key))continue;
+            // Fault the next image in while this one is decoded; the madvise
+            // call stays out of image_load_ns.
+            if(image_pack&&sample_index+1<samples.size())image_pack->prefetch(*image_pack->find(samples[sample_index+1].sample_id));
+            if(loaded&&shared_images){bench::TraceSpan span("stage",sample.sample_id);image=shared_images->stage(image);}
+            for(const auto index:bench::decoderOrder(sample.sample_id,repetition,decoders.size())){
+                auto* decoder=decoders[index].get();
+                const auto decoder_name=decoder->name();
+                const auto key=bench::recordKey(sample.sample_id,decoder_name,repetition);
+                if(!due(sample.sample_id,decoder_name,repetition))continue;
                 bench::DecodeRun run;
-                if(loaded)run=decoder->decode(image);else run.error="input_pipeline_error: "+error;
+                std::optional<std::int64_t> cold_decode_ns;
+                auto timedDecode=[&](bool evict){
+                    if(evict){bench::TraceSpan span("evict",sample.sample_id);evictor->evict({image.data(),image.size()});}
+                    bench::TraceSpan span("decode",sample.sample_id,decoder_name);
+                    return watchdog?watchdog->decode(*decoder,image):decoder->decode(image);
+                };
+                const auto oom_kills=cgroup&&cgroup->limitsMemory()?cgroup->oomKills():0;
+                if(!loaded)run.error="input_pipeline_error: "+error;
+                else run=timedDecode(evictor!=nullptr);
+                // The cgroup OOM killer shows up as a SIGKILLed worker.
+                if(run.error&&run.error->rfind("decoder_crash:",0)==0&&cgroup&&cgroup->oomKills()>oom_kills)
+                    run.error="decoder_oom: worker killed by the cgroup OOM killer";
+                // In "both" mode the evicted decode above is followed by a
+                // warm one on the now cached buffer, which is what gets scored.
+                if(cache_state=="both"&&loaded&&!run.error){
+                    cold_decode_ns=run.decode_time.count();
+                    run=timedDecode(false);
+                }
                 bench::RawResultRecord record;
                 record.protocol="protocol-v1";record.manifest_sha256=manifest_hash;
-                record.sample=sample;record.decoder=decoder->name();record.decoder_version=decoder->version();
-                record.config_sha256=decoder==zxing.get()?zxing_config_hash:dbr_config_hash;
-                record.repetition=repetition;record.image_load_ns=load_ns;record.run=std::move(run);
-                if(record.run.error){
+                record.sample=sample;record.decoder=decoder_name;record.decoder_version=decoder->version();
+                record.config_sha256=config_hashes[index];record.environment_sha256=environment_hash;
+                record.repetition=repetition;record.image_loader=loader->name();record.image_scale=loader_scale;
+                record.image_load_ns=load_ns;record.cache_state=cache_state;record.cold_decode_ns=cold_decode_ns;
+                record.profile=profile.name;record.numa_node=numa_node?std::optional<int>(numa_node->id):std::nullopt;
+                record.run=std::move(run);
+                if(record.run.timed_out){
+                    record.matches=errorMatches(record.sample,bench::Outcome::Timeout);
+                }else if(record.run.error){
                     const auto outcome=loaded?bench::Outcome::DecoderError:bench::Outcome::InputPipelineError;
                     record.matches=errorMatches(record.sample,outcome);
                 }else{
+                    bench::TraceSpan span("match",sample.sample_id,decoder_name);
                     record.matches=bench::matchResults(record.sample.ground_truth,record.run.results,record.decoder);
                 }
-                bench::appendResult(jsonl,record);completed.insert(key);
+                {
+                    bench::TraceSpan span("write_result",sample.sample_id,decoder_name);
+                    bench::appendResult(jsonl,record);
+                }
+                completed.insert(key);
+                if(adaptive)adaptive->add(sample.sample_id,decoder_name,record.run.decode_time.count(),record.run.error||record.run.timed_out);
+                if(metrics){
+                    std::size_t correct=0,eligible=0;
+                    for(const auto& match:record.matches){
+                        if(match.outcome!=bench::Outcome::ExtraResult)++eligible;
+                        if(match.outcome==bench::Outcome::Correct)++correct;
+                    }
+                    metrics->record(record.decoder,record.run.decode_time.count(),correct,eligible,record.run.error.has_value(),record.run.timed_out);
+                }
             }
             ++sample_index;
+            if(metrics)metrics->sampleDone();
             if(sample_index%100==0||sample_index==samples.size())
                 std::cout<<"repetition="<<(repetition+1)<<" progress="<<sample_index<<"/"<<samples.size()<<'\n'<<std::flush;
         }
     }
+    for(const auto& decoder:decoders)
+        if(auto* isolated=dynamic_cast<bench::IsolatedDecoder*>(decoder.get()))std::cout<<decoder->name()<<" worker_restarts="<<isolated->restarts()<<'\n';
+    if(watchdog)std::cout<<"decode_timeouts="<<watchdog->overruns()<<" cancelled="<<watchdog->cancelled()<<'\n';
+    if(adaptive){
+        const auto report=adaptive->report();
+        bench::writeAdaptiveReport(report,adaptive->options(),output/"adaptive.json");
+        for(const auto& decoder:report.decoders)
+            std::cout<<decoder.decoder<<" adaptive: converged="<<decoder.converged<<"/"<<decoder.units<<" capped="<<decoder.capped
+                     <<" failed="<<decoder.failed<<" calls="<<decoder.decode_calls<<" max_repetitions="<<decoder.max_repetitions_used<<'\n';
+        std::cout<<"decode_calls="<<report.decode_calls<<" fixed_equivalent_calls="<<report.fixed_equivalent_calls
+                 <<" saved_calls="<<report.savedCalls()<<'\n';
+    }
     const auto summary=output/"summary.json";
     const auto results_json=output/"results.json";
-    bench::generateSummary(jsonl,summary);
-    bench::generateResultsJson(jsonl,summary,results_json);
+    {
+        bench::TraceSpan span("summary");
+        bench::generateSummary(jsonl,summary,summary_options);
+        bench::generateResultsJson(jsonl,summary,results_json);
+    }
     std::cout<<"wrote "<<jsonl<<", "<<summary<<" and "<<results_json<<'\n';
+    if(!trace_path.empty()){
+        bench::stopTrace();
+        const auto spans=bench::writeTrace(trace_path);
+        std::cout<<"wrote "<<trace_path<<" spans="<<spans<<'\n';
+    }
     return 0;
 }
 
@@ -159,8 +668,16 @@ void usage()
     std::cout
       <<"Usage:\n"
       <<"  barcode_benchmark audit --images DIR --annotations DIR [--output DIR]\n"
-      <<"  barcode_benchmark smoke --images DIR --manifest FILE --output DIR --license-key-file FILE [--dbr-config FILE] [--dbr-template NAME] [--zxing-config FILE] [--repetitions N]\n"
-      <<"  barcode_benchmark run   --images DIR --manifest FILE --output DIR --license-key-file FILE [--dbr-config FILE] [--dbr-template NAME] [--zxing-config FILE] [--repetitions N]\n";
+      <<"  barcode_benchmark smoke --images DIR|--pack FILE --manifest FILE --output DIR --license-key-file FILE [--dbr-config FILE] [--dbr-template NAME] [--zxing-config FILE] [--config-matrix FILE] [--repetitions N] [--adaptive-precision FRACTION] [--min-repetitions N] [--loader NAME] [--loader-scale 1|2|4|8] [--decode-timeout-ms N] [--megapixel-buckets LIST] [--ppe-buckets LIST] [--bootstrap-resamples N] [--trace FILE] [--isolate-decoders 1] [--cache-state warm|cold|both] [--cache-thrash-mb N] [--metrics-file FILE] [--metrics-port N] [--metrics-interval SECONDS] [--pin-cpus LIST] [--nice N] [--sched-fifo PRIORITY] [--profile host|edge] [--profile-cpus N] [--profile-cpu-quota CPUS] [--profile-memory-mb N] [--race 1] [--cascade LEVELS] [--cascade-expected N] [--pack-verify 0|1] [--numa-node N|each]\n"
+      <<"  barcode_benchmark run   --images DIR|--pack FILE --manifest FILE --output DIR --license-key-file FILE [--dbr-config FILE] [--dbr-template NAME] [--zxing-config FILE] [--config-matrix FILE] [--repetitions N] [--adaptive-precision FRACTION] [--min-repetitions N] [--loader NAME] [--loader-scale 1|2|4|8] [--decode-timeout-ms N] [--megapixel-buckets LIST] [--ppe-buckets LIST] [--bootstrap-resamples N] [--trace FILE] [--isolate-decoders 1] [--cache-state warm|cold|both] [--cache-thrash-mb N] [--metrics-file FILE] [--metrics-port N] [--metrics-interval SECONDS] [--pin-cpus LIST] [--nice N] [--sched-fifo PRIORITY] [--profile host|edge] [--profile-cpus N] [--profile-cpu-quota CPUS] [--profile-memory-mb N] [--race 1] [--cascade LEVELS] [--cascade-expected N] [--pack-verify 0|1] [--numa-node N|each]\n"
+      <<"  barcode_benchmark synth --output DIR [--count N] [--formats LIST] [--module-sizes LIST] [--max-rotation DEG] [--max-blur SIGMA] [--max-noise SIGMA] [--max-symbols N] [--size WxH] [--image-format jpg|png] [--seed N] [--threads N]\n"
+      <<"  barcode_benchmark subset --manifest FILE --output FILE --size N [--seed N] [--megapixel-buckets LIST] [--ppe-buckets LIST]\n"
+      <<"  barcode_benchmark compare --baseline DIR|FILE --candidate DIR|FILE [--output FILE] [--latency-threshold 0.05] [--resamples N] [--seed N]\n"
+      <<"  barcode_benchmark pack --images DIR --manifest FILE --output FILE\n"
+      <<"  barcode_benchmark hotspots --results DIR|FILE --output FILE [--top N] [--cv-threshold 0.25] [--min-repetitions N]\n";
+    std::cout<<"Image loaders:";
+    for(const auto& name:bench::availableImageLoaders())std::cout<<' '<<name;
+    std::cout<<'\n';
 }
 }
 
@@ -170,8 +687,15 @@ int main(int argc,char** argv)
         if(argc<2){usage();return 1;}
         const std::string command=argv[1];const auto options=parseOptions(argc,argv,2);
         if(command=="audit")return audit(options);
+        if((command=="smoke"||command=="run")&&options.count("--numa-node")&&options.at("--numa-node")=="each")
+            return executeEachNumaNode(command,options);
         if(command=="smoke")return execute(options,true);
         if(command=="run")return execute(options,false);
+        if(command=="synth")return synth(options);
+        if(command=="compare")return compare(options);
+        if(command=="subset")return subset(options);
+        if(command=="pack")return pack(options);
+        if(command=="hotspots")return hotspots(options);
         usage();return 1;
     }catch(const std::exception& error){std::cerr<<"error: "<<error.what()<<'\n';return 1;}
 }
@@ -30,6 +30,7 @@ std::string toString(Outcome value)
     case Outcome::DecoderError: return "decoder_error";
     case Outcome::LicenseOrInitializationError: return "license_or_initialization_error";
     case Outcome::InputPipelineError: return "input_pipeline_error";
+    case Outcome::Timeout: return "timeout";
     }
     return "unknown";
 }
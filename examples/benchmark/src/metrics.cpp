@@ -1,15 +1,292 @@
 #include "metrics.h"
 #include <algorithm>
+#include <atomic>
+#include <bit>
 #include <cmath>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
 
 namespace bench {
-std::pair<double,double> wilsonInterval(std::uint64_t k,std::uint64_t n)
+std::pair<double,double> wilsonInterval(double k,std::uint64_t n)
 {
     if(!n)return {0,0};
     constexpr double z=1.959963984540054;
-    const double p=double(k)/n,den=1+z*z/n;
+    const double p=k/n,den=1+z*z/n;
     const double center=(p+z*z/(2*n))/den;
     const double margin=z*std::sqrt((p*(1-p)+z*z/(4*n))/n)/den;
     return {std::max(0.0,center-margin),std::min(1.0,center+margin)};
 }
+
+std::pair<double,double> newcombeDifferenceInterval(double k1,std::uint64_t n1,double k2,std::uint64_t n2)
+{
+    if(!n1||!n2)return {0,0};
+    const double p1=k1/n1,p2=k2/n2,delta=p2-p1;
+    const auto [l1,u1]=wilsonInterval(k1,n1);
+    const auto [l2,u2]=wilsonInterval(k2,n2);
+    return {delta-std::sqrt((p2-l2)*(p2-l2)+(u1-p1)*(u1-p1)),delta+std::sqrt((u2-p2)*(u2-p2)+(p1-l1)*(p1-l1))};
+}
+
+WilcoxonResult wilcoxonSignedRank(const std::vector<double>& differences)
+{
+    std::vector<double> d;
+    for(double value:differences)if(value!=0.0&&!std::isnan(value))d.push_back(value);
+    WilcoxonResult result;result.nonzero=d.size();
+    if(d.empty())return result;
+    std::sort(d.begin(),d.end(),[](double a,double b){return std::abs(a)<std::abs(b);});
+    double tie_term=0;
+    for(std::size_t i=0;i<d.size();){
+        std::size_t j=i;
+        while(j<d.size()&&std::abs(d[j])==std::abs(d[i]))++j;
+        const double rank=(double(i+1)+double(j))/2,ties=double(j-i);
+        for(std::size_t k=i;k<j;++k)if(d[k]>0)result.w_plus+=rank;
+        tie_term+=ties*ties*ties-ties;i=j;
+    }
+    const double n=double(d.size()),mean=n*(n+1)/4;
+    const double variance=n*(n+1)*(2*n+1)/24-tie_term/48;
+    if(variance<=0)return result;
+    const double offset=result.w_plus-mean;
+    const double corrected=offset>0?std::max(0.0,offset-0.5):std::min(0.0,offset+0.5);
+    result.z=corrected/std::sqrt(variance);
+    result.p_value=std::erfc(std::abs(result.z)/std::sqrt(2.0));
+    return result;
+}
+
+namespace {
+std::uint64_t splitmix(std::uint64_t& state)
+{
+    std::uint64_t z=(state+=0x9e3779b97f4a7c15ull);
+    z=(z^(z>>30))*0xbf58476d1ce4e5b9ull;
+    z=(z^(z>>27))*0x94d049bb133111ebull;
+    return z^(z>>31);
+}
+
+// Independent starting state for replicate r of a bootstrap run.
+std::uint64_t replicateStream(std::uint64_t seed,int replicate)
+{
+    std::uint64_t stream=splitmix(seed)+0xd1b54a32d192ed03ull*static_cast<std::uint64_t>(replicate+1);
+    return splitmix(stream);
+}
+
+// Multiply-shift maps 32 random bits to [0, n); the bias is negligible for n < 2^32.
+std::size_t drawIndex(std::uint32_t bits,std::size_t n)
+{
+    return static_cast<std::size_t>((std::uint64_t{bits}*n)>>32);
+}
+
+int workerCount(int threads)
+{
+    return threads>0?threads:static_cast<int>(std::max(1u,std::thread::hardware_concurrency()));
+}
+
+// Calls body(scratch, replicate) for every replicate with a per-worker
+// scratch vector of n elements. Small jobs stay on the calling thread, where
+// spawning workers would cost more than it saves.
+template<typename T,typename Body>
+void forEachReplicate(int resamples,int threads,std::size_t n,Body&& body)
+{
+    int workers=workerCount(threads);
+    if(n*static_cast<std::size_t>(resamples)<(1u<<20))workers=1;
+    workers=std::clamp(workers,1,resamples);
+    std::atomic<int> next{0};
+    auto run=[&]{
+        std::vector<T> scratch(n);
+        for(int r;(r=next.fetch_add(1))<resamples;)body(scratch,r);
+    };
+    std::vector<std::thread> pool;
+    for(int w=1;w<workers;++w)pool.emplace_back(run);
+    run();
+    for(auto& thread:pool)thread.join();
+}
+
+std::pair<double,double> percentileInterval(std::vector<double>& values,double confidence)
+{
+    std::sort(values.begin(),values.end());
+    const double tail=(1-confidence)/2;
+    auto at=[&](double q){return values[static_cast<std::size_t>(std::clamp(q,0.0,1.0)*double(values.size()-1))];};
+    return {at(tail),at(1-tail)};
+}
+
+}
+
+std::pair<double,double> bootstrapInterval(std::size_t n,const std::function<double(std::span<const std::size_t>)>& statistic,
+                                           int resamples,std::uint64_t seed,double confidence,int threads)
+{
+    if(!n||resamples<1)return {0,0};
+    std::vector<double> values(static_cast<std::size_t>(resamples));
+    forEachReplicate<std::size_t>(resamples,threads,n,[&](std::vector<std::size_t>& indices,int r){
+        auto state=replicateStream(seed,r);
+        for(auto& index:indices)index=drawIndex(static_cast<std::uint32_t>(splitmix(state)>>32),n);
+        values[static_cast<std::size_t>(r)]=statistic(indices);
+    });
+    return percentileInterval(values,confidence);
+}
+
+LatencyIntervals bootstrapLatency(std::span<const std::int64_t> sorted,std::span<const double> quantiles,
+                                  int resamples,std::uint64_t seed,int threads)
+{
+    LatencyIntervals result;
+    result.quantiles.assign(quantiles.size(),{0.0,0.0});
+    const auto n=sorted.size();
+    if(!n||resamples<1)return result;
+    // Scan ranks in ascending order whatever order the caller asked for.
+    std::vector<std::pair<std::uint64_t,std::size_t>> ranks;
+    for(std::size_t j=0;j<quantiles.size();++j)
+        ranks.emplace_back(static_cast<std::uint64_t>(std::clamp(quantiles[j],0.0,1.0)*double(n-1)),j);
+    std::sort(ranks.begin(),ranks.end());
+
+    const auto count=static_cast<std::size_t>(resamples);
+    std::vector<double> means(count);
+    std::vector<std::vector<double>> estimates(quantiles.size(),std::vector<double>(count));
+    forEachReplicate<std::uint32_t>(resamples,threads,n,[&](std::vector<std::uint32_t>& counts,int r){
+        std::fill(counts.begin(),counts.end(),0u);
+        auto state=replicateStream(seed,r);
+        std::size_t drawn=0;
+        for(;drawn+2<=n;drawn+=2){
+            const auto bits=splitmix(state);
+            ++counts[drawIndex(static_cast<std::uint32_t>(bits),n)];
+            ++counts[drawIndex(static_cast<std::uint32_t>(bits>>32),n)];
+        }
+        if(drawn<n)++counts[drawIndex(static_cast<std::uint32_t>(splitmix(state)>>32),n)];
+        double total=0;
+        std::uint64_t seen=0;
+        std::size_t next=0;
+        for(std::size_t i=0;i<n;++i){
+            total+=double(counts[i])*double(sorted[i]);
+            seen+=counts[i];
+            for(;next<ranks.size()&&ranks[next].first<seen;++next)
+                estimates[ranks[next].second][static_cast<std::size_t>(r)]=double(sorted[i]);
+        }
+        means[static_cast<std::size_t>(r)]=total/double(n);
+    });
+    result.mean=percentileInterval(means,0.95);
+    for(std::size_t j=0;j<quantiles.size();++j)result.quantiles[j]=percentileInterval(estimates[j],0.95);
+    return result;
+}
+
+namespace {
+constexpr int kSubBits=LatencyHistogram::kSubBits;
+constexpr std::uint64_t kSub=1u<<kSubBits;
+
+std::size_t histogramIndex(std::uint64_t value)
+{
+    if(value<kSub)return static_cast<std::size_t>(value);
+    const int exponent=std::bit_width(value)-1-kSubBits;
+    const auto mantissa=(value>>exponent)&(kSub-1);
+    return static_cast<std::size_t>((exponent+1)*kSub+mantissa);
+}
+
+std::int64_t histogramValue(std::size_t index)
+{
+    if(index<kSub)return static_cast<std::int64_t>(index);
+    const auto exponent=static_cast<int>(index/kSub)-1;
+    const auto mantissa=static_cast<std::uint64_t>(index%kSub);
+    const auto low=(kSub|mantissa)<<exponent;
+    return static_cast<std::int64_t>(low+((std::uint64_t{1}<<exponent)>>1));
+}
+}
+
+void LatencyHistogram::add(std::int64_t ns)
+{
+    if(buckets_.empty())buckets_.assign(kBuckets,0);
+    const auto value=static_cast<std::uint64_t>(std::max<std::int64_t>(0,ns));
+    ++buckets_[std::min<std::size_t>(histogramIndex(value),kBuckets-1)];
+    ++count_;total_+=ns;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other)
+{
+    if(other.buckets_.empty())return;
+    if(buckets_.empty())buckets_.assign(kBuckets,0);
+    for(std::size_t i=0;i<buckets_.size();++i)buckets_[i]+=other.buckets_[i];
+    count_+=other.count_;total_+=other.total_;
+}
+
+std::vector<std::int64_t> LatencyHistogram::values() const
+{
+    std::vector<std::int64_t> result;
+    result.reserve(count_);
+    for(std::size_t i=0;i<buckets_.size();++i)result.insert(result.end(),buckets_[i],histogramValue(i));
+    return result;
+}
+
+std::int64_t LatencyHistogram::quantile(double q) const
+{
+    if(!count_)return 0;
+    // Same nearest-rank convention as the exact percentiles in the summary.
+    const auto rank=static_cast<std::uint64_t>(std::clamp(q,0.0,1.0)*static_cast<double>(count_-1));
+    std::uint64_t seen=0;
+    for(std::size_t i=0;i<buckets_.size();++i){
+        seen+=buckets_[i];
+        if(seen>rank)return histogramValue(i);
+    }
+    return histogramValue(buckets_.size()-1);
+}
+
+StratifiedEstimate stratifiedRatio(const std::vector<StratifiedUnit>& units)
+{
+    StratifiedEstimate result;result.samples=units.size();
+    double wy=0,wx=0;
+    for(const auto& unit:units){wy+=unit.weight*unit.y;wx+=unit.weight*unit.x;result.population+=unit.weight;}
+    if(wx<=0)return result;
+    result.value=wy/wx;
+    struct Stratum{std::size_t n=0;double weight=0,sum=0,squares=0;};
+    std::map<std::string,Stratum> strata;
+    double pooled_sum=0,pooled_squares=0;
+    for(const auto& unit:units){
+        const double z=unit.y-result.value*unit.x;
+        auto& h=strata[unit.stratum];
+        ++h.n;h.weight+=unit.weight;h.sum+=z;h.squares+=z*z;
+        pooled_sum+=z;pooled_squares+=z*z;
+    }
+    result.strata=strata.size();
+    const double n=double(units.size());
+    const double pooled=n>1?std::max(0.0,(pooled_squares-pooled_sum*pooled_sum/n)/(n-1)):0.0;
+    double variance=0;
+    for(const auto& [name,h]:strata){
+        const double nh=double(h.n),fpc=std::max(0.0,1-nh/h.weight);
+        const double s2=h.n>1?std::max(0.0,(h.squares-h.sum*h.sum/nh)/(nh-1)):pooled;
+        variance+=h.weight*h.weight*fpc*s2/nh;
+    }
+    result.standard_error=std::sqrt(variance)/wx;
+    return result;
+}
+
+double studentT95(std::size_t df)
+{
+    static constexpr std::array<double,30> table={
+        12.706,4.303,3.182,2.776,2.571,2.447,2.365,2.306,2.262,2.228,
+        2.201,2.179,2.160,2.145,2.131,2.120,2.110,2.101,2.093,2.086,
+        2.080,2.074,2.069,2.064,2.060,2.056,2.052,2.048,2.045,2.042};
+    if(df==0)return std::numeric_limits<double>::infinity();
+    if(df<=table.size())return table[df-1];
+    constexpr double z=1.959963984540054;
+    return z+(z*z*z+z)/(4.0*double(df));
+}
+
+std::size_t bucketIndex(const std::vector<double>& edges,double value)
+{
+    return static_cast<std::size_t>(std::upper_bound(edges.begin(),edges.end(),value)-edges.begin());
+}
+
+std::string bucketLabel(const std::vector<double>& edges,std::size_t index)
+{
+    auto text=[](double value){std::ostringstream out;out<<value;return out.str();};
+    if(edges.empty())return "all";
+    if(index==0)return "<"+text(edges.front());
+    if(index>=edges.size())return ">="+text(edges.back());
+    return text(edges[index-1])+"-"+text(edges[index]);
+}
+
+std::vector<double> parseBucketEdges(const std::string& text)
+{
+    std::vector<double> edges;
+    std::stringstream input(text);std::string item;
+    while(std::getline(input,item,','))if(!item.empty())edges.push_back(std::stod(item));
+    if(edges.empty()||!std::is_sorted(edges.begin(),edges.end())||std::adjacent_find(edges.begin(),edges.end())!=edges.end())
+        throw std::runtime_error("bucket edges must be a strictly increasing comma-separated list: "+text);
+    return edges;
+}
 }
@@ -32,6 +32,12 @@ bool validGtin(std::string_view value)
     return (10-(sum%10))%10==value.back()-'0';
 }
 
+// Codabar start/stop characters; some readers report them as T, N, * and E.
+bool codabarGuard(char c)
+{
+    return std::string_view("ABCDTN*Eabcdtn*e").find(c) != std::string_view::npos;
+}
+
 } // namespace
 
 std::string canonicalFormat(std::string_view value)
@@ -40,6 +46,7 @@ std::string canonicalFormat(std::string_view value)
         {"AZTEC", "AZTEC"}, {"C128", "CODE_128"}, {"CODE128", "CODE_128"},
         {"UCC128", "GS1_128"}, {"GS1128", "GS1_128"},
         {"C39", "CODE_39"}, {"CODE39", "CODE_39"}, {"CODE39EXTENDED", "CODE_39"},
+        {"C93", "CODE_93"}, {"CODE93", "CODE_93"}, {"CODABAR", "CODABAR"}, {"NW7", "CODABAR"},
         {"DATAMATRIX", "DATA_MATRIX"}, {"EAN13", "EAN_13"}, {"EAN8", "EAN_8"},
         {"2DIGIT", "EAN_2"}, {"EAN2", "EAN_2"},
         {"I2O5", "ITF"}, {"ITF", "ITF"}, {"INTERLEAVED2OF5", "ITF"},
@@ -117,6 +124,8 @@ std::string normalizedPayload(std::string_view format, std::string_view payload)
         result.erase(result.begin());
     if (canonical == "CODE_39" && result.size() >= 2 && result.front() == '*' && result.back() == '*')
         result = result.substr(1, result.size() - 2);
+    if (canonical == "CODABAR" && result.size() >= 2 && codabarGuard(result.front()) && codabarGuard(result.back()))
+        result = result.substr(1, result.size() - 2);
     if (canonical == "CODE_128" || canonical == "GS1_128")
         stripLeadingGs1Marker(result);
     return result;
@@ -145,8 +154,8 @@ bool isPayloadStructurallyValid(std::string_view format, std::string_view payloa
 const std::unordered_set<std::string>& zxingSupportedFormats()
 {
     static const std::unordered_set<std::string> value = {
-        "AZTEC", "CODE_128", "GS1_128", "CODE_39", "DATA_MATRIX", "EAN_13",
-        "EAN_8", "EAN_2", "ITF", "PDF_417", "QR_CODE", "UPC_A", "UPC_E"
+        "AZTEC", "CODABAR", "CODE_128", "GS1_128", "CODE_39", "CODE_93", "DATA_MATRIX",
+        "EAN_13", "EAN_8", "EAN_2", "ITF", "PDF_417", "QR_CODE", "UPC_A", "UPC_E"
     };
     return value;
 }
@@ -154,18 +163,34 @@ const std::unordered_set<std::string>& zxingSupportedFormats()
 const std::unordered_set<std::string>& dbrSupportedFormats()
 {
     static const std::unordered_set<std::string> value = {
-        "AZTEC", "CODE_128", "GS1_128", "CODE_39", "DATA_MATRIX", "EAN_13",
-        "EAN_8", "EAN_2", "ITF", "IATA_2_OF_5", "USPS_INTELLIGENT_MAIL",
+        "AZTEC", "CODABAR", "CODE_128", "GS1_128", "CODE_39", "CODE_93", "DATA_MATRIX",
+        "EAN_13", "EAN_8", "EAN_2", "ITF", "IATA_2_OF_5", "USPS_INTELLIGENT_MAIL",
         "JAPAN_POST", "KIX", "PDF_417", "POSTNET", "QR_CODE", "ROYAL_MAIL",
         "UPC_A", "UPC_E"
     };
     return value;
 }
 
+std::string_view decoderFamily(std::string_view decoder)
+{
+    return decoder.substr(0, decoder.find(':'));
+}
+
 bool isFormatSupported(std::string_view decoder, std::string_view format)
 {
+    if (decoderFamily(decoder) == "race") {
+        // "race:a+b:label" supports whatever any of its members supports.
+        for (auto members = decoder.substr(std::min<std::size_t>(5, decoder.size())); !members.empty();) {
+            const auto plus = members.find('+');
+            if (isFormatSupported(members.substr(0, plus), format)) return true;
+            members = plus == std::string_view::npos ? std::string_view() : members.substr(plus + 1);
+        }
+        return false;
+    }
+    if (decoderFamily(decoder) == "cascade")
+        return decoder.size() > 8 && isFormatSupported(decoder.substr(8), format);
     const auto f = canonicalFormat(format);
-    return decoder == "zxing-cpp" ? zxingSupportedFormats().count(f) != 0
+    return decoderFamily(decoder) == "zxing-cpp" ? zxingSupportedFormats().count(f) != 0
                                   : dbrSupportedFormats().count(f) != 0;
 }
 
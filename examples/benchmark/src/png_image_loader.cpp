@@ -0,0 +1,47 @@
+#include "image_loader.h"
+
+#include <png.h>
+
+namespace bench {
+namespace {
+
+bool isPng(std::span<const std::uint8_t> bytes)
+{
+    return bytes.size()>8&&png_sig_cmp(bytes.data(),0,8)==0;
+}
+
+class PngImageLoader final : public IImageLoader {
+public:
+    explicit PngImageLoader(int scale) : scale_(scale), fallback_(createStbImageLoader(scale)) {}
+    std::string name() const override { return "libpng"; }
+    bool decode(std::span<const std::uint8_t> bytes, ImageBuffer& output, std::string& error) override
+    {
+        if(!isPng(bytes))return fallback_->decode(bytes,output,error);
+        png_image image{};
+        image.version=PNG_IMAGE_VERSION;
+        if(!png_image_begin_read_from_memory(&image,bytes.data(),bytes.size())){
+            error=std::string("libpng: ")+image.message;return false;
+        }
+        image.format=PNG_FORMAT_RGB;
+        output.width=static_cast<int>(image.width);output.height=static_cast<int>(image.height);
+        output.stride=static_cast<int>(PNG_IMAGE_ROW_STRIDE(image));
+        output.rgb.resize(PNG_IMAGE_SIZE(image));
+        if(!png_image_finish_read(&image,nullptr,output.rgb.data(),output.stride,nullptr)){
+            error=std::string("libpng: ")+image.message;png_image_free(&image);return false;
+        }
+        downscaleImage(output,scale_);
+        return true;
+    }
+private:
+    int scale_;
+    std::unique_ptr<IImageLoader> fallback_;
+};
+
+} // namespace
+
+std::unique_ptr<IImageLoader> createPngImageLoader(int scale_denominator)
+{
+    return std::make_unique<PngImageLoader>(scale_denominator);
+}
+
+} // namespace bench
@@ -0,0 +1,141 @@
+#include "racing_decoder.h"
+
+#include "resource_usage.h"
+#include "trace.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace bench {
+
+RacingDecoder::RacingDecoder(std::vector<std::unique_ptr<IDecoderAdapter>> members, bool cancel_losers)
+    : cancel_losers_(cancel_losers)
+{
+    if (members.size() < 2) throw std::runtime_error("a racing decoder needs at least two members");
+    name_ = "race:";
+    lanes_.resize(members.size());
+    for (std::size_t i = 0; i < members.size(); ++i) {
+        lanes_[i].name = members[i]->name();
+        if (lanes_[i].name.find_first_of("+|") != std::string::npos)
+            throw std::runtime_error("racing member names cannot contain '+' or '|': " + lanes_[i].name);
+        name_ += (i ? "+" : "") + lanes_[i].name;
+        version_ += (i ? "+" : "") + members[i]->version();
+        lanes_[i].decoder = std::move(members[i]);
+    }
+    // Threads start only once every lane is in place, so they never see the
+    // vector move.
+    for (std::size_t i = 0; i < lanes_.size(); ++i) lanes_[i].thread = std::thread([this, i] { runLane(i); });
+}
+
+RacingDecoder::~RacingDecoder()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    start_.notify_all();
+    for (auto& lane : lanes_) lane.thread.join();
+}
+
+void RacingDecoder::runLane(std::size_t index)
+{
+    auto& lane = lanes_[index];
+    nameTraceThread("race/" + lane.name);
+    std::uint64_t seen = 0;
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        start_.wait(lock, [&] { return stop_ || generation_ != seen; });
+        if (stop_) return;
+        seen = generation_;
+        const auto* image = image_;
+        lock.unlock();
+        DecodeRun run;
+        try {
+            TraceSpan span("race_decode", {}, lane.name);
+            run = lane.decoder->decode(*image);
+        } catch (const std::exception& e) {
+            run.error = e.what();
+        }
+        const auto finished = std::chrono::steady_clock::now();
+        lock.lock();
+        lane.run = std::move(run);
+        lane.finished = finished;
+        lane.busy = false;
+        if (!winner_ && !lane.run.results.empty() && !lane.run.error && !lane.run.timed_out) winner_ = index;
+        --pending_;
+        done_.notify_all();
+    }
+}
+
+DecodeRun RacingDecoder::decode(const ImageBuffer& image)
+{
+    const auto resources_begin = captureResources();
+    const auto begin = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lock(mutex_);
+    image_ = &image;
+    winner_.reset();
+    pending_ = lanes_.size();
+    for (auto& lane : lanes_) lane.busy = true;
+    ++generation_;
+    start_.notify_all();
+    done_.wait(lock, [&] { return winner_ || pending_ == 0; });
+    // Cancelling under the lock means a loser can only be interrupted while
+    // it is still on this image, never on the next one.
+    if (winner_ && cancel_losers_) {
+        for (auto& lane : lanes_) if (lane.busy) lane.decoder->cancel();
+    }
+    done_.wait(lock, [&] { return pending_ == 0; });
+    image_ = nullptr;
+
+    DecodeRun result;
+    std::chrono::nanoseconds thread_cpu{0};
+    auto last = begin;
+    for (const auto& lane : lanes_) {
+        thread_cpu += lane.run.thread_cpu_time;
+        last = std::max(last, lane.finished);
+    }
+    result.wall_time = std::chrono::duration_cast<std::chrono::nanoseconds>(last - begin);
+    if (winner_) {
+        const auto& lane = lanes_[*winner_];
+        result.results = lane.run.results;
+        result.decode_time = std::chrono::duration_cast<std::chrono::nanoseconds>(lane.finished - begin);
+        result.resolved_by = lane.name;
+    } else {
+        bool all_failed = true, all_timed_out = true;
+        for (const auto& lane : lanes_) {
+            all_failed = all_failed && lane.run.error.has_value();
+            all_timed_out = all_timed_out && lane.run.timed_out;
+        }
+        result.decode_time = std::chrono::duration_cast<std::chrono::nanoseconds>(last - begin);
+        result.resolved_by = "none";
+        result.timed_out = all_timed_out;
+        // One member failing while another finds nothing is a clean no-read;
+        // only a race where every member failed is an error.
+        if (all_failed) {
+            std::string error = "race: every member failed";
+            for (const auto& lane : lanes_) error += "; " + lane.name + ": " + *lane.run.error;
+            result.error = error;
+        }
+    }
+    lock.unlock();
+    recordResourceDelta(result, resources_begin, captureResources());
+    result.thread_cpu_time = thread_cpu;
+    return result;
+}
+
+bool RacingDecoder::setDeadline(std::chrono::milliseconds timeout)
+{
+    bool native = true;
+    for (auto& lane : lanes_) native = lane.decoder->setDeadline(timeout) && native;
+    return native;
+}
+
+bool RacingDecoder::cancel()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    bool cancelled = false;
+    for (auto& lane : lanes_) if (lane.busy) cancelled = lane.decoder->cancel() || cancelled;
+    return cancelled;
+}
+
+} // namespace bench
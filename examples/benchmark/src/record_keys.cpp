@@ -0,0 +1,162 @@
+#include "record_keys.h"
+
+#include "result_writer.h"
+
+#include <nlohmann/json.hpp>
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+
+namespace bench {
+namespace {
+
+std::uint64_t mix(std::uint64_t value)
+{
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+    return value ^ (value >> 31);
+}
+
+bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+// Position of the quote closing a string that starts at begin: memchr to the
+// next quote, accepted when preceded by an even run of backslashes.
+std::size_t closingQuote(std::string_view line, std::size_t begin)
+{
+    for (std::size_t from = begin; from < line.size();) {
+        const auto* quote = static_cast<const char*>(std::memchr(line.data() + from, '"', line.size() - from));
+        if (!quote) break;
+        const auto end = static_cast<std::size_t>(quote - line.data());
+        std::size_t slashes = 0;
+        while (end - slashes > begin && line[end - slashes - 1] == '\\') ++slashes;
+        if (slashes % 2 == 0) return end;
+        from = end + 1;
+    }
+    return std::string_view::npos;
+}
+
+std::string parseRecordKey(std::string_view line)
+{
+    const auto value = nlohmann::json::parse(line);
+    return recordKey(value.at("sample_id").get<std::string>(), value.at("decoder").get<std::string>(),
+                     value.at("repetition").get<int>());
+}
+
+} // namespace
+
+std::uint64_t keyHash(std::string_view key)
+{
+    std::uint64_t hash = 0x9e3779b97f4a7c15ull ^ key.size();
+    std::size_t i = 0;
+    for (; i + 8 <= key.size(); i += 8) {
+        std::uint64_t word;
+        std::memcpy(&word, key.data() + i, sizeof(word));
+        hash = mix(hash ^ word);
+    }
+    std::uint64_t tail = 0;
+    if (i < key.size()) std::memcpy(&tail, key.data() + i, key.size() - i);
+    hash = mix(hash ^ tail ^ 0xff51afd7ed558ccdull);
+    // Zero marks an empty slot.
+    return hash ? hash : 1;
+}
+
+std::size_t RecordKeySet::find(std::string_view key, std::uint64_t hash) const
+{
+    const std::size_t mask = slots_.size() - 1;
+    for (std::size_t i = hash & mask;; i = (i + 1) & mask) {
+        const auto& slot = slots_[i];
+        if (slot.hash == 0) return i;
+        if (slot.hash == hash && std::string_view(arena_).substr(slot.offset, slot.length) == key) return i;
+    }
+}
+
+void RecordKeySet::grow()
+{
+    std::vector<Slot> old = std::move(slots_);
+    slots_.assign(old.empty() ? 1024 : old.size() * 2, Slot{});
+    const std::size_t mask = slots_.size() - 1;
+    for (const auto& slot : old) {
+        if (slot.hash == 0) continue;
+        std::size_t i = slot.hash & mask;
+        while (slots_[i].hash != 0) i = (i + 1) & mask;
+        slots_[i] = slot;
+    }
+}
+
+bool RecordKeySet::insert(std::string_view key)
+{
+    // Keep the load factor at or below one half so probe runs stay short.
+    if ((size_ + 1) * 2 > slots_.size()) grow();
+    const auto hash = keyHash(key);
+    auto& slot = slots_[find(key, hash)];
+    if (slot.hash != 0) return false;
+    slot = {hash, arena_.size(), static_cast<std::uint32_t>(key.size())};
+    arena_.append(key);
+    ++size_;
+    return true;
+}
+
+bool RecordKeySet::contains(std::string_view key) const
+{
+    if (slots_.empty()) return false;
+    return slots_[find(key, keyHash(key))].hash != 0;
+}
+
+void RecordKeySet::clear()
+{
+    slots_.clear();
+    arena_.clear();
+    size_ = 0;
+}
+
+std::string scanRecordKey(std::string_view line)
+{
+    // Appends write whole lines, so a closing brace means the record is
+    // complete and the scan can stop as soon as the three fields are seen.
+    const auto last = line.find_last_not_of(" \t\r\n");
+    const bool closed = last != std::string_view::npos && line[last] == '}';
+    std::string_view sample_id, decoder, pending;
+    bool have_sample = false, have_decoder = false, have_repetition = false, expect_key = false;
+    int repetition = 0, depth = 0;
+    for (std::size_t i = 0; i < line.size(); ++i) {
+        if (closed && have_sample && have_decoder && have_repetition) return recordKey(sample_id, decoder, repetition);
+        const char c = line[i];
+        if (c == '"') {
+            const auto end = closingQuote(line, i + 1);
+            if (end == std::string_view::npos) break;
+            const auto text = line.substr(i + 1, end - i - 1);
+            i = end;
+            if (depth != 1) continue;
+            if (expect_key) { pending = text; expect_key = false; continue; }
+            if (pending == "sample_id" || pending == "decoder") {
+                if (text.find('\\') != std::string_view::npos) return parseRecordKey(line);
+                (pending == "sample_id" ? sample_id : decoder) = text;
+                (pending == "sample_id" ? have_sample : have_decoder) = true;
+            }
+            pending = {};
+            continue;
+        }
+        switch (c) {
+        case '{': ++depth; expect_key = depth == 1; pending = {}; break;
+        case '[': ++depth; pending = {}; break;
+        case '}': case ']': --depth; break;
+        case ',': if (depth == 1) expect_key = true; break;
+        case ':': break;
+        default:
+            if (depth != 1 || pending.empty() || isSpace(c)) break;
+            if (pending == "repetition") {
+                const auto result = std::from_chars(line.data() + i, line.data() + line.size(), repetition);
+                have_repetition = result.ec == std::errc{};
+            }
+            pending = {};
+        }
+    }
+    // A record that does not close is a torn write; leave the verdict to the parser.
+    if (depth != 0 || !have_sample || !have_decoder || !have_repetition) return parseRecordKey(line);
+    return recordKey(sample_id, decoder, repetition);
+}
+
+} // namespace bench
@@ -1,5 +1,6 @@
 #include "benchmark_types.h"
 #include "matcher.h"
+#include "metrics.h"
 #include "result_writer.h"
 
 #include <nlohmann/json.hpp>
@@ -60,15 +61,19 @@ int main(int argc, char** argv)
     try {
         std::string input_path;
         std::string output_dir;
+        bench::SummaryOptions summary_options;
         for (int i = 1; i < argc; ++i) {
             const std::string key = argv[i];
             if (i + 1 >= argc) throw std::runtime_error("missing value for " + key);
             if (key == "--results") input_path = argv[++i];
             else if (key == "--output") output_dir = argv[++i];
+            else if (key == "--megapixel-buckets") summary_options.megapixel_buckets = bench::parseBucketEdges(argv[++i]);
+            else if (key == "--ppe-buckets") summary_options.ppe_buckets = bench::parseBucketEdges(argv[++i]);
+            else if (key == "--bootstrap-resamples") summary_options.bootstrap_resamples = std::stoi(argv[++i]);
             else throw std::runtime_error("unexpected argument: " + key);
         }
         if (input_path.empty() || output_dir.empty())
-            throw std::runtime_error("usage: rematch_results --results FILE --output DIR");
+            throw std::runtime_error("usage: rematch_results --results FILE --output DIR [--megapixel-buckets LIST] [--ppe-buckets LIST] [--bootstrap-resamples N]");
 
         std::ifstream in(input_path, std::ios::binary);
         if (!in) throw std::runtime_error("cannot read results: " + input_path);
@@ -115,7 +120,7 @@ int main(int argc, char** argv)
             }
         }
         const auto summary = output / "summary.json";
-        bench::generateSummary(jsonl, summary);
+        bench::generateSummary(jsonl, summary, summary_options);
         bench::generateResultsJson(jsonl, summary, output / "results.json");
         std::cout << "wrote " << jsonl << ", " << summary << " and " << (output / "results.json") << '\n';
         return 0;
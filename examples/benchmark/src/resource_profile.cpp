@@ -0,0 +1,178 @@
+#include "resource_profile.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+namespace bench {
+namespace {
+
+#ifndef _WIN32
+// sysfs reports a rejected value from write(), which an ofstream would only
+// surface as a vague failbit, so control files are written directly.
+bool writeControl(const std::filesystem::path& path, const std::string& value, std::string& error)
+{
+    const int fd = ::open(path.c_str(), O_WRONLY | O_CLOEXEC);
+    if (fd < 0) { error = path.string() + ": " + std::strerror(errno); return false; }
+    const bool written = ::write(fd, value.data(), value.size()) == static_cast<ssize_t>(value.size());
+    if (!written) error = path.string() + ": " + std::strerror(errno);
+    ::close(fd);
+    return written;
+}
+#endif
+
+bool hasWord(const std::filesystem::path& path, const std::string& word)
+{
+    std::ifstream in(path);
+    for (std::string item; in >> item;) if (item == word) return true;
+    return false;
+}
+
+} // namespace
+
+ResourceProfile resourceProfile(std::string_view name)
+{
+    ResourceProfile profile;
+    profile.name = std::string(name);
+    if (name == "host") return profile;
+    if (name == "edge") {
+        profile.cpus = 2;
+        profile.cpu_quota = 2.0;
+        profile.memory_limit_bytes = std::size_t{1} << 30;
+        return profile;
+    }
+    throw std::runtime_error("unknown profile: " + std::string(name) + " (expected host or edge)");
+}
+
+std::vector<int> allowedCpus()
+{
+    std::vector<int> result;
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (::sched_getaffinity(0, sizeof set, &set) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) if (CPU_ISSET(cpu, &set)) result.push_back(cpu);
+        return result;
+    }
+#endif
+    for (unsigned cpu = 0; cpu < std::max(1u, std::thread::hardware_concurrency()); ++cpu) result.push_back(static_cast<int>(cpu));
+    return result;
+}
+
+void limitAddressSpace(std::size_t bytes)
+{
+#ifdef _WIN32
+    (void)bytes;
+    throw std::runtime_error("address-space limits are not supported on Windows");
+#else
+    std::size_t pages = 0;
+    std::ifstream("/proc/self/statm") >> pages;
+    const auto mapped = pages * static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    rlimit limit{};
+    ::getrlimit(RLIMIT_AS, &limit);
+    limit.rlim_cur = static_cast<rlim_t>(mapped + bytes);
+    if (limit.rlim_max != RLIM_INFINITY && limit.rlim_cur > limit.rlim_max) limit.rlim_cur = limit.rlim_max;
+    if (::setrlimit(RLIMIT_AS, &limit) != 0)
+        throw std::runtime_error(std::string("setrlimit(RLIMIT_AS) failed: ") + std::strerror(errno));
+#endif
+}
+
+std::unique_ptr<WorkerCgroup> WorkerCgroup::create(const ResourceProfile& profile, std::string& reason,
+                                                   const std::filesystem::path& cgroup_root, const std::filesystem::path& proc)
+{
+#ifndef __linux__
+    (void)profile; (void)cgroup_root; (void)proc;
+    reason = "cgroup v2 is only available on Linux";
+    return nullptr;
+#else
+    std::ifstream membership(proc / "self/cgroup");
+    std::string relative;
+    for (std::string line; std::getline(membership, line);)
+        if (line.rfind("0::", 0) == 0) relative = line.substr(3);
+    if (relative.empty()) { reason = "this process is not in a cgroup v2 hierarchy"; return nullptr; }
+    const auto parent = cgroup_root / std::filesystem::path(relative).relative_path();
+
+    std::vector<std::string> controllers;
+    if (profile.cpu_quota) controllers.push_back("cpu");
+    if (profile.memory_limit_bytes) controllers.push_back("memory");
+    for (const auto& controller : controllers) {
+        if (!hasWord(parent / "cgroup.controllers", controller)) {
+            reason = "the " + controller + " controller is not available in " + parent.string();
+            return nullptr;
+        }
+        if (hasWord(parent / "cgroup.subtree_control", controller)) continue;
+        std::string error;
+        if (!writeControl(parent / "cgroup.subtree_control", "+" + controller, error)) {
+            // A non-root cgroup that holds processes cannot delegate
+            // controllers, which is the usual case for a login shell.
+            reason = "cannot enable " + controller + " for child cgroups (" + error +
+                     "); run under a delegated scope such as systemd-run --user --scope -p Delegate=yes";
+            return nullptr;
+        }
+    }
+
+    const auto path = parent / ("barcode-benchmark-" + std::to_string(::getpid()));
+    std::error_code created;
+    std::filesystem::create_directory(path, created);
+    if (created) { reason = "cannot create " + path.string() + ": " + created.message(); return nullptr; }
+    std::unique_ptr<WorkerCgroup> group(new WorkerCgroup(path, profile.memory_limit_bytes != 0));
+    std::string error;
+    if (profile.cpu_quota) {
+        constexpr long period = 100000;
+        const auto quota = static_cast<long>(std::lround(*profile.cpu_quota * period));
+        if (!writeControl(path / "cpu.max", std::to_string(quota) + " " + std::to_string(period), error)) {
+            reason = error; return nullptr;
+        }
+    }
+    if (profile.memory_limit_bytes) {
+        if (!writeControl(path / "memory.max", std::to_string(profile.memory_limit_bytes), error)) {
+            reason = error; return nullptr;
+        }
+        // Without this the kernel swaps instead of failing, which a device
+        // without swap would not do. Kernels without swap accounting lack it.
+        writeControl(path / "memory.swap.max", "0", error);
+    }
+    return group;
+#endif
+}
+
+WorkerCgroup::~WorkerCgroup()
+{
+    // Only succeeds once every worker has exited; a leftover empty group is
+    // harmless and named after the pid.
+    std::error_code ignored;
+    std::filesystem::remove(path_, ignored);
+}
+
+void WorkerCgroup::join() const
+{
+#ifndef _WIN32
+    std::string error;
+    if (!writeControl(path_ / "cgroup.procs", "0", error)) throw std::runtime_error("cannot join worker cgroup: " + error);
+#endif
+}
+
+std::uint64_t WorkerCgroup::oomKills() const
+{
+    std::ifstream events(path_ / "memory.events");
+    std::string key;
+    std::uint64_t value = 0;
+    while (events >> key >> value) if (key == "oom_kill") return value;
+    return 0;
+}
+
+} // namespace bench
@@ -0,0 +1,63 @@
+#include "resource_usage.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#include <time.h>
+#endif
+
+namespace bench {
+namespace {
+
+#ifdef _WIN32
+std::int64_t fileTimeNs(const FILETIME& kernel, const FILETIME& user)
+{
+    const auto ticks=(static_cast<std::uint64_t>(kernel.dwHighDateTime)<<32|kernel.dwLowDateTime)+
+                     (static_cast<std::uint64_t>(user.dwHighDateTime)<<32|user.dwLowDateTime);
+    return static_cast<std::int64_t>(ticks*100);
+}
+#else
+std::int64_t clockNs(clockid_t clock)
+{
+    timespec value{};
+    if(clock_gettime(clock,&value)!=0)return 0;
+    return static_cast<std::int64_t>(value.tv_sec)*1000000000LL+value.tv_nsec;
+}
+#endif
+
+} // namespace
+
+ResourceSnapshot captureResources()
+{
+    ResourceSnapshot snapshot;
+#ifdef _WIN32
+    // Windows exposes no per-process context switch counters through a cheap
+    // call, so only the CPU clocks are sampled there.
+    FILETIME created, exited, kernel, user;
+    if(GetThreadTimes(GetCurrentThread(),&created,&exited,&kernel,&user))snapshot.thread_cpu_ns=fileTimeNs(kernel,user);
+    if(GetProcessTimes(GetCurrentProcess(),&created,&exited,&kernel,&user))snapshot.process_cpu_ns=fileTimeNs(kernel,user);
+#else
+    snapshot.thread_cpu_ns=clockNs(CLOCK_THREAD_CPUTIME_ID);
+    snapshot.process_cpu_ns=clockNs(CLOCK_PROCESS_CPUTIME_ID);
+    rusage usage{};
+    if(getrusage(RUSAGE_SELF,&usage)==0){
+        snapshot.voluntary_context_switches=usage.ru_nvcsw;
+        snapshot.involuntary_context_switches=usage.ru_nivcsw;
+    }
+#endif
+    return snapshot;
+}
+
+void recordResourceDelta(DecodeRun& run, const ResourceSnapshot& begin, const ResourceSnapshot& end)
+{
+    run.thread_cpu_time=std::chrono::nanoseconds(end.thread_cpu_ns-begin.thread_cpu_ns);
+    run.process_cpu_time=std::chrono::nanoseconds(end.process_cpu_ns-begin.process_cpu_ns);
+    run.voluntary_context_switches=end.voluntary_context_switches-begin.voluntary_context_switches;
+    run.involuntary_context_switches=end.involuntary_context_switches-begin.involuntary_context_switches;
+}
+
+} // namespace bench
@@ -1,12 +1,18 @@
 #include "result_writer.h"
+#include "json_writer.h"
 #include "metrics.h"
 #include "normalization.h"
 
 #include <nlohmann/json.hpp>
 #include <algorithm>
+#include <cctype>
 #include <fstream>
+#include <cmath>
+#include <cstdint>
 #include <iomanip>
+#include <limits>
 #include <map>
+#include <set>
 #include <sstream>
 #include <stdexcept>
 #include <thread>
@@ -16,24 +22,58 @@ namespace bench {
 using json = nlohmann::json;
 namespace {
 
-std::string hex(const std::vector<std::uint8_t>& bytes)
+void writeGroundTruth(JsonWriter& out, const GroundTruth& gt)
 {
-    static constexpr char digits[] = "0123456789abcdef";
-    std::string output(bytes.size() * 2, '0');
-    for (std::size_t i = 0; i < bytes.size(); ++i) {
-        output[i * 2] = digits[bytes[i] >> 4];
-        output[i * 2 + 1] = digits[bytes[i] & 0x0f];
-    }
-    return output;
+    out.beginObject().field("annotation_id",gt.annotation_id).field("format",gt.format).field("text",gt.text)
+       .field("ppe",gt.ppe).key("polygon").beginArray();
+    for (const auto& p : gt.polygon) out.beginArray().value(p.x).value(p.y).endArray();
+    out.endArray().field("decode_eligible",gt.decode_eligible).field("exclusion_reason",gt.exclusion_reason).endObject();
 }
 
-json groundTruth(const GroundTruth& gt)
+void writeRecord(std::string& buffer, const RawResultRecord& record)
 {
-    json polygon = json::array();
-    for (const auto& p : gt.polygon) polygon.push_back({p.x, p.y});
-    return {{"annotation_id",gt.annotation_id},{"format",gt.format},{"text",gt.text},
-            {"ppe",gt.ppe ? json(*gt.ppe) : json(nullptr)},{"polygon",polygon},
-            {"decode_eligible",gt.decode_eligible},{"exclusion_reason",gt.exclusion_reason}};
+    JsonWriter out(buffer);
+    out.beginObject()
+       .field("protocol",record.protocol).field("manifest_sha256",record.manifest_sha256)
+       .field("sample_id",record.sample.sample_id).field("relative_path",record.sample.relative_path)
+       .field("annotation_file",record.sample.annotation_file).field("image_sha256",record.sample.image_sha256)
+       .field("width",record.sample.width).field("height",record.sample.height)
+       .key("ground_truth").beginArray();
+    for (const auto& gt : record.sample.ground_truth) writeGroundTruth(out,gt);
+    out.endArray();
+    if (!record.sample.stratum.empty()) out.field("stratum",record.sample.stratum).field("weight",record.sample.weight);
+    out
+       .field("decoder",record.decoder).field("decoder_version",record.decoder_version)
+       .field("config_sha256",record.config_sha256).field("environment_sha256",record.environment_sha256)
+       .field("repetition",record.repetition)
+       .field("image_loader",record.image_loader).field("image_scale",record.image_scale)
+       .field("image_load_ns",record.image_load_ns).field("decode_ns",record.run.decode_time.count())
+       .field("cache_state",record.cache_state).field("cold_decode_ns",record.cold_decode_ns).field("profile",record.profile)
+       .field("numa_node",record.numa_node)
+       .field("thread_cpu_ns",record.run.thread_cpu_time.count()).field("process_cpu_ns",record.run.process_cpu_time.count())
+       .field("voluntary_context_switches",record.run.voluntary_context_switches)
+       .field("involuntary_context_switches",record.run.involuntary_context_switches)
+       .field("error",record.run.error).field("timed_out",record.run.timed_out);
+    if (!record.run.resolved_by.empty()) out.field("resolved_by",record.run.resolved_by);
+    if (record.run.wall_time.count()) out.field("wall_ns",record.run.wall_time.count());
+    out.key("predictions").beginArray();
+    for (const auto& prediction : record.run.results) {
+        out.beginObject().field("format",prediction.canonical_format).field("text",prediction.text)
+           .key("raw_bytes_hex").hexValue(prediction.raw_bytes)
+           .field("confidence",prediction.confidence);
+        if (!prediction.position.empty()) {
+            out.key("position").beginArray();
+            for (const auto& p : prediction.position) out.beginArray().value(p.x).value(p.y).endArray();
+            out.endArray();
+        }
+        out.endObject();
+    }
+    out.endArray().key("matches").beginArray();
+    for (const auto& match : record.matches) {
+        out.beginObject().field("truth_index",match.truth_index).field("prediction_index",match.prediction_index)
+           .field("outcome",toString(match.outcome)).endObject();
+    }
+    out.endArray().endObject();
 }
 
 } // namespace
@@ -43,15 +83,14 @@ std::string recordKey(std::string_view sample_id, std::string_view decoder, int
     return std::string(sample_id) + "|" + std::string(decoder) + "|" + std::to_string(repetition);
 }
 
-std::set<std::string> completedKeys(const std::filesystem::path& jsonl)
+RecordKeySet completedKeys(const std::filesystem::path& jsonl)
 {
-    std::set<std::string> keys;
+    RecordKeySet keys;
     std::ifstream in(jsonl, std::ios::binary);
     std::string line;
     while (std::getline(in, line)) {
         if (line.empty()) continue;
-        auto value = json::parse(line);
-        keys.insert(recordKey(value.at("sample_id").get<std::string>(), value.at("decoder").get<std::string>(), value.at("repetition").get<int>()));
+        keys.insert(scanRecordKey(line));
     }
     return keys;
 }
@@ -77,7 +116,7 @@ void appendResult(const std::filesystem::path& jsonl, const RawResultRecord& rec
     const auto key = recordKey(record.sample.sample_id,record.decoder,record.repetition);
     struct ResultCache {
         std::uintmax_t consumed_bytes = 0;
-        std::set<std::string> keys;
+        RecordKeySet keys;
     };
     static std::map<std::string,ResultCache> caches;
     auto& cache=caches[std::filesystem::absolute(jsonl).string()];
@@ -90,39 +129,16 @@ void appendResult(const std::filesystem::path& jsonl, const RawResultRecord& rec
         std::string line;
         while(std::getline(tail,line)){
             if(line.empty())continue;
-            const auto value=json::parse(line);
-            cache.keys.insert(recordKey(value.at("sample_id").get<std::string>(),
-                                        value.at("decoder").get<std::string>(),
-                                        value.at("repetition").get<int>()));
+            cache.keys.insert(scanRecordKey(line));
         }
         cache.consumed_bytes=current_size;
     }
     if(cache.keys.count(key))return;
 
-    json truth = json::array();
-    for (const auto& gt : record.sample.ground_truth) truth.push_back(groundTruth(gt));
-    json predictions = json::array();
-    for (const auto& prediction : record.run.results) {
-        predictions.push_back({{"format", prediction.canonical_format}, {"text", prediction.text},
-            {"raw_bytes_hex", hex(prediction.raw_bytes)},
-            {"confidence", prediction.confidence ? json(*prediction.confidence) : json(nullptr)}});
-    }
-    json matches = json::array();
-    for (const auto& match : record.matches) matches.push_back({
-        {"truth_index", match.truth_index ? json(*match.truth_index) : json(nullptr)},
-        {"prediction_index", match.prediction_index ? json(*match.prediction_index) : json(nullptr)},
-        {"outcome", toString(match.outcome)}});
-    json value = {
-        {"protocol",record.protocol},{"manifest_sha256",record.manifest_sha256},
-        {"sample_id",record.sample.sample_id},{"relative_path",record.sample.relative_path},
-        {"annotation_file",record.sample.annotation_file},{"image_sha256",record.sample.image_sha256},
-        {"width",record.sample.width},{"height",record.sample.height},{"ground_truth",truth},
-        {"decoder",record.decoder},{"decoder_version",record.decoder_version},
-        {"config_sha256",record.config_sha256},{"repetition",record.repetition},
-        {"image_load_ns",record.image_load_ns},{"decode_ns",record.run.decode_time.count()},
-        {"error",record.run.error ? json(*record.run.error) : json(nullptr)},
-        {"predictions",predictions},{"matches",matches}
-    };
+    thread_local std::string buffer;
+    buffer.clear();
+    writeRecord(buffer,record);
+    buffer.push_back('\n');
     std::ofstream out;
     for(int attempt=0;attempt<100&&!out.is_open();++attempt){
         out.clear();
@@ -130,23 +146,116 @@ void appendResult(const std::filesystem::path& jsonl, const RawResultRecord& rec
         if(!out.is_open())std::this_thread::sleep_for(std::chrono::milliseconds(10));
     }
     if (!out.is_open()) throw std::runtime_error("cannot append result: " + jsonl.string());
-    out << value.dump() << '\n';
+    out.write(buffer.data(),static_cast<std::streamsize>(buffer.size()));
     out.close();
     cache.keys.insert(key);
     cache.consumed_bytes=std::filesystem::file_size(jsonl);
 }
 
-void generateSummary(const std::filesystem::path& jsonl, const std::filesystem::path& output)
+namespace {
+
+struct BucketStats {
+    std::size_t records=0, eligible=0, correct=0;
+    double megapixels=0;
+    LatencyHistogram latency;
+};
+
+// Quantile of a sorted nanosecond sample in milliseconds, taking the element
+// at floor(q * (n - 1)); 0 for an empty sample.
+double percentileMs(std::span<const std::int64_t> sorted, double q)
+{
+    if (sorted.empty()) return 0.0;
+    return static_cast<double>(sorted[static_cast<std::size_t>(q*static_cast<double>(sorted.size()-1))])/1e6;
+}
+
+// Adds a "<key>_ci95" bootstrap interval in milliseconds next to the mean and
+// each quantile computed from the same sorted nanosecond sample.
+void addLatencyIntervals(json& target, std::span<const std::int64_t> sorted, const std::string& mean_key,
+                         const std::vector<std::pair<std::string,double>>& quantile_keys, int resamples)
+{
+    if (resamples <= 0) return;
+    std::vector<double> quantiles;
+    for (const auto& item : quantile_keys) quantiles.push_back(item.second);
+    const auto intervals = bootstrapLatency(sorted, quantiles, resamples);
+    auto milliseconds = [](const std::pair<double,double>& ns) { return json::array({ns.first/1e6, ns.second/1e6}); };
+    target[mean_key+"_ci95"] = milliseconds(intervals.mean);
+    for (std::size_t i = 0; i < quantile_keys.size(); ++i)
+        target[quantile_keys[i].first+"_ci95"] = milliseconds(intervals.quantiles[i]);
+}
+
+json bucketsJson(const std::map<std::size_t,BucketStats>& buckets, const std::vector<double>& edges, int resamples)
+{
+    json result = json::object();
+    for (const auto& [index,b] : buckets) {
+        const auto interval=wilsonInterval(b.correct,b.eligible);
+        const double total_ms=double(b.latency.total())/1e6;
+        auto& entry = result[index==SIZE_MAX?std::string("unknown"):bucketLabel(edges,index)] = {
+            {"records",b.records},{"eligible_instances",b.eligible},{"correct",b.correct},
+            {"recall",b.eligible?double(b.correct)/b.eligible:0.0},{"recall_ci95",{interval.first,interval.second}},
+            {"mean_decode_ms",b.latency.mean()/1e6},
+            {"median_decode_ms",double(b.latency.quantile(0.5))/1e6},
+            {"p95_decode_ms",double(b.latency.quantile(0.95))/1e6},
+            {"p99_decode_ms",double(b.latency.quantile(0.99))/1e6},
+            {"megapixels",b.megapixels},{"ms_per_megapixel",b.megapixels>0?total_ms/b.megapixels:0.0}
+        };
+        // Resampled from the histogram midpoints the quantiles are read from.
+        addLatencyIntervals(entry, b.latency.values(), "mean_decode_ms",
+                            {{"median_decode_ms",0.5},{"p95_decode_ms",0.95},{"p99_decode_ms",0.99}}, resamples);
+    }
+    return result;
+}
+
+} // namespace
+
+void generateSummary(const std::filesystem::path& jsonl, const std::filesystem::path& output,
+                     const SummaryOptions& options)
 {
     struct Counts {
         std::size_t records=0, eligible=0, correct=0, unsupported=0, errors=0;
         std::size_t common_eligible=0, common_correct=0, image_all_read=0;
-        std::int64_t decode_ns=0;
+        std::int64_t decode_ns=0, thread_cpu_ns=0, process_cpu_ns=0;
+        std::int64_t voluntary_switches=0, involuntary_switches=0;
+        std::size_t timeouts=0;
+        std::vector<std::pair<std::int64_t,std::size_t>> correct_by_time;
+        // Latency is per image. PPE latency buckets use the image's smallest
+        // PPE (its hardest symbol); PPE recall is counted per instance.
+        std::map<std::size_t,BucketStats> by_megapixels,by_ppe;
         std::map<std::string,std::size_t> outcomes;
         std::map<std::string,std::map<std::string,std::size_t>> by_format,by_source;
         std::vector<std::int64_t> timings;
+        // Evicted-cache decodes from --cache-state both, with the sums of
+        // the cold and warm times of the same records.
+        std::vector<std::int64_t> cold_timings;
+        std::int64_t paired_cold_ns=0, paired_warm_ns=0;
+        std::set<std::string> cache_states,profiles;
+        // Decode times per NUMA node from --numa-node.
+        std::map<int,std::vector<std::int64_t>> by_numa_node;
+        // Why decodes failed: memory limit, worker crash, or anything else.
+        // Timeouts are counted above.
+        std::size_t oom=0, crashes=0, other_errors=0;
+        // Racing and cascade decoders: which member or level answered, per
+        // image and per ground truth format of the instances in that image.
+        std::map<std::string,std::size_t> resolved_by;
+        std::map<std::string,std::map<std::string,std::size_t>> resolved_by_format;
+        // Racing decoders: wall time until every member had stopped.
+        std::int64_t wall_ns=0;
+        std::size_t wall_records=0;
+        // Records from a `subset` manifest, folded per image across
+        // repetitions, for the full-manifest estimates.
+        struct WeightedSample { std::string stratum; double weight=1, decode_ns=0, correct=0, eligible=0; int records=0; };
+        std::map<std::string,WeightedSample> weighted;
     };
     std::map<std::string, Counts> totals;
+    // Each image is loaded once and shared by every decoder, so load timings
+    // are counted once per sample and repetition rather than once per record.
+    struct LoadTimings {
+        RecordKeySet seen;
+        std::vector<std::int64_t> timings;
+    };
+    std::map<std::string, LoadTimings> loads;
+    // A resumed run may span machines or settings; every distinct
+    // environment hash is listed so that stays visible.
+    std::set<std::string> environments;
     std::ifstream in(jsonl, std::ios::binary);
     if (!in) throw std::runtime_error("cannot read results: " + jsonl.string());
     std::string line;
@@ -154,15 +263,54 @@ void generateSummary(const std::filesystem::path& jsonl, const std::filesystem::
         if (line.empty()) continue;
         const auto value = json::parse(line);
         auto& c = totals[value.at("decoder").get<std::string>()];
+        if (value.contains("environment_sha256") && value["environment_sha256"].is_string())
+            environments.insert(value["environment_sha256"].get<std::string>());
+        const auto scale=value.value("image_scale",1);
+        auto& load=loads[value.value("image_loader","stb")+(scale>1?"@1/"+std::to_string(scale):"")];
+        if(load.seen.insert(value.value("sample_id","")+"|"+std::to_string(value.value("repetition",0))))
+            load.timings.push_back(value.value("image_load_ns",0LL));
         ++c.records; c.decode_ns += value.value("decode_ns", 0LL);
         c.timings.push_back(value.value("decode_ns",0LL));
+        c.cache_states.insert(value.value("cache_state","warm"));
+        if(value.contains("cold_decode_ns")&&value["cold_decode_ns"].is_number()){
+            const auto cold=value["cold_decode_ns"].get<std::int64_t>();
+            c.cold_timings.push_back(cold);
+            c.paired_cold_ns+=cold; c.paired_warm_ns+=value.value("decode_ns",0LL);
+        }
+        c.thread_cpu_ns+=value.value("thread_cpu_ns",0LL); c.process_cpu_ns+=value.value("process_cpu_ns",0LL);
+        c.voluntary_switches+=value.value("voluntary_context_switches",0LL);
+        c.involuntary_switches+=value.value("involuntary_context_switches",0LL);
+        c.profiles.insert(value.value("profile","host"));
+        if(value.contains("numa_node")&&value["numa_node"].is_number())
+            c.by_numa_node[value["numa_node"].get<int>()].push_back(value.value("decode_ns",0LL));
         if (!value["error"].is_null()) ++c.errors;
+        if (value.value("timed_out",false)) ++c.timeouts;
+        else if (value["error"].is_string()) {
+            const auto error=value["error"].get<std::string>();
+            if (error.rfind("decoder_oom:",0)==0) ++c.oom;
+            else if (error.rfind("decoder_crash:",0)==0) ++c.crashes;
+            else ++c.other_errors;
+        }
         bool all_read=value["error"].is_null();
+        const std::string resolved_by=value.value("resolved_by","");
+        if(!resolved_by.empty())++c.resolved_by[resolved_by];
+        if(value.contains("wall_ns")){c.wall_ns+=value["wall_ns"].get<std::int64_t>();++c.wall_records;}
+        std::size_t record_correct=0;
+        const auto& truth=value["ground_truth"];
+        const double megapixels=double(value.value("width",0))*value.value("height",0)/(double(scale)*scale)/1e6;
+        double min_ppe=std::numeric_limits<double>::infinity();
+        for (const auto& gt : truth) if (gt.contains("ppe") && gt["ppe"].is_number()) min_ppe=std::min(min_ppe,gt["ppe"].get<double>());
+        auto& mp_bucket=c.by_megapixels[bucketIndex(options.megapixel_buckets,megapixels)];
+        auto& ppe_bucket=c.by_ppe[std::isinf(min_ppe)?SIZE_MAX:bucketIndex(options.ppe_buckets,min_ppe)];
+        for (auto* bucket : {&mp_bucket,&ppe_bucket}) {
+            ++bucket->records; bucket->megapixels+=megapixels;
+            bucket->latency.add(value.value("decode_ns",0LL));
+        }
         for (const auto& match : value.at("matches")) {
             const auto outcome = match.at("outcome").get<std::string>();
             ++c.outcomes[outcome];
             if (outcome != "extra_result") ++c.eligible;
-            if (outcome == "correct") ++c.correct;
+            if (outcome == "correct") { ++c.correct; ++record_correct; }
             if (outcome == "unsupported_format") ++c.unsupported;
             if(outcome!="correct"&&outcome!="extra_result")all_read=false;
             if(!match["truth_index"].is_null()){
@@ -170,6 +318,12 @@ void generateSummary(const std::filesystem::path& jsonl, const std::filesystem::
                 const auto format=value["ground_truth"][truth_index].value("format","");
                 ++c.by_format[format][outcome];
                 ++c.by_source[value.value("annotation_file","")][outcome];
+                if(!resolved_by.empty())++c.resolved_by_format[format][resolved_by];
+                const auto& gt=truth[truth_index];
+                auto& instance_bucket=c.by_ppe[gt.contains("ppe")&&gt["ppe"].is_number()
+                    ?bucketIndex(options.ppe_buckets,gt["ppe"].get<double>()):SIZE_MAX];
+                ++mp_bucket.eligible; ++instance_bucket.eligible;
+                if(outcome=="correct"){++mp_bucket.correct;++instance_bucket.correct;}
                 if(isFormatSupported("zxing-cpp",format)&&isFormatSupported("dynamsoft-dbr",format)){
                     ++c.common_eligible;
                     if(outcome=="correct")++c.common_correct;
@@ -177,6 +331,17 @@ void generateSummary(const std::filesystem::path& jsonl, const std::filesystem::
             }
         }
         if(all_read)++c.image_all_read;
+        if(value.contains("stratum")&&value["stratum"].is_string()){
+            auto& w=c.weighted[value.value("sample_id","")];
+            w.stratum=value["stratum"].get<std::string>(); w.weight=value.value("weight",1.0);
+            w.decode_ns+=double(value.value("decode_ns",0LL)); ++w.records;
+            for (const auto& match : value.at("matches")) {
+                const auto outcome=match.at("outcome").get<std::string>();
+                if(outcome!="extra_result")++w.eligible;
+                if(outcome=="correct")++w.correct;
+            }
+        }
+        c.correct_by_time.emplace_back(value.value("decode_ns",0LL),record_correct);
     }
     json decoders = json::object();
     for (const auto& [name,c] : totals) {
@@ -187,15 +352,18 @@ void generateSummary(const std::filesystem::path& jsonl, const std::filesystem::
         const auto false_predictions=outcomeCount("wrong_text")+outcomeCount("wrong_format")+outcomeCount("extra_result");
         const double precision=c.correct+false_predictions?double(c.correct)/(c.correct+false_predictions):0.0;
         const double recall=c.eligible?double(c.correct)/c.eligible:0.0;
-        auto percentile=[&](double q){
-            if(c.timings.empty())return 0.0;
-            auto values=c.timings;std::sort(values.begin(),values.end());
-            const auto index=static_cast<std::size_t>(q*static_cast<double>(values.size()-1));
-            return static_cast<double>(values[index])/1e6;
-        };
+        auto sorted=c.timings;std::sort(sorted.begin(),sorted.end());
+        // Recall achieved if every decode were cut off at a fixed time budget.
+        json recall_within = json::object();
+        for (const int budget_ms : {10, 25, 50, 100, 250, 500, 1000}) {
+            std::size_t within=0;
+            for (const auto& [ns,correct] : c.correct_by_time) if (ns <= budget_ms*1000000LL) within+=correct;
+            recall_within[std::to_string(budget_ms)] = c.eligible ? double(within)/c.eligible : 0.0;
+        }
         decoders[name] = {
             {"records",c.records},{"eligible_instances",c.eligible},{"correct",c.correct},
-            {"unsupported",c.unsupported},{"errors",c.errors},{"outcomes",c.outcomes},
+            {"unsupported",c.unsupported},{"errors",c.errors},{"timeouts",c.timeouts},
+            {"recall_within_budget_ms",recall_within},{"outcomes",c.outcomes},
             {"coverage_adjusted_recall",c.eligible ? double(c.correct)/c.eligible : 0.0},
             {"coverage_adjusted_recall_ci95",{interval.first,interval.second}},
             {"common_format_eligible",c.common_eligible},{"common_format_correct",c.common_correct},
@@ -205,18 +373,136 @@ void generateSummary(const std::filesystem::path& jsonl, const std::filesystem::
             {"precision",precision},{"f1",precision+recall?2.0*precision*recall/(precision+recall):0.0},
             {"image_all_read_rate",c.records?double(c.image_all_read)/c.records:0.0},
             {"by_format",c.by_format},{"by_source",c.by_source},
+            {"by_megapixels",bucketsJson(c.by_megapixels,options.megapixel_buckets,options.bootstrap_resamples)},
+            {"by_ppe",bucketsJson(c.by_ppe,options.ppe_buckets,options.bootstrap_resamples)},
             {"mean_decode_ms",c.records ? double(c.decode_ns)/c.records/1e6 : 0.0},
-            {"median_decode_ms",percentile(0.5)},{"p90_decode_ms",percentile(0.90)},
-            {"p95_decode_ms",percentile(0.95)},{"p99_decode_ms",percentile(0.99)},
-            {"total_decode_ms",double(c.decode_ns)/1e6}
+            {"median_decode_ms",percentileMs(sorted,0.5)},{"p90_decode_ms",percentileMs(sorted,0.90)},
+            {"p95_decode_ms",percentileMs(sorted,0.95)},{"p99_decode_ms",percentileMs(sorted,0.99)},
+            {"total_decode_ms",double(c.decode_ns)/1e6},
+            {"mean_thread_cpu_ms",c.records ? double(c.thread_cpu_ns)/c.records/1e6 : 0.0},
+            {"mean_process_cpu_ms",c.records ? double(c.process_cpu_ns)/c.records/1e6 : 0.0},
+            {"cpu_seconds_per_image",c.records ? double(c.process_cpu_ns)/c.records/1e9 : 0.0},
+            {"cpu_to_wall_ratio",c.decode_ns ? double(c.process_cpu_ns)/c.decode_ns : 0.0},
+            {"mean_voluntary_context_switches",c.records ? double(c.voluntary_switches)/c.records : 0.0},
+            {"mean_involuntary_context_switches",c.records ? double(c.involuntary_switches)/c.records : 0.0}
         };
+        addLatencyIntervals(decoders[name], sorted, "mean_decode_ms",
+                            {{"median_decode_ms",0.5},{"p90_decode_ms",0.90},{"p95_decode_ms",0.95},{"p99_decode_ms",0.99}},
+                            options.bootstrap_resamples);
+        decoders[name]["cache_states"]=c.cache_states;
+        decoders[name]["profiles"]=c.profiles;
+        if(!c.by_numa_node.empty()){
+            json nodes=json::object();
+            for(auto [node,timings]:c.by_numa_node){
+                std::sort(timings.begin(),timings.end());
+                std::int64_t total=0;
+                for(const auto ns:timings)total+=ns;
+                nodes[std::to_string(node)]={
+                    {"records",timings.size()},{"mean_decode_ms",double(total)/timings.size()/1e6},
+                    {"median_decode_ms",percentileMs(timings,0.5)},{"p95_decode_ms",percentileMs(timings,0.95)}};
+            }
+            decoders[name]["by_numa_node"]=nodes;
+        }
+        decoders[name]["failure_modes"]={{"oom",c.oom},{"timeout",c.timeouts},{"crash",c.crashes},{"other",c.other_errors}};
+        if(!c.cold_timings.empty()){
+            auto cold=c.cold_timings;std::sort(cold.begin(),cold.end());
+            json entry={
+                {"records",cold.size()},
+                {"mean_decode_ms",double(c.paired_cold_ns)/cold.size()/1e6},
+                {"median_decode_ms",percentileMs(cold,0.5)},{"p95_decode_ms",percentileMs(cold,0.95)},
+                {"warm_mean_decode_ms",double(c.paired_warm_ns)/cold.size()/1e6},
+                {"cold_to_warm_ratio",c.paired_warm_ns?double(c.paired_cold_ns)/c.paired_warm_ns:0.0}
+            };
+            addLatencyIntervals(entry, cold, "mean_decode_ms", {{"median_decode_ms",0.5},{"p95_decode_ms",0.95}},
+                                options.bootstrap_resamples);
+            decoders[name]["cold_cache"]=entry;
+        }
+        if(!c.weighted.empty()){
+            std::vector<StratifiedUnit> latency,recall_units;
+            for(const auto& [sample,w]:c.weighted){
+                latency.push_back({w.stratum,w.weight,w.decode_ns/w.records/1e6,1});
+                recall_units.push_back({w.stratum,w.weight,w.correct/w.records,w.eligible/w.records});
+            }
+            const auto mean=stratifiedRatio(latency);
+            const auto recall_estimate=stratifiedRatio(recall_units);
+            constexpr double z=1.959963984540054;
+            decoders[name]["subset_estimate"]={
+                {"images",mean.samples},{"strata",mean.strata},{"population_images",mean.population},
+                {"mean_decode_ms",mean.value},{"mean_decode_ms_se",mean.standard_error},
+                {"mean_decode_ms_ci95",{std::max(0.0,mean.value-z*mean.standard_error),mean.value+z*mean.standard_error}},
+                {"recall",recall_estimate.value},{"recall_se",recall_estimate.standard_error},
+                {"recall_ci95",{std::max(0.0,recall_estimate.value-z*recall_estimate.standard_error),
+                                std::min(1.0,recall_estimate.value+z*recall_estimate.standard_error)}}
+            };
+        }
+    }
+    // A race is compared with each of its members, and a cascade with its
+    // inner decoder, when they ran standalone in the same results stream.
+    for (const auto& [name,c] : totals) {
+        if (c.resolved_by.empty()) continue;
+        json hit_rate=json::object();
+        for (const auto& [by,count] : c.resolved_by) hit_rate[by]=c.records?double(count)/c.records:0.0;
+        decoders[name]["selection"]={{"by_image",c.resolved_by},{"by_format",c.resolved_by_format},{"hit_rate",hit_rate}};
+        if (c.wall_records) decoders[name]["mean_wall_ms"]=double(c.wall_ns)/c.wall_records/1e6;
+        const std::string family(decoderFamily(name));
+        std::vector<std::string> members;
+        if (family=="race") {
+            for (std::string_view rest=std::string_view(name).substr(5); !rest.empty();) {
+                const auto plus=rest.find('+');
+                members.emplace_back(rest.substr(0,plus));
+                rest=plus==std::string_view::npos?std::string_view():rest.substr(plus+1);
+            }
+        } else if (family=="cascade") {
+            members.push_back(name.substr(8));
+        } else {
+            continue;
+        }
+        json versus=json::object();
+        const auto& composite=decoders[name];
+        for (const auto& member : members) {
+            if (!decoders.contains(member)) continue;
+            const auto& standalone=decoders[member];
+            const double member_ms=standalone["mean_decode_ms"], composite_ms=composite["mean_decode_ms"];
+            versus[member]={
+                {"mean_decode_ms",member_ms},{family+"_mean_decode_ms",composite_ms},
+                {"speedup",composite_ms>0?member_ms/composite_ms:0.0},
+                {"median_decode_ms",standalone["median_decode_ms"]},{family+"_median_decode_ms",composite["median_decode_ms"]},
+                {"recall",standalone["coverage_adjusted_recall"]},{family+"_recall",composite["coverage_adjusted_recall"]},
+                {"recall_delta",composite["coverage_adjusted_recall"].get<double>()-standalone["coverage_adjusted_recall"].get<double>()}
+            };
+            if (composite.contains("mean_wall_ms")) {
+                const double wall_ms=composite["mean_wall_ms"];
+                versus[member][family+"_mean_wall_ms"]=wall_ms;
+                versus[member]["wall_speedup"]=wall_ms>0?member_ms/wall_ms:0.0;
+            }
+        }
+        decoders[name]["versus"]=versus;
+    }
+    json image_load = json::object();
+    for (auto& [name,load] : loads) {
+        auto& values=load.timings;
+        std::sort(values.begin(),values.end());
+        std::int64_t total=0;
+        for(const auto value:values)total+=value;
+        image_load[name]={
+            {"images",values.size()},
+            {"mean_image_load_ms",values.empty()?0.0:double(total)/values.size()/1e6},
+            {"median_image_load_ms",percentileMs(values,0.5)},{"p95_image_load_ms",percentileMs(values,0.95)},
+            {"total_image_load_ms",double(total)/1e6}
+        };
+        addLatencyIntervals(image_load[name], values, "mean_image_load_ms",
+                            {{"median_image_load_ms",0.5},{"p95_image_load_ms",0.95}}, options.bootstrap_resamples);
     }
     json summary = {
         {"title","ZXing-C++ vs. Dynamsoft Barcode Reader"},
         {"dataset","BarBeR public dataset"},
         {"disclosure","This benchmark was implemented and published by Dynamsoft, the developer of Dynamsoft Barcode Reader. It uses the public third-party BarBeR dataset. To make the comparison auditable, the protocol, source code, decoder configurations, environment details, dataset manifest, HTML report, and per-image raw results are provided. BarBeR's standardized annotations were generated with assistance from proprietary Datalogic software. Difficult undecodable barcode regions were manually localized and are excluded from decoding accuracy when no reliable payload is available."},
-        {"decoders",decoders}
+        {"decoders",decoders},
+        {"image_load",image_load},
+        {"environment_sha256",environments}
     };
+    // The runner writes environment.json next to results.jsonl.
+    if (std::ifstream environment{jsonl.parent_path()/"environment.json"}) summary["environment"] = json::parse(environment);
     std::filesystem::create_directories(output.parent_path());
     std::ofstream(output) << std::setw(2) << summary << '\n';
 }
@@ -225,21 +511,29 @@ void generateResultsJson(const std::filesystem::path& jsonl,
                          const std::filesystem::path& summary,
                          const std::filesystem::path& output)
 {
-    json records = json::array();
+    // Records are copied line by line from the raw stream, so memory use is
+    // bounded by the longest record instead of the whole run.
     std::ifstream in(jsonl, std::ios::binary);
     if (!in) throw std::runtime_error("cannot read results: " + jsonl.string());
-    std::string line;
-    while (std::getline(in, line)) {
-        if (!line.empty()) records.push_back(json::parse(line));
-    }
     std::ifstream summary_in(summary, std::ios::binary);
     if (!summary_in) throw std::runtime_error("cannot read summary: " + summary.string());
-    json value = {
-        {"summary", json::parse(summary_in)},
-        {"records", records}
-    };
+    std::string summary_text((std::istreambuf_iterator<char>(summary_in)), std::istreambuf_iterator<char>());
+    while (!summary_text.empty() && std::isspace(static_cast<unsigned char>(summary_text.back()))) summary_text.pop_back();
+    if (!json::accept(summary_text)) throw std::runtime_error("invalid summary JSON: " + summary.string());
     std::filesystem::create_directories(output.parent_path());
-    std::ofstream(output) << std::setw(2) << value << '\n';
+    std::ofstream out(output, std::ios::binary);
+    if (!out) throw std::runtime_error("cannot write results: " + output.string());
+    out << "{\n  \"summary\": " << summary_text << ",\n  \"records\": [";
+    std::string line;
+    std::size_t line_number = 0, written = 0;
+    while (std::getline(in, line)) {
+        ++line_number;
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty()) continue;
+        if (!json::accept(line)) throw std::runtime_error("invalid result record at line " + std::to_string(line_number) + ": " + jsonl.string());
+        out << (written++ ? ",\n    " : "\n    ") << line;
+    }
+    out << (written ? "\n  ]\n}\n" : "]\n}\n");
 }
 
 } // namespace bench
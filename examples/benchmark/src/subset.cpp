@@ -0,0 +1,122 @@
+#include "subset.h"
+
+#include "metrics.h"
+#include "normalization.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <random>
+#include <set>
+#include <stdexcept>
+
+namespace bench {
+namespace {
+
+constexpr const char* kDimensions[] = {"format", "symbols", "megapixels", "ppe", "source"};
+
+// Largest-remainder proportional allocation with a floor of one per stratum
+// and a ceiling of the stratum's population.
+std::vector<std::size_t> allocate(const std::vector<std::size_t>& sizes, std::size_t total, std::size_t target)
+{
+    std::vector<double> ideal(sizes.size());
+    std::vector<std::size_t> result(sizes.size());
+    std::size_t assigned = 0;
+    for (std::size_t h = 0; h < sizes.size(); ++h) {
+        ideal[h] = double(target) * double(sizes[h]) / double(total);
+        result[h] = std::clamp<std::size_t>(static_cast<std::size_t>(ideal[h]), 1, sizes[h]);
+        assigned += result[h];
+    }
+    while (assigned < target) {
+        std::size_t best = sizes.size();
+        for (std::size_t h = 0; h < sizes.size(); ++h)
+            if (result[h] < sizes[h] && (best == sizes.size() || ideal[h] - result[h] > ideal[best] - result[best])) best = h;
+        ++result[best]; ++assigned;
+    }
+    while (assigned > target) {
+        std::size_t best = sizes.size();
+        for (std::size_t h = 0; h < sizes.size(); ++h)
+            if (result[h] > 1 && (best == sizes.size() || ideal[h] - result[h] < ideal[best] - result[best])) best = h;
+        --result[best]; --assigned;
+    }
+    return result;
+}
+
+} // namespace
+
+std::string subsetStratum(const ManifestRecord& record, const SubsetOptions& options, std::size_t dimensions)
+{
+    std::set<std::string> formats;
+    double min_ppe = std::numeric_limits<double>::infinity();
+    for (const auto& gt : record.ground_truth) {
+        formats.insert(canonicalFormat(gt.format));
+        if (gt.ppe) min_ppe = std::min(min_ppe, *gt.ppe);
+    }
+    std::string format;
+    for (const auto& item : formats) format += (format.empty() ? "" : "+") + item;
+    const auto symbols = record.ground_truth.size();
+    const double megapixels = double(record.width) * record.height / 1e6;
+    const std::string parts[] = {
+        format,
+        symbols >= 3 ? std::string("3+") : std::to_string(symbols),
+        bucketLabel(options.megapixel_buckets, bucketIndex(options.megapixel_buckets, megapixels)),
+        std::isinf(min_ppe) ? std::string("unknown") : bucketLabel(options.ppe_buckets, bucketIndex(options.ppe_buckets, min_ppe)),
+        record.annotation_file
+    };
+    std::string key;
+    for (std::size_t i = 0; i < std::min<std::size_t>(dimensions, 5); ++i) key += (i ? "|" : "") + parts[i];
+    return key;
+}
+
+SubsetResult selectSubset(const std::vector<ManifestRecord>& population, const SubsetOptions& options)
+{
+    if (!options.size) throw std::runtime_error("subset size must be positive");
+    if (population.empty()) throw std::runtime_error("cannot take a subset of an empty manifest");
+    SubsetResult result;
+    result.population = population.size();
+
+    std::map<std::string, std::vector<std::size_t>> strata;
+    std::size_t dimensions = 5;
+    for (;; --dimensions) {
+        strata.clear();
+        for (std::size_t i = 0; i < population.size(); ++i)
+            strata[subsetStratum(population[i], options, dimensions)].push_back(i);
+        if (strata.size() <= options.size || dimensions == 1) break;
+    }
+    if (strata.size() > options.size)
+        throw std::runtime_error("subset size " + std::to_string(options.size) + " is smaller than the " +
+                                 std::to_string(strata.size()) + " format strata");
+    result.dimensions.assign(kDimensions, kDimensions + dimensions);
+    result.strata = strata.size();
+
+    std::vector<std::size_t> sizes;
+    for (const auto& [key, members] : strata) sizes.push_back(members.size());
+    const auto picks = allocate(sizes, population.size(), std::min(options.size, population.size()));
+
+    // Strata are visited in key order and drawn with a partial Fisher-Yates
+    // shuffle on mt19937_64, so a seed gives the same subset on every platform.
+    std::mt19937_64 random(options.seed);
+    std::vector<std::pair<std::size_t, double>> chosen;
+    std::vector<std::string> chosen_strata(population.size());
+    std::size_t h = 0;
+    for (auto& [key, members] : strata) {
+        const auto take = picks[h++];
+        for (std::size_t i = 0; i < take; ++i) {
+            const auto j = i + static_cast<std::size_t>(random() % (members.size() - i));
+            std::swap(members[i], members[j]);
+            chosen.emplace_back(members[i], double(members.size()) / double(take));
+            chosen_strata[members[i]] = key;
+        }
+    }
+    std::sort(chosen.begin(), chosen.end());
+    for (const auto& [index, weight] : chosen) {
+        auto record = population[index];
+        record.stratum = chosen_strata[index];
+        record.weight = weight;
+        result.records.push_back(std::move(record));
+    }
+    return result;
+}
+
+} // namespace bench
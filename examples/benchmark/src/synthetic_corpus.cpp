@@ -0,0 +1,454 @@
+#include "synthetic_corpus.h"
+
+#include "barber_dataset.h"
+#include "hash.h"
+#include "normalization.h"
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include "stb_image_write.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+namespace bench {
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr std::size_t kBatch = 256;
+
+std::uint64_t splitmix(std::uint64_t value)
+{
+    value += 0x9e3779b97f4a7c15ull;
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+    return value ^ (value >> 31);
+}
+
+int uniformInt(std::mt19937_64& rng, int low, int high)
+{
+    return std::uniform_int_distribution<int>(low, high)(rng);
+}
+
+double uniformReal(std::mt19937_64& rng, double low, double high)
+{
+    return high > low ? std::uniform_real_distribution<double>(low, high)(rng) : low;
+}
+
+std::string randomDigits(std::mt19937_64& rng, std::size_t count)
+{
+    std::string value;
+    for (std::size_t i = 0; i < count; ++i) value.push_back(static_cast<char>('0' + uniformInt(rng, 0, 9)));
+    return value;
+}
+
+std::string randomFrom(std::mt19937_64& rng, std::string_view alphabet, std::size_t count)
+{
+    std::string value;
+    for (std::size_t i = 0; i < count; ++i)
+        value.push_back(alphabet[static_cast<std::size_t>(uniformInt(rng, 0, static_cast<int>(alphabet.size()) - 1))]);
+    return value;
+}
+
+char gtinCheckDigit(std::string_view body)
+{
+    int sum = 0; bool weight_three = true;
+    for (std::size_t i = body.size(); i-- > 0;) {
+        sum += (body[i] - '0') * (weight_three ? 3 : 1);
+        weight_three = !weight_three;
+    }
+    return static_cast<char>('0' + (10 - sum % 10) % 10);
+}
+
+// UPC-E carries the check digit of its zero-suppressed UPC-A expansion.
+std::string upcECheckBody(std::string_view upce)
+{
+    const std::string d(upce.substr(1, 6));
+    const std::string system(upce.substr(0, 1));
+    switch (d[5]) {
+    case '0': case '1': case '2': return system + d.substr(0, 2) + d[5] + "0000" + d.substr(2, 3);
+    case '3': return system + d.substr(0, 3) + "00000" + d.substr(3, 2);
+    case '4': return system + d.substr(0, 4) + "00000" + d[4];
+    default: return system + d.substr(0, 5) + "0000" + d[5];
+    }
+}
+
+bool isTwoDimensional(std::string_view format)
+{
+    return format == "QR_CODE" || format == "DATA_MATRIX" || format == "AZTEC" || format == "PDF_417";
+}
+
+struct Rgb { double r = 0, g = 0, b = 0; };
+
+class Canvas {
+public:
+    Canvas(int width, int height) : width_(width), height_(height), pixels_(static_cast<std::size_t>(width) * height * 3) {}
+    int width() const { return width_; }
+    int height() const { return height_; }
+    std::uint8_t* data() { return pixels_.data(); }
+    std::uint8_t* at(int x, int y) { return pixels_.data() + (static_cast<std::size_t>(y) * width_ + x) * 3; }
+    void blend(int x, int y, const Rgb& color, double alpha)
+    {
+        auto* p = at(x, y);
+        const double channels[] = {color.r, color.g, color.b};
+        for (int c = 0; c < 3; ++c)
+            p[c] = static_cast<std::uint8_t>(std::clamp(std::lround(p[c] * (1.0 - alpha) + channels[c] * alpha), 0L, 255L));
+    }
+    std::vector<std::uint8_t>& pixels() { return pixels_; }
+
+private:
+    int width_;
+    int height_;
+    std::vector<std::uint8_t> pixels_;
+};
+
+Rgb tinted(std::mt19937_64& rng, double level, double spread)
+{
+    return {level + uniformReal(rng, -spread, spread), level + uniformReal(rng, -spread, spread),
+            level + uniformReal(rng, -spread, spread)};
+}
+
+// Smooth shading plus a handful of translucent rectangles, so binarizers see
+// gradients and edges that are not barcodes.
+void paintBackground(Canvas& canvas, std::mt19937_64& rng)
+{
+    const Rgb base = tinted(rng, uniformReal(rng, 90, 200), 30);
+    const double gx = uniformReal(rng, -60, 60), gy = uniformReal(rng, -60, 60);
+    const double frequency = uniformReal(rng, 0.5, 3.0) * 2 * kPi, phase = uniformReal(rng, 0, 2 * kPi);
+    for (int y = 0; y < canvas.height(); ++y) {
+        const double fy = static_cast<double>(y) / canvas.height();
+        for (int x = 0; x < canvas.width(); ++x) {
+            const double fx = static_cast<double>(x) / canvas.width();
+            const double shade = gx * (fx - 0.5) + gy * (fy - 0.5) + 12 * std::sin(frequency * (fx + fy) + phase);
+            auto* p = canvas.at(x, y);
+            p[0] = static_cast<std::uint8_t>(std::clamp(base.r + shade, 0.0, 255.0));
+            p[1] = static_cast<std::uint8_t>(std::clamp(base.g + shade, 0.0, 255.0));
+            p[2] = static_cast<std::uint8_t>(std::clamp(base.b + shade, 0.0, 255.0));
+        }
+    }
+    const int clutter = uniformInt(rng, 4, 16);
+    for (int i = 0; i < clutter; ++i) {
+        const int w = uniformInt(rng, canvas.width() / 20, canvas.width() / 3);
+        const int h = uniformInt(rng, canvas.height() / 20, canvas.height() / 3);
+        const int x0 = uniformInt(rng, -w / 2, canvas.width() - w / 2);
+        const int y0 = uniformInt(rng, -h / 2, canvas.height() - h / 2);
+        const Rgb color = tinted(rng, uniformReal(rng, 20, 235), 40);
+        const double alpha = uniformReal(rng, 0.15, 0.5);
+        for (int y = std::max(0, y0); y < std::min(canvas.height(), y0 + h); ++y)
+            for (int x = std::max(0, x0); x < std::min(canvas.width(), x0 + w); ++x) canvas.blend(x, y, color, alpha);
+    }
+}
+
+struct Placement {
+    double cx = 0, cy = 0, cos = 1, sin = 0;
+    double label_w = 0, label_h = 0;
+    int x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+};
+
+bool overlaps(const Placement& a, const Placement& b)
+{
+    return a.x0 < b.x1 && b.x0 < a.x1 && a.y0 < b.y1 && b.y0 < a.y1;
+}
+
+// Draws the symbol on a paper label (symbol plus quiet zone) rotated about its
+// centre, with 4x supersampling so module edges are anti-aliased. Returns the
+// symbol polygon (without quiet zone) in image coordinates.
+std::vector<Point> drawSymbol(Canvas& canvas, const SymbolMatrix& matrix, bool linear, double scale,
+                              double symbol_w, double symbol_h, double quiet_x, double quiet_y,
+                              const Placement& place, const Rgb& paper, const Rgb& ink)
+{
+    constexpr double offsets[] = {0.25, 0.75};
+    for (int y = place.y0; y < place.y1; ++y) {
+        for (int x = place.x0; x < place.x1; ++x) {
+            int inside = 0, dark = 0;
+            for (double oy : offsets) {
+                for (double ox : offsets) {
+                    const double dx = x + ox - place.cx, dy = y + oy - place.cy;
+                    const double lx = place.cos * dx + place.sin * dy + place.label_w / 2;
+                    const double ly = -place.sin * dx + place.cos * dy + place.label_h / 2;
+                    if (lx < 0 || ly < 0 || lx >= place.label_w || ly >= place.label_h) continue;
+                    ++inside;
+                    const double sx = lx - quiet_x, sy = ly - quiet_y;
+                    if (sx < 0 || sy < 0 || sx >= symbol_w || sy >= symbol_h) continue;
+                    const int column = std::min(matrix.width - 1, static_cast<int>(sx / scale));
+                    const int row = linear ? 0 : std::min(matrix.height - 1, static_cast<int>(sy / scale));
+                    if (matrix.dark(column, row)) ++dark;
+                }
+            }
+            if (!inside) continue;
+            const double coverage = static_cast<double>(dark) / inside;
+            const Rgb color{paper.r + (ink.r - paper.r) * coverage, paper.g + (ink.g - paper.g) * coverage,
+                            paper.b + (ink.b - paper.b) * coverage};
+            canvas.blend(x, y, color, inside / 4.0);
+        }
+    }
+    std::vector<Point> polygon;
+    const double corners[4][2] = {{quiet_x, quiet_y}, {quiet_x + symbol_w, quiet_y},
+                                  {quiet_x + symbol_w, quiet_y + symbol_h}, {quiet_x, quiet_y + symbol_h}};
+    for (const auto& corner : corners) {
+        const double u = corner[0] - place.label_w / 2, v = corner[1] - place.label_h / 2;
+        polygon.push_back({static_cast<int>(std::lround(place.cx + place.cos * u - place.sin * v)),
+                           static_cast<int>(std::lround(place.cy + place.sin * u + place.cos * v))});
+    }
+    return polygon;
+}
+
+// Narrowest run of equal cells along a row; writers that upscale (PDF417
+// renders each module several cells wide) are normalized through this.
+int narrowestRun(const SymbolMatrix& matrix, bool linear)
+{
+    int narrowest = matrix.width;
+    const int rows = linear ? 1 : matrix.height;
+    for (int y = 0; y < rows; ++y) {
+        int run = 1;
+        for (int x = 1; x < matrix.width; ++x) {
+            if (matrix.dark(x, y) == matrix.dark(x - 1, y)) { ++run; continue; }
+            narrowest = std::min(narrowest, run); run = 1;
+        }
+    }
+    return std::max(1, narrowest);
+}
+
+// Separable Gaussian: rows are convolved through a clamped, padded float
+// copy and columns by accumulating whole rows, so both loops vectorize.
+void gaussianBlur(Canvas& canvas, double sigma)
+{
+    if (sigma < 0.3) return;
+    const int radius = static_cast<int>(std::ceil(sigma * 3));
+    std::vector<float> kernel(static_cast<std::size_t>(radius) * 2 + 1);
+    float total = 0;
+    for (int i = -radius; i <= radius; ++i) total += kernel[i + radius] = static_cast<float>(std::exp(-0.5 * i * i / (sigma * sigma)));
+    for (auto& weight : kernel) weight /= total;
+
+    const std::size_t row = static_cast<std::size_t>(canvas.width()) * 3;
+    std::vector<float> rows(row * canvas.height()), padded((canvas.width() + 2 * radius) * 3), sum(row);
+    for (int y = 0; y < canvas.height(); ++y) {
+        const auto* source = canvas.at(0, y);
+        for (int x = -radius; x < canvas.width() + radius; ++x) {
+            const auto* p = source + std::clamp(x, 0, canvas.width() - 1) * 3;
+            for (int c = 0; c < 3; ++c) padded[(x + radius) * 3 + c] = p[c];
+        }
+        float* out = rows.data() + row * y;
+        std::fill(out, out + row, 0.0f);
+        for (int k = 0; k <= 2 * radius; ++k) {
+            const float* in = padded.data() + k * 3;
+            for (std::size_t i = 0; i < row; ++i) out[i] += in[i] * kernel[k];
+        }
+    }
+    for (int y = 0; y < canvas.height(); ++y) {
+        std::fill(sum.begin(), sum.end(), 0.0f);
+        for (int k = -radius; k <= radius; ++k) {
+            const float* in = rows.data() + row * std::clamp(y + k, 0, canvas.height() - 1);
+            for (std::size_t i = 0; i < row; ++i) sum[i] += in[i] * kernel[k + radius];
+        }
+        auto* out = canvas.at(0, y);
+        for (std::size_t i = 0; i < row; ++i) out[i] = static_cast<std::uint8_t>(std::clamp(sum[i] + 0.5f, 0.0f, 255.0f));
+    }
+}
+
+// Luminance noise drawn from a per-image table of Gaussian samples indexed by
+// 12-bit slices of one 64-bit draw, which is far cheaper than a normal draw
+// per pixel and statistically indistinguishable at this scale.
+void addNoise(Canvas& canvas, std::mt19937_64& rng, double sigma)
+{
+    if (sigma <= 0) return;
+    std::normal_distribution<double> noise(0.0, sigma);
+    std::array<int, 4096> table;
+    for (auto& value : table) value = static_cast<int>(std::lround(noise(rng)));
+    auto& pixels = canvas.pixels();
+    std::uint64_t bits = 0;
+    int remaining = 0;
+    for (std::size_t i = 0; i < pixels.size(); i += 3) {
+        if (!remaining) { bits = rng(); remaining = 5; }
+        const int delta = table[bits & 4095];
+        bits >>= 12; --remaining;
+        for (std::size_t c = 0; c < 3; ++c) pixels[i + c] = static_cast<std::uint8_t>(std::clamp(pixels[i + c] + delta, 0, 255));
+    }
+}
+
+void appendBytes(void* context, void* data, int size)
+{
+    auto* output = static_cast<std::string*>(context);
+    output->append(static_cast<const char*>(data), static_cast<std::size_t>(size));
+}
+
+std::string relativeImagePath(std::size_t index, const std::string& extension)
+{
+    std::ostringstream path;
+    path << std::setw(4) << std::setfill('0') << index / 1000 << '/'
+         << std::setw(7) << std::setfill('0') << index << '.' << extension;
+    return path.str();
+}
+
+struct SynthImage {
+    ManifestRecord record;
+    std::size_t skipped = 0;
+};
+
+SynthImage renderImage(const SynthOptions& options, const std::vector<std::string>& formats,
+                       const ISymbolEncoder& encoder, std::size_t index)
+{
+    std::mt19937_64 rng(splitmix(options.seed ^ splitmix(index)));
+    SynthImage image;
+    auto& record = image.record;
+    record.sample_id = "synth:" + std::to_string(options.seed) + ":" + std::to_string(index);
+    record.relative_path = relativeImagePath(index, options.image_format);
+    record.annotation_file = "synth";
+    record.width = options.width; record.height = options.height;
+
+    Canvas canvas(options.width, options.height);
+    paintBackground(canvas, rng);
+    std::vector<Placement> placed;
+    const int symbols = uniformInt(rng, 1, std::max(1, options.max_symbols));
+    for (int s = 0; s < symbols; ++s) {
+        const auto& format = formats[static_cast<std::size_t>(uniformInt(rng, 0, static_cast<int>(formats.size()) - 1))];
+        const double module = options.module_sizes[static_cast<std::size_t>(
+            uniformInt(rng, 0, static_cast<int>(options.module_sizes.size()) - 1))];
+        const auto text = syntheticPayload(format, rng);
+        SymbolMatrix matrix;
+        std::string error;
+        if (!encoder.encode(format, text, matrix, error) || matrix.width <= 0 || matrix.height <= 0) { ++image.skipped; continue; }
+
+        const bool linear = !isTwoDimensional(format);
+        const double scale = module / narrowestRun(matrix, linear);
+        const double symbol_w = matrix.width * scale;
+        const double symbol_h = linear ? std::max(20 * module, symbol_w * 0.3) : matrix.height * scale;
+        const double quiet_x = (linear ? 10 : 4) * module, quiet_y = 4 * module;
+        const double angle = uniformReal(rng, -options.max_rotation_deg, options.max_rotation_deg) * kPi / 180.0;
+
+        Placement place;
+        place.cos = std::cos(angle); place.sin = std::sin(angle);
+        place.label_w = symbol_w + 2 * quiet_x; place.label_h = symbol_h + 2 * quiet_y;
+        const double extent_x = (std::abs(place.cos) * place.label_w + std::abs(place.sin) * place.label_h) / 2;
+        const double extent_y = (std::abs(place.sin) * place.label_w + std::abs(place.cos) * place.label_h) / 2;
+        bool fitted = false;
+        for (int attempt = 0; attempt < 32 && !fitted && 2 * extent_x + 2 < options.width && 2 * extent_y + 2 < options.height; ++attempt) {
+            place.cx = uniformReal(rng, extent_x + 1, options.width - extent_x - 1);
+            place.cy = uniformReal(rng, extent_y + 1, options.height - extent_y - 1);
+            place.x0 = std::max(0, static_cast<int>(std::floor(place.cx - extent_x)));
+            place.y0 = std::max(0, static_cast<int>(std::floor(place.cy - extent_y)));
+            place.x1 = std::min(options.width, static_cast<int>(std::ceil(place.cx + extent_x)) + 1);
+            place.y1 = std::min(options.height, static_cast<int>(std::ceil(place.cy + extent_y)) + 1);
+            fitted = std::none_of(placed.begin(), placed.end(), [&](const Placement& other) { return overlaps(place, other); });
+        }
+        if (!fitted) { ++image.skipped; continue; }
+        placed.push_back(place);
+
+        const Rgb paper = tinted(rng, uniformReal(rng, 215, 250), 6);
+        const Rgb ink = tinted(rng, uniformReal(rng, 10, 60), 8);
+        GroundTruth truth;
+        truth.annotation_id = record.sample_id + ":" + std::to_string(record.ground_truth.size());
+        truth.format = format;
+        truth.text = text;
+        truth.polygon = drawSymbol(canvas, matrix, linear, scale, symbol_w, symbol_h, quiet_x, quiet_y, place, paper, ink);
+        truth.ppe = module;
+        truth.decode_eligible = true;
+        record.ground_truth.push_back(std::move(truth));
+    }
+    gaussianBlur(canvas, uniformReal(rng, 0.0, options.max_blur));
+    addNoise(canvas, rng, uniformReal(rng, 0.0, options.max_noise));
+
+    std::string encoded;
+    const bool written = options.image_format == "png"
+        ? stbi_write_png_to_func(appendBytes, &encoded, canvas.width(), canvas.height(), 3, canvas.data(), canvas.width() * 3) != 0
+        : stbi_write_jpg_to_func(appendBytes, &encoded, canvas.width(), canvas.height(), 3, canvas.data(), 92) != 0;
+    if (!written) throw std::runtime_error("cannot encode synthetic image " + record.relative_path);
+    const auto path = options.output / "images" / record.relative_path;
+    std::filesystem::create_directories(path.parent_path());
+    std::ofstream out(path, std::ios::binary);
+    out.write(encoded.data(), static_cast<std::streamsize>(encoded.size()));
+    if (!out) throw std::runtime_error("cannot write synthetic image: " + path.string());
+    record.image_sha256 = sha256(encoded);
+    return image;
+}
+
+} // namespace
+
+std::string syntheticPayload(std::string_view canonical_format, std::mt19937_64& rng)
+{
+    static constexpr std::string_view code39 = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    static constexpr std::string_view code93 = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ-.$/+%";
+    static constexpr std::string_view codabar = "0123456789-$:/.+";
+    static constexpr std::string_view codabar_guards = "ABCD";
+    static constexpr std::string_view text = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz-./:";
+    const auto format = canonicalFormat(canonical_format);
+    if (format == "EAN_13") { auto body = randomDigits(rng, 12); return body + gtinCheckDigit(body); }
+    if (format == "EAN_8") { auto body = randomDigits(rng, 7); return body + gtinCheckDigit(body); }
+    if (format == "UPC_A") { auto body = randomDigits(rng, 11); return body + gtinCheckDigit(body); }
+    if (format == "UPC_E") { auto body = "0" + randomDigits(rng, 6); return body + gtinCheckDigit(upcECheckBody(body)); }
+    if (format == "ITF") { auto body = randomDigits(rng, 13); return body + gtinCheckDigit(body); }
+    if (format == "EAN_2") return randomDigits(rng, 2);
+    if (format == "CODE_39") return randomFrom(rng, code39, static_cast<std::size_t>(uniformInt(rng, 6, 12)));
+    if (format == "CODE_93") return randomFrom(rng, code93, static_cast<std::size_t>(uniformInt(rng, 6, 12)));
+    // Codabar carries its start and stop characters in the payload.
+    if (format == "CODABAR")
+        return randomFrom(rng, codabar_guards, 1) + randomFrom(rng, codabar, static_cast<std::size_t>(uniformInt(rng, 6, 12))) +
+               randomFrom(rng, codabar_guards, 1);
+    if (format == "CODE_128") return randomFrom(rng, text, static_cast<std::size_t>(uniformInt(rng, 6, 16)));
+    return randomFrom(rng, text, static_cast<std::size_t>(uniformInt(rng, 8, 60)));
+}
+
+SynthSummary generateSyntheticCorpus(const SynthOptions& options, const ISymbolEncoder& encoder)
+{
+    if (options.output.empty()) throw std::runtime_error("synthetic corpus needs an output directory");
+    if (options.width < 64 || options.height < 64) throw std::runtime_error("synthetic images must be at least 64x64");
+    if (options.module_sizes.empty()) throw std::runtime_error("synthetic corpus needs at least one module size");
+    if (options.image_format != "jpg" && options.image_format != "png")
+        throw std::runtime_error("unsupported synthetic image format: " + options.image_format);
+
+    const auto available = encoder.formats();
+    std::vector<std::string> formats;
+    for (const auto& requested : options.formats.empty() ? available : options.formats) {
+        const auto format = canonicalFormat(requested);
+        if (std::find(available.begin(), available.end(), format) == available.end())
+            throw std::runtime_error(encoder.name() + " cannot encode format: " + requested);
+        formats.push_back(format);
+    }
+    if (formats.empty()) throw std::runtime_error(encoder.name() + " encodes no formats");
+
+    std::filesystem::create_directories(options.output / "images");
+    const auto manifest_path = options.output / "manifest.jsonl";
+    std::ofstream manifest(manifest_path, std::ios::binary);
+    if (!manifest) throw std::runtime_error("cannot write manifest: " + manifest_path.string());
+
+    // Images are rendered in fixed-size batches so the manifest streams out
+    // in index order without holding the whole corpus in memory.
+    SynthSummary summary;
+    const int threads = std::max(1, options.threads);
+    std::vector<SynthImage> batch;
+    for (std::size_t start = 0; start < options.count; start += kBatch) {
+        batch.assign(std::min(kBatch, options.count - start), SynthImage{});
+        std::atomic<std::size_t> next{0};
+        std::exception_ptr failure;
+        std::mutex failure_mutex;
+        auto work = [&] {
+            for (std::size_t i; (i = next.fetch_add(1)) < batch.size();) {
+                try { batch[i] = renderImage(options, formats, encoder, start + i); }
+                catch (...) { std::lock_guard lock(failure_mutex); if (!failure) failure = std::current_exception(); }
+            }
+        };
+        std::vector<std::thread> workers;
+        for (int t = 1; t < threads; ++t) workers.emplace_back(work);
+        work();
+        for (auto& worker : workers) worker.join();
+        if (failure) std::rethrow_exception(failure);
+        for (const auto& image : batch) {
+            manifest << BarberDataset::manifestLine(image.record) << '\n';
+            ++summary.images;
+            summary.symbols += image.record.ground_truth.size();
+            summary.skipped_symbols += image.skipped;
+        }
+    }
+    if (!manifest.flush()) throw std::runtime_error("cannot write manifest: " + manifest_path.string());
+    return summary;
+}
+
+} // namespace bench
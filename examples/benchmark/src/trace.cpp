@@ -0,0 +1,184 @@
+#include "trace.h"
+
+#include "json_writer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+namespace detail {
+std::atomic<bool> trace_enabled{false};
+}
+
+namespace {
+
+// Labels longer than this are truncated; sample ids in the shipped corpora
+// are well below it.
+constexpr std::size_t kTraceText = 63;
+
+struct TraceEvent {
+    const char* name = nullptr;
+    std::int64_t begin_ns = 0;
+    std::int64_t end_ns = 0;
+    std::uint8_t sample_length = 0;
+    std::uint8_t detail_length = 0;
+    char sample_id[kTraceText];
+    char detail[kTraceText];
+};
+
+// Written only by its owning thread. head counts every span ever recorded,
+// so the exporter can tell how many were overwritten.
+struct TraceRing {
+    std::vector<TraceEvent> events;
+    std::atomic<std::uint64_t> head{0};
+    int tid = 0;
+    std::string name;
+};
+
+struct TraceRegistry {
+    std::mutex mutex;
+    std::vector<std::shared_ptr<TraceRing>> rings;
+    std::size_t capacity = 0;
+    std::atomic<std::uint64_t> generation{0};
+    std::int64_t origin_ns = 0;
+};
+
+TraceRegistry& registry()
+{
+    static TraceRegistry value;
+    return value;
+}
+
+// The calling thread's ring. The registry lock is taken only when a thread
+// records its first span of a trace session; every later span is lock-free.
+TraceRing& currentRing()
+{
+    thread_local std::shared_ptr<TraceRing> ring;
+    thread_local std::uint64_t generation = 0;
+    auto& shared = registry();
+    if (!ring || generation != shared.generation.load(std::memory_order_acquire)) {
+        std::lock_guard<std::mutex> lock(shared.mutex);
+        ring = std::make_shared<TraceRing>();
+        ring->events.resize(shared.capacity);
+        ring->tid = static_cast<int>(shared.rings.size()) + 1;
+        generation = shared.generation.load(std::memory_order_relaxed);
+        shared.rings.push_back(ring);
+    }
+    return *ring;
+}
+
+std::uint8_t copyText(char* target, std::string_view text)
+{
+    const auto length = std::min(text.size(), kTraceText);
+    std::memcpy(target, text.data(), length);
+    return static_cast<std::uint8_t>(length);
+}
+
+double microseconds(std::int64_t ns)
+{
+    return static_cast<double>(ns) / 1000.0;
+}
+
+} // namespace
+
+void startTrace(std::size_t events_per_thread)
+{
+    if (!events_per_thread) throw std::runtime_error("trace ring capacity must be positive");
+    auto& shared = registry();
+    {
+        std::lock_guard<std::mutex> lock(shared.mutex);
+        shared.rings.clear();
+        shared.capacity = events_per_thread;
+        shared.generation.fetch_add(1, std::memory_order_release);
+        shared.origin_ns = traceClock();
+    }
+    detail::trace_enabled.store(true, std::memory_order_release);
+}
+
+void stopTrace()
+{
+    detail::trace_enabled.store(false, std::memory_order_release);
+}
+
+void nameTraceThread(std::string_view name)
+{
+    if (!traceEnabled()) return;
+    auto& ring = currentRing();
+    std::lock_guard<std::mutex> lock(registry().mutex);
+    ring.name = std::string(name);
+}
+
+std::int64_t traceClock()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void recordTraceSpan(const char* name, std::string_view sample_id, std::string_view detail,
+                     std::int64_t begin_ns, std::int64_t end_ns)
+{
+    if (!traceEnabled()) return;
+    auto& ring = currentRing();
+    const auto index = ring.head.load(std::memory_order_relaxed);
+    auto& event = ring.events[index % ring.events.size()];
+    event.name = name;
+    event.begin_ns = begin_ns;
+    event.end_ns = end_ns;
+    event.sample_length = copyText(event.sample_id, sample_id);
+    event.detail_length = copyText(event.detail, detail);
+    ring.head.store(index + 1, std::memory_order_release);
+}
+
+std::size_t writeTrace(const std::filesystem::path& output)
+{
+    auto& shared = registry();
+    std::lock_guard<std::mutex> lock(shared.mutex);
+    std::string buffer;
+    JsonWriter out(buffer);
+    std::size_t written = 0;
+    std::uint64_t dropped = 0;
+    out.beginObject().key("traceEvents").beginArray();
+    for (const auto& ring : shared.rings) {
+        out.beginObject().field("name", "thread_name").field("ph", "M").field("pid", 1).field("tid", ring->tid)
+           .key("args").beginObject()
+           .field("name", ring->name.empty() ? "thread-" + std::to_string(ring->tid) : ring->name)
+           .endObject().endObject();
+        const auto head = ring->head.load(std::memory_order_acquire);
+        const auto kept = std::min<std::uint64_t>(head, ring->events.size());
+        dropped += head - kept;
+        for (auto index = head - kept; index < head; ++index) {
+            const auto& event = ring->events[index % ring->events.size()];
+            out.beginObject().field("name", event.name).field("cat", "bench").field("ph", "X")
+               .field("ts", microseconds(event.begin_ns - shared.origin_ns))
+               .field("dur", microseconds(event.end_ns - event.begin_ns))
+               .field("pid", 1).field("tid", ring->tid);
+            if (event.sample_length || event.detail_length) {
+                out.key("args").beginObject();
+                if (event.sample_length) out.field("sample_id", std::string_view(event.sample_id, event.sample_length));
+                if (event.detail_length) out.field("detail", std::string_view(event.detail, event.detail_length));
+                out.endObject();
+            }
+            out.endObject();
+            ++written;
+        }
+    }
+    out.endArray().field("displayTimeUnit", "ms")
+       .key("otherData").beginObject().field("dropped_spans", dropped).endObject()
+       .endObject();
+    buffer.push_back('\n');
+    if (output.has_parent_path()) std::filesystem::create_directories(output.parent_path());
+    std::ofstream file(output, std::ios::binary);
+    file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    if (!file) throw std::runtime_error("cannot write trace: " + output.string());
+    return written;
+}
+
+} // namespace bench
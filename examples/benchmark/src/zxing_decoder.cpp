@@ -1,5 +1,6 @@
 #include "decoder_adapter.h"
 #include "normalization.h"
+#include "resource_usage.h"
 
 #include <BarcodeFormat.h>
 #include <ImageView.h>
@@ -32,17 +33,20 @@ public:
     {
         DecodeRun run;
         try {
-            const ZXing::ImageView view(image.rgb.data(), image.width, image.height,
+            const ZXing::ImageView view(image.data(), image.width, image.height,
                                         ZXing::ImageFormat::RGB, image.stride);
+            const auto resources = captureResources();
             const auto begin = std::chrono::steady_clock::now();
             const auto barcodes = ZXing::ReadBarcodes(view, options_);
             run.decode_time = std::chrono::steady_clock::now() - begin;
+            recordResourceDelta(run, resources, captureResources());
             for (const auto& barcode : barcodes) {
                 if (!barcode.isValid()) continue;
                 DecodedBarcode result;
                 result.canonical_format = canonicalFormat(ZXing::ToString(barcode.format()));
                 result.raw_bytes.assign(barcode.bytes().begin(), barcode.bytes().end());
                 result.text = barcode.text();
+                for (const auto& corner : barcode.position()) result.position.push_back({corner.x, corner.y});
                 run.results.push_back(std::move(result));
             }
         } catch (const std::exception& e) {
@@ -0,0 +1,69 @@
+#include "synthetic_corpus.h"
+
+#include <BarcodeFormat.h>
+#include <BitMatrix.h>
+#include <MultiFormatWriter.h>
+
+#include <map>
+
+namespace bench {
+namespace {
+
+const std::map<std::string, ZXing::BarcodeFormat, std::less<>>& writerFormats()
+{
+    static const std::map<std::string, ZXing::BarcodeFormat, std::less<>> value = {
+        {"AZTEC", ZXing::BarcodeFormat::Aztec}, {"CODABAR", ZXing::BarcodeFormat::Codabar},
+        {"CODE_128", ZXing::BarcodeFormat::Code128}, {"CODE_39", ZXing::BarcodeFormat::Code39},
+        {"CODE_93", ZXing::BarcodeFormat::Code93}, {"DATA_MATRIX", ZXing::BarcodeFormat::DataMatrix},
+        {"EAN_13", ZXing::BarcodeFormat::EAN13}, {"EAN_8", ZXing::BarcodeFormat::EAN8},
+        {"ITF", ZXing::BarcodeFormat::ITF}, {"PDF_417", ZXing::BarcodeFormat::PDF417},
+        {"QR_CODE", ZXing::BarcodeFormat::QRCode}, {"UPC_A", ZXing::BarcodeFormat::UPCA},
+        {"UPC_E", ZXing::BarcodeFormat::UPCE}
+    };
+    return value;
+}
+
+class ZxingEncoder final : public ISymbolEncoder {
+public:
+    std::string name() const override { return "zxing-cpp"; }
+
+    std::vector<std::string> formats() const override
+    {
+        std::vector<std::string> names;
+        for (const auto& [format, value] : writerFormats()) names.push_back(format);
+        return names;
+    }
+
+    bool encode(std::string_view canonical_format, std::string_view text,
+                SymbolMatrix& output, std::string& error) const override
+    {
+        const auto it = writerFormats().find(canonical_format);
+        if (it == writerFormats().end()) { error = "unsupported format: " + std::string(canonical_format); return false; }
+        try {
+            // A writer per call keeps the encoder thread-safe; zero size and
+            // margin yield the minimal matrix and the renderer adds the quiet zone.
+            ZXing::MultiFormatWriter writer(it->second);
+            writer.setMargin(0);
+            const auto matrix = writer.encode(std::string(text), 0, 0);
+            output.width = matrix.width();
+            output.height = matrix.height();
+            output.cells.assign(static_cast<std::size_t>(output.width) * output.height, 0);
+            for (int y = 0; y < output.height; ++y)
+                for (int x = 0; x < output.width; ++x)
+                    output.cells[static_cast<std::size_t>(y) * output.width + x] = matrix.get(x, y) ? 1 : 0;
+            return true;
+        } catch (const std::exception& e) {
+            error = e.what();
+            return false;
+        }
+    }
+};
+
+} // namespace
+
+std::unique_ptr<ISymbolEncoder> createZxingEncoder()
+{
+    return std::make_unique<ZxingEncoder>();
+}
+
+} // namespace bench
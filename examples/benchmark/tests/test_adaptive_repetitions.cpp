@@ -0,0 +1,64 @@
+#include "test_support.h"
+#include "adaptive_repetitions.h"
+#include "metrics.h"
+#include "result_writer.h"
+
+#include <nlohmann/json.hpp>
+#include <cmath>
+#include <fstream>
+
+using namespace bench;
+
+void testAdaptiveRepetitions()
+{
+    CHECK(studentT95(1)==12.706); CHECK(studentT95(30)==2.042);
+    CHECK(std::abs(studentT95(31)-2.040)<0.005); CHECK(std::abs(studentT95(100000)-1.96)<0.001);
+    CHECK(std::isinf(studentT95(0)));
+
+    bool rejected=false;
+    try { AdaptiveRepetitions({0.05,3,2}); } catch (const std::exception&) { rejected=true; }
+    CHECK(rejected);
+
+    AdaptiveRepetitions adaptive({0.05,3,10});
+    // stable: always 2 ms. noisy: 1 or 3 ms. broken: fails once.
+    CHECK(adaptive.needsMore("stable","dec"));
+    for(int i=0;i<10;++i){
+        if(adaptive.needsMore("stable","dec"))adaptive.add("stable","dec",2000000,false);
+        if(adaptive.needsMore("noisy","dec"))adaptive.add("noisy","dec",i%2?3000000:1000000,false);
+        if(adaptive.needsMore("broken","dec"))adaptive.add("broken","dec",i==1?0:5000000,i==1);
+        if(adaptive.needsMore("stable","other"))adaptive.add("stable","other",1000000+i,false);
+    }
+    CHECK(!adaptive.needsMore("stable","dec")); CHECK(adaptive.relativeHalfWidth("stable","dec")==0.0);
+    CHECK(!adaptive.needsMore("noisy","dec")); CHECK(adaptive.relativeHalfWidth("noisy","dec")>0.05);
+    CHECK(!adaptive.needsMore("broken","dec"));
+    CHECK(std::isinf(adaptive.relativeHalfWidth("missing","dec")));
+
+    const auto report=adaptive.report();
+    CHECK(report.decoders.size()==2);
+    const auto& dec=report.decoders[0];
+    CHECK(dec.decoder=="dec"); CHECK(dec.units==3); CHECK(dec.converged==1); CHECK(dec.capped==1); CHECK(dec.failed==1);
+    CHECK(dec.decode_calls==3+10+2); CHECK(dec.max_repetitions_used==10); CHECK(dec.fixed_equivalent_calls==30);
+    CHECK(std::abs(dec.mean_decode_ms-(2+2+5)/3.0)<1e-9);
+    CHECK(report.decoders[1].decode_calls==3); CHECK(report.decoders[1].converged==1);
+    CHECK(report.decode_calls==18); CHECK(report.fixed_equivalent_calls==40); CHECK(report.savedCalls()==22);
+
+    // Resuming from results.jsonl rebuilds the same stopping state.
+    const auto root=std::filesystem::temp_directory_path()/"barber_adaptive_test";
+    std::filesystem::remove_all(root);
+    for(int repetition=0;repetition<3;++repetition){
+        RawResultRecord record; record.decoder="dec"; record.repetition=repetition; record.sample.sample_id="noisy";
+        record.run.decode_time=std::chrono::milliseconds(repetition%2?3:1);
+        appendResult(root/"results.jsonl",record);
+        record.sample.sample_id="broken"; record.run.error="boom";
+        appendResult(root/"results.jsonl",record);
+    }
+    AdaptiveRepetitions resumed({0.05,3,10});
+    resumed.load(root/"results.jsonl");
+    CHECK(resumed.needsMore("noisy","dec")); CHECK(!resumed.needsMore("broken","dec")); CHECK(resumed.needsMore("new","dec"));
+    CHECK(resumed.report().decode_calls==6);
+    writeAdaptiveReport(resumed.report(),resumed.options(),root/"adaptive.json");
+    std::ifstream in(root/"adaptive.json");
+    const auto written=nlohmann::json::parse(in);
+    CHECK(written["decode_calls"]==6); CHECK(written["decoders"]["dec"]["failed"]==1);
+    std::filesystem::remove_all(root);
+}
@@ -0,0 +1,45 @@
+#include "test_support.h"
+#include "cache_evictor.h"
+#include "result_writer.h"
+
+#include <nlohmann/json.hpp>
+#include <filesystem>
+#include <fstream>
+
+using namespace bench;
+
+void testCacheEvictor()
+{
+    CHECK(parseCacheSize("32K\n")==32u<<10); CHECK(parseCacheSize("8M")==8u<<20); CHECK(parseCacheSize("512")==512);
+    CHECK(parseCacheSize("")==0); CHECK(parseCacheSize("12Q")==0);
+
+    CacheEvictor evictor(1<<20);
+    CHECK(evictor.thrashBytes()==1u<<20);
+    std::vector<std::uint8_t> image(100003,5);
+    evictor.evict(image); evictor.evict({});
+    CHECK(image[100002]==5);
+    const CacheEvictor automatic;
+    CHECK(automatic.thrashBytes()>0); CHECK(automatic.thrashBytes()<=CacheEvictor::kMaxDefaultThrash);
+
+    // "both" records carry the evicted decode next to the warm one.
+    const auto root=std::filesystem::temp_directory_path()/"barber_cache_state_test";
+    std::filesystem::remove_all(root);
+    RawResultRecord record; record.decoder="decoder"; record.cache_state="both";
+    for(int i=0;i<2;++i){
+        record.sample.sample_id="s"+std::to_string(i);
+        record.run.decode_time=std::chrono::milliseconds(10*(i+1));
+        record.cold_decode_ns=30000000LL*(i+1);
+        appendResult(root/"results.jsonl",record);
+    }
+    SummaryOptions options; options.bootstrap_resamples=50;
+    generateSummary(root/"results.jsonl",root/"summary.json",options);
+    std::ifstream input(root/"summary.json");
+    const auto decoder=nlohmann::json::parse(input)["decoders"]["decoder"];
+    CHECK(decoder["cache_states"]==nlohmann::json::array({"both"}));
+    const auto& cold=decoder["cold_cache"];
+    CHECK(cold["records"]==2); CHECK(cold["mean_decode_ms"]==45.0); CHECK(cold["warm_mean_decode_ms"]==15.0);
+    CHECK(cold["cold_to_warm_ratio"]==3.0); CHECK(cold["median_decode_ms_ci95"].size()==2);
+    CHECK(decoder["mean_decode_ms"]==15.0);
+    input.close();
+    std::filesystem::remove_all(root);
+}
@@ -0,0 +1,111 @@
+#include "test_support.h"
+#include "cascade_decoder.h"
+#include "image_loader.h"
+#include "normalization.h"
+
+#include <array>
+#include <random>
+
+using namespace bench;
+
+namespace {
+// Finds one "wide" symbol on images at least `min_width` wide and one "any"
+// symbol on every image; narrower images below `fail_below` throw.
+class WidthDecoder final : public IDecoderAdapter {
+public:
+    WidthDecoder(int min_width, int fail_below=0, std::vector<int>* widths=nullptr)
+        : min_width_(min_width), fail_below_(fail_below), widths_(widths) {}
+    std::string name() const override { return "zxing-cpp"; }
+    std::string version() const override { return "1"; }
+    DecodeRun decode(const ImageBuffer& image) override
+    {
+        if(widths_)widths_->push_back(image.width);
+        if(image.width<fail_below_)throw std::runtime_error("too small");
+        DecodeRun run; run.decode_time=std::chrono::milliseconds(1); run.thread_cpu_time=std::chrono::microseconds(10);
+        if(image.width>=min_width_)run.results.push_back({"QR_CODE",{},"wide",std::nullopt,{{10,20},{image.width-1,0}}});
+        run.results.push_back({"CODE_128",{},"any",std::nullopt,{}});
+        return run;
+    }
+private:
+    int min_width_, fail_below_;
+    std::vector<int>* widths_;
+};
+
+ImageBuffer randomImage(int width,int height,int padding,std::uint32_t seed)
+{
+    std::mt19937 random(seed);
+    ImageBuffer image; image.width=width; image.height=height; image.stride=width*3+padding;
+    image.rgb.resize(static_cast<std::size_t>(image.stride)*height);
+    for(auto& value:image.rgb)value=static_cast<std::uint8_t>(random());
+    return image;
+}
+}
+
+void testCascadeDecoder()
+{
+    // The SIMD halving matches the scalar box filter, odd edges included.
+    for(const auto& [width,height,padding]:std::vector<std::array<int,3>>{{64,32,0},{67,41,0},{101,7,5},{1,1,0},{19,2,3}}){
+        const auto source=randomImage(width,height,padding,static_cast<std::uint32_t>(width*height));
+        ImageBuffer half;
+        halveImage(source,half);
+        auto reference=source; downscaleImage(reference,2);
+        CHECK(half.width==reference.width); CHECK(half.height==reference.height); CHECK(half.stride==reference.stride);
+        CHECK(half.rgb==reference.rgb);
+    }
+    ImageBuffer view; view.width=64; view.height=32; view.stride=192;
+    const auto pixels=randomImage(64,32,0,5);
+    view.view=pixels.rgb.data();
+    ImageBuffer half; halveImage(view,half);
+    auto reference=pixels; downscaleImage(reference,2);
+    CHECK(half.rgb==reference.rgb);
+
+    CHECK((parseCascadeLevels("4,2,1")==std::vector<int>{4,2,1}));
+    for(const char* bad:{"","2,4","3,1","4,4","x"}){
+        bool threw=false;
+        try { parseCascadeLevels(bad); } catch (const std::exception&) { threw=true; }
+        CHECK(threw);
+    }
+
+    // Escalates past 1/4 and stops at 1/2, mapping positions back.
+    const auto image=randomImage(256,128,0,1);
+    std::vector<int> widths;
+    CascadeDecoder cascade(std::make_unique<WidthDecoder>(128,0,&widths),{4,2,1},2);
+    CHECK(cascade.name()=="cascade:zxing-cpp"); CHECK(cascade.version()=="1");
+    auto run=cascade.decode(image);
+    CHECK((widths==std::vector<int>{64,128}));
+    CHECK(run.resolved_by=="1/2"); CHECK(!run.error); CHECK(run.results.size()==2);
+    CHECK(run.results[0].text=="any"); CHECK(run.results[1].text=="wide");
+    CHECK(run.results[1].position[0].x==20); CHECK(run.results[1].position[0].y==40); CHECK(run.results[1].position[1].x==254);
+    CHECK(run.decode_time>=std::chrono::milliseconds(2)); CHECK(run.thread_cpu_time>=std::chrono::microseconds(20));
+
+    // One symbol expected: the coarsest level answers, with positions at the
+    // centre of each 4x4 block.
+    widths.clear();
+    CascadeDecoder single(std::make_unique<WidthDecoder>(0,0,&widths),{4,2,1},1);
+    run=single.decode(image);
+    CHECK((widths==std::vector<int>{64})); CHECK(run.resolved_by=="1/4");
+    CHECK(run.results[0].position[0].x==41); CHECK(run.results[0].position[0].y==81);
+
+    // Never enough symbols: every level runs and duplicates are merged.
+    widths.clear();
+    CascadeDecoder greedy(std::make_unique<WidthDecoder>(1000,0,&widths),{4,2,1},2);
+    run=greedy.decode(image);
+    CHECK((widths==std::vector<int>{64,128,256})); CHECK(run.resolved_by=="none"); CHECK(run.results.size()==1);
+
+    // Levels too small to read are skipped, and a failing coarse level only
+    // escalates.
+    widths.clear();
+    CascadeDecoder tiny(std::make_unique<WidthDecoder>(0,0,&widths),{4,2,1},1);
+    run=tiny.decode(randomImage(40,40,0,2));
+    CHECK((widths==std::vector<int>{40})); CHECK(run.resolved_by=="1/1");
+    CascadeDecoder failing(std::make_unique<WidthDecoder>(0,100),{4,2,1},1);
+    run=failing.decode(image);
+    CHECK(run.resolved_by=="1/2"); CHECK(!run.error);
+    CascadeDecoder broken(std::make_unique<WidthDecoder>(0,1000),{2,1},1);
+    run=broken.decode(image);
+    CHECK(run.resolved_by=="none"); CHECK(run.error&&*run.error=="1/1: too small");
+
+    CHECK(isFormatSupported("cascade:zxing-cpp","QR_CODE"));
+    CHECK(isFormatSupported("cascade:dynamsoft-dbr:Speed","CODE_39")==isFormatSupported("dynamsoft-dbr","CODE_39"));
+    CHECK(!isFormatSupported("cascade","QR_CODE"));
+}
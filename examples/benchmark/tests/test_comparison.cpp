@@ -0,0 +1,94 @@
+#include "test_support.h"
+#include "comparison.h"
+#include "metrics.h"
+#include "result_writer.h"
+
+#include <cmath>
+#include <nlohmann/json.hpp>
+#include <fstream>
+
+using namespace bench;
+
+namespace {
+
+void writeRun(const std::filesystem::path& jsonl,double slowdown,int qr_misses,int repetitions=1,int first_repetition=0)
+{
+    for(int repetition=first_repetition;repetition<first_repetition+repetitions;++repetition)
+    for(int i=0;i<60;++i){
+        RawResultRecord record;record.decoder="decoder";record.repetition=repetition;
+        record.sample.sample_id="s"+std::to_string(i);
+        record.sample.ground_truth.push_back({"a",i%2?"QR_CODE":"EAN_13","x",{},std::nullopt,true,{}});
+        record.run.decode_time=std::chrono::nanoseconds(static_cast<std::int64_t>((1000000+i*10000)*slowdown));
+        const bool miss=i%2&&i/2<qr_misses;
+        record.matches.push_back({0,std::nullopt,miss?Outcome::NotFound:Outcome::Correct});
+        appendResult(jsonl,record);
+    }
+}
+
+}
+
+void testComparison()
+{
+    // Newcombe (1998) example: 56/70 vs 48/80 gives 0.2 [0.0524, 0.3339].
+    const auto interval=newcombeDifferenceInterval(48,80,56,70);
+    CHECK(std::abs(interval.first-0.0524)<0.001);CHECK(std::abs(interval.second-0.3339)<0.001);
+    CHECK(newcombeDifferenceInterval(0,0,1,1).first==0.0);
+
+    const auto all_up=wilcoxonSignedRank({1,2,3,4,5,6,7,8,9,10});
+    CHECK(all_up.nonzero==10);CHECK(all_up.w_plus==55);
+    CHECK(std::abs(all_up.z-2.752)<0.001);CHECK(std::abs(all_up.p_value-0.0059)<0.0005);
+    const auto ties=wilcoxonSignedRank({0,1,-1,2,-2,0});
+    CHECK(ties.nonzero==4);CHECK(ties.w_plus==5);CHECK(ties.z==0);CHECK(ties.p_value==1);
+    CHECK(wilcoxonSignedRank({}).p_value==1);
+
+    std::vector<double> values;for(int i=0;i<200;++i)values.push_back(i%17);
+    auto mean=[&](std::span<const std::size_t> indices){double sum=0;for(auto i:indices)sum+=values[i];return sum/double(indices.size());};
+    const auto ci=bootstrapInterval(values.size(),mean,500,3);
+    CHECK(ci.first<7.7&&ci.second>7.7);CHECK(ci==bootstrapInterval(values.size(),mean,500,3));
+
+    const auto root=std::filesystem::temp_directory_path()/"bench_comparison_test";
+    std::filesystem::remove_all(root);
+    writeRun(root/"base.jsonl",1.0,0);
+    writeRun(root/"same.jsonl",1.0,0);
+    writeRun(root/"slow.jsonl",1.2,15);
+    const auto same=compareResults(root/"base.jsonl",root/"same.jsonl");
+    CHECK(!same.regressed());CHECK(same.latency.size()==1);CHECK(same.latency[0].pairs==60);
+    CHECK(same.latency[0].relative_change==0.0);CHECK(same.latency[0].wilcoxon_p==1);
+
+    const auto slow=compareResults(root/"base.jsonl",root/"slow.jsonl");
+    CHECK(slow.regressed());CHECK(slow.latency[0].regressed);
+    CHECK(std::abs(slow.latency[0].relative_change-0.2)<1e-9);
+    CHECK(slow.latency[0].relative_change_ci95.first>0.19);
+    bool qr_regressed=false,ean_regressed=true;
+    for(const auto& item:slow.recall){
+        if(item.format=="QR_CODE"){qr_regressed=item.regressed;CHECK(item.candidate_correct==15);CHECK(item.baseline_correct==30);}
+        if(item.format=="EAN_13")ean_regressed=item.regressed;
+    }
+    CHECK(qr_regressed);CHECK(!ean_regressed);
+
+    // More repetitions of the same decoder are not more evidence about recall.
+    writeRun(root/"repeated.jsonl",1.0,15,8);
+    writeRun(root/"once.jsonl",1.0,15);
+    const auto repeated=compareResults(root/"once.jsonl",root/"repeated.jsonl");
+    CHECK(!repeated.regressed());CHECK(repeated.latency[0].pairs==60);
+    for(const auto& item:repeated.recall){
+        CHECK(item.candidate_eligible==item.baseline_eligible);CHECK(item.candidate_correct==item.baseline_correct);
+        CHECK(item.delta==0.0);
+    }
+    CHECK(repeated.recall.size()==3);
+    // A symbol read in one of two repetitions is half correct, not rounded up.
+    writeRun(root/"flaky.jsonl",1.0,0);writeRun(root/"flaky.jsonl",1.0,15,1,1);
+    const auto flaky=compareResults(root/"once.jsonl",root/"flaky.jsonl");
+    const auto base=compareResults(root/"base.jsonl",root/"flaky.jsonl");
+    for(const auto& item:flaky.recall)if(item.format=="QR_CODE"){CHECK(item.candidate_correct==22.5);CHECK(item.baseline_correct==15);CHECK(!item.regressed);}
+    for(const auto& item:base.recall)if(item.format=="QR_CODE"){CHECK(item.candidate_correct==22.5);CHECK(std::abs(item.delta+0.25)<1e-12);CHECK(item.regressed);}
+
+    ComparisonOptions lenient;lenient.latency_threshold=0.5;
+    CHECK(!compareResults(root/"base.jsonl",root/"slow.jsonl",lenient).latency[0].regressed);
+
+    writeComparison(slow,root/"comparison.json");
+    std::ifstream input(root/"comparison.json");
+    const auto document=nlohmann::json::parse(input);
+    CHECK(document["regressed"]==true);CHECK(document["latency"][0]["pairs"]==60);
+    std::filesystem::remove_all(root);
+}
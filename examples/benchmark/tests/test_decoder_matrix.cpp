@@ -0,0 +1,76 @@
+#include "test_support.h"
+#include "decoder_matrix.h"
+#include "normalization.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+using namespace bench;
+
+namespace {
+class NamedDecoder final : public IDecoderAdapter {
+public:
+    std::string name() const override { return "dynamsoft-dbr"; }
+    std::string version() const override { return "9"; }
+    DecodeRun decode(const ImageBuffer&) override { DecodeRun run; run.results.push_back({"QR_CODE",{},"x",std::nullopt}); return run; }
+    bool cancel() override { return true; }
+};
+
+bool throwsOn(const std::filesystem::path& path,const std::string& text)
+{
+    std::ofstream(path)<<text;
+    try { readDecoderMatrix(path); } catch (const std::exception&) { return true; }
+    return false;
+}
+}
+
+void testDecoderMatrix()
+{
+    const auto root=std::filesystem::temp_directory_path()/"barber_matrix_test";
+    std::filesystem::remove_all(root); std::filesystem::create_directories(root);
+    std::ofstream(root/"matrix.json")<<R"({"decoders":[
+        {"family":"dynamsoft-dbr","label":"Default"},
+        {"family":"dynamsoft-dbr","label":"SpeedFirst","template":"ReadBarcodes_SpeedFirst","config":"dbr.json"},
+        {"family":"zxing-cpp","config":"/abs/zxing.json"}]})";
+    const auto configs=readDecoderMatrix(root/"matrix.json");
+    CHECK(configs.size()==3);
+    CHECK(configs[0].name()=="dynamsoft-dbr:Default"); CHECK(configs[0].template_name=="ReadBarcodes_Default"); CHECK(configs[0].config.empty());
+    CHECK(configs[1].template_name=="ReadBarcodes_SpeedFirst"); CHECK(configs[1].config==root/"dbr.json");
+    CHECK(configs[2].name()=="zxing-cpp"); CHECK(configs[2].config=="/abs/zxing.json");
+    CHECK(throwsOn(root/"bad.json",R"({"decoders":[{"family":"zxing-cpp"},{"family":"zxing-cpp"}]})"));
+    CHECK(throwsOn(root/"bad.json",R"({"decoders":[{"family":"quagga"}]})"));
+    CHECK(throwsOn(root/"bad.json",R"({"decoders":[{"family":"zxing-cpp","label":"a|b"}]})"));
+    CHECK(throwsOn(root/"bad.json",R"({"decoders":[]})"));
+    CHECK(throwsOn(root/"bad.json",R"({"decoders":[{"family":"zxing-cpp","label":"a","config":"a.json"},{"family":"zxing-cpp","label":"b","config":"b.json"}]})"));
+    CHECK(!throwsOn(root/"good.json",R"({"decoders":[{"family":"zxing-cpp","label":"a","config":"a.json"},{"family":"zxing-cpp","label":"b","config":"a.json"}]})"));
+    std::filesystem::remove_all(root);
+
+    auto renamed=renameDecoder(std::make_unique<NamedDecoder>(),"dynamsoft-dbr:SpeedFirst");
+    CHECK(renamed->name()=="dynamsoft-dbr:SpeedFirst"); CHECK(renamed->version()=="9");
+    CHECK(renamed->decode({}).results.size()==1); CHECK(renamed->cancel()); CHECK(!renamed->setDeadline(std::chrono::milliseconds(5)));
+    CHECK(renameDecoder(std::make_unique<NamedDecoder>(),"dynamsoft-dbr")->name()=="dynamsoft-dbr");
+
+    CHECK(decoderFamily("dynamsoft-dbr:SpeedFirst")=="dynamsoft-dbr"); CHECK(decoderFamily("zxing-cpp")=="zxing-cpp");
+    CHECK(isFormatSupported("zxing-cpp:fast","CODE_128")); CHECK(!isFormatSupported("zxing-cpp:fast","POSTNET"));
+    CHECK(isFormatSupported("dynamsoft-dbr:SpeedFirst","POSTNET"));
+
+    // Two decoders keep the order of the original swap-on-odd shuffle.
+    for(int repetition=0;repetition<3;++repetition)
+        for(int i=0;i<200;++i){
+            const auto id="sample"+std::to_string(i);
+            std::mt19937 old(static_cast<unsigned>(std::hash<std::string>{}(id)^static_cast<std::size_t>(repetition)));
+            const auto order=decoderOrder(id,repetition,2);
+            CHECK(order[0]==((old()&1)?1u:0u));
+        }
+    std::vector<int> first(4,0);
+    for(int i=0;i<400;++i){
+        auto order=decoderOrder("s"+std::to_string(i),0,4);
+        ++first[order[0]];
+        std::sort(order.begin(),order.end());
+        CHECK((order==std::vector<std::size_t>{0,1,2,3}));
+    }
+    for(const int count:first)CHECK(count>60);
+    CHECK(decoderOrder("s",0,4)==decoderOrder("s",0,4)); CHECK(decoderOrder("s",0,0).empty());
+}
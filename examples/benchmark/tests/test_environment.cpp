@@ -0,0 +1,121 @@
+#include "test_support.h"
+#include "environment.h"
+#include "result_writer.h"
+
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+#ifdef __linux__
+#include <sched.h>
+#include <sys/resource.h>
+#endif
+
+using namespace bench;
+
+namespace {
+void writeFile(const std::filesystem::path& path,const std::string& text)
+{
+    std::filesystem::create_directories(path.parent_path());
+    std::ofstream(path)<<text;
+}
+}
+
+void testEnvironment()
+{
+    CHECK((parseCpuList("0-3, 8,2")==std::vector<int>{0,1,2,3,8}));
+    CHECK(parseCpuList("").empty());
+    bool rejected=false;
+    try { parseCpuList("4-2"); } catch (const std::exception&) { rejected=true; }
+    CHECK(rejected);
+
+    const auto root=std::filesystem::temp_directory_path()/"barber_environment_test";
+    std::filesystem::remove_all(root);
+    EnvironmentSources sources{root/"sys",root/"proc"};
+    writeFile(sources.proc/"cpuinfo",
+        "processor\t: 0\nmodel name\t: Test CPU @ 3.00GHz\nphysical id\t: 0\ncore id\t\t: 0\n\n"
+        "processor\t: 1\nmodel name\t: Test CPU @ 3.00GHz\nphysical id\t: 0\ncore id\t\t: 0\n\n"
+        "processor\t: 2\nmodel name\t: Test CPU @ 3.00GHz\nphysical id\t: 0\ncore id\t\t: 1\n\n");
+    writeFile(sources.proc/"meminfo","MemTotal:       16318480 kB\nMemFree: 1 kB\n");
+    const auto cpu=sources.sys/"devices/system/cpu";
+    writeFile(cpu/"cpu0/cpufreq/scaling_governor","powersave\n");
+    writeFile(cpu/"cpu1/cpufreq/scaling_governor","performance\n");
+    writeFile(cpu/"cpu2/cpufreq/scaling_governor","powersave\n");
+    writeFile(cpu/"cpu0/cpufreq/scaling_driver","intel_pstate\n");
+    writeFile(cpu/"intel_pstate/no_turbo","0\n");
+    writeFile(cpu/"smt/control","on\n");
+    writeFile(cpu/"isolated","2\n");
+    writeFile(cpu/"cpu0/topology/thread_siblings_list","0-1\n");
+    writeFile(cpu/"cpu1/topology/thread_siblings_list","0-1\n");
+    writeFile(cpu/"cpu2/topology/thread_siblings_list","2\n");
+
+    // Node 2 is memory-only and is left out.
+    const auto node=sources.sys/"devices/system/node";
+    writeFile(node/"node1/cpulist","1,2\n");
+    writeFile(node/"node1/meminfo","Node 1 MemFree:  10 kB\nNode 1 MemTotal:       2048 kB\n");
+    writeFile(node/"node0/cpulist","0\n");
+    writeFile(node/"node2/cpulist","\n");
+    writeFile(node/"possible","0-2\n");
+    const auto nodes=numaTopology(sources);
+    CHECK(nodes.size()==2); CHECK(nodes[0].id==0); CHECK(nodes[0].cpus==std::vector<int>{0}); CHECK(nodes[0].memory_bytes==0);
+    CHECK(nodes[1].id==1); CHECK((nodes[1].cpus==std::vector<int>{1,2})); CHECK(nodes[1].memory_bytes==2048*1024);
+    CHECK(numaTopology({root/"missing",root/"missing"}).empty());
+
+    const auto environment=captureEnvironment(sources);
+    CHECK(environment.contains("measured_at")); CHECK(environment.contains("compiler"));
+    CHECK(environment.contains("architecture")); CHECK(environment.contains("build_flags"));
+#ifdef __linux__
+    CHECK(environment["processor"]=="Test CPU @ 3.00GHz");
+    CHECK(environment["logical_processors"]==3); CHECK(environment["physical_cores"]==2);
+    CHECK(environment["memory_gb"]==15.6);
+    CHECK(environment["cpufreq_governors"]["powersave"]==2); CHECK(environment["cpufreq_governors"]["performance"]==1);
+    CHECK(environment["cpufreq_driver"]=="intel_pstate"); CHECK(environment["turbo"]=="enabled");
+    CHECK(environment["smt"]=="on"); CHECK(environment["isolated_cpus"]=="2"); CHECK(environment["numa_nodes"]==2);
+    const auto warnings=environmentWarnings(environment,{0,1,2},sources);
+    CHECK(warnings.size()==3);
+    CHECK(warnings[0].find("'powersave'")!=std::string::npos);
+    CHECK(warnings[1].find("turbo")!=std::string::npos);
+    CHECK(warnings[2].find("0 and 1")!=std::string::npos);
+    CHECK(environmentWarnings(environment,{0,2},sources).size()==2);
+#endif
+
+    auto later=environment; later["measured_at"]="2030-01-01T00:00:00+00:00";
+    CHECK(environmentHash(later)==environmentHash(environment));
+    later["run_controls"]={{"pin_cpus",{3}}};
+    CHECK(environmentHash(later)!=environmentHash(environment));
+
+    // The summary embeds environment.json and lists each record's hash.
+    writeFile(root/"run/environment.json",environment.dump());
+    RawResultRecord record; record.decoder="zxing-cpp"; record.environment_sha256=environmentHash(environment);
+    appendResult(root/"run/results.jsonl",record);
+    record.repetition=1; record.numa_node=1; record.run.decode_time=std::chrono::milliseconds(4);
+    appendResult(root/"run/results.jsonl",record);
+    SummaryOptions options; options.bootstrap_resamples=0;
+    generateSummary(root/"run/results.jsonl",root/"run/summary.json",options);
+    std::ifstream in(root/"run/summary.json");
+    const auto summary=nlohmann::json::parse(in);
+    CHECK(summary["environment_sha256"]==nlohmann::json::array({environmentHash(environment)}));
+    CHECK(summary["environment"]["compiler"]==environment["compiler"]);
+    // Only records bound to a node count towards its breakdown.
+    const auto& by_node=summary["decoders"]["zxing-cpp"]["by_numa_node"];
+    CHECK(by_node.size()==1); CHECK(by_node["1"]["records"]==1);
+    CHECK(by_node["1"]["mean_decode_ms"]==4.0);
+    std::filesystem::remove_all(root);
+
+#ifdef __linux__
+    // Scheduling controls apply to the calling thread only, so try them on a
+    // throwaway one.
+    cpu_set_t allowed; CPU_ZERO(&allowed);
+    CHECK(sched_getaffinity(0,sizeof allowed,&allowed)==0);
+    int first=0; while(!CPU_ISSET(first,&allowed))++first;
+    bool pinned=false,reniced=true;
+    std::thread([&]{
+        pinCurrentThread({first});
+        cpu_set_t now; CPU_ZERO(&now);
+        pinned=sched_getaffinity(0,sizeof now,&now)==0&&CPU_COUNT(&now)==1&&CPU_ISSET(first,&now);
+        const int before=getpriority(PRIO_PROCESS,0);
+        if(before<19){ setNice(before+1); reniced=getpriority(PRIO_PROCESS,0)==before+1; }
+    }).join();
+    CHECK(pinned); CHECK(reniced);
+#endif
+}
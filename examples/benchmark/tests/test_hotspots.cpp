@@ -0,0 +1,89 @@
+#include "test_support.h"
+#include "barber_dataset.h"
+#include "hotspots.h"
+#include "result_writer.h"
+
+#include <nlohmann/json.hpp>
+#include <fstream>
+#include <map>
+
+using namespace bench;
+
+void testHotspots()
+{
+    const auto root=std::filesystem::temp_directory_path()/"barber_hotspots_test";
+    std::filesystem::remove_all(root);
+    const auto jsonl=root/"results.jsonl";
+    // s0..s5 take i ms; s2 swings between 1 and 9 ms across repetitions.
+    auto write=[&](const std::string& decoder,int i,int repetition,double ms,const std::string& error=""){
+        RawResultRecord record; record.decoder=decoder; record.repetition=repetition;
+        if(!error.empty())record.run.error=error;
+        record.run.timed_out=error.rfind("decode_timeout",0)==0;
+        record.sample.sample_id="s"+std::to_string(i); record.sample.relative_path="img/"+std::to_string(i)+".jpg";
+        record.sample.stratum="QR|1"; record.sample.weight=3;
+        record.sample.ground_truth.push_back({"a",i<3?"QR_CODE":"EAN_13","x",{{1,2}},std::nullopt,true,{}});
+        record.run.decode_time=std::chrono::nanoseconds(static_cast<std::int64_t>(ms*1e6));
+        record.matches.push_back({0,std::nullopt,Outcome::Correct});
+        appendResult(jsonl,record);
+    };
+    for(int repetition=0;repetition<3;++repetition)
+        for(int i=0;i<6;++i){
+            write("zxing-cpp",i,repetition,i==2?(repetition==1?9.0:1.0):i);
+            write("dynamsoft-dbr",i,repetition,6.0-i);
+        }
+
+    HotspotOptions options; options.top=1;
+    const auto report=findHotspots(jsonl,options);
+    CHECK(report.records==36); CHECK(report.images==6); CHECK(report.decoders==2);
+    // zxing: s5 overall and for EAN_13, s1 for QR_CODE (tied with s2 at a
+    // 1 ms median, manifest order wins) and s2 as unstable; dbr: s0 overall
+    // and for QR_CODE, s3 for EAN_13.
+    std::map<std::string,const HotspotSample*> by_id;
+    for(const auto& sample:report.samples)by_id[sample.record.sample_id]=&sample;
+    CHECK(by_id.size()==5); CHECK(!by_id.count("s4"));
+    CHECK(report.samples[0].record.sample_id=="s0"); CHECK(report.samples[0].worst_median_ms==6.0);
+    CHECK(report.samples[0].reasons.size()==2);
+    const auto* s1=by_id["s1"];
+    CHECK(s1->reasons.size()==1); CHECK(s1->reasons[0].kind=="slowest_in_format"); CHECK(s1->reasons[0].format=="QR_CODE");
+    const auto* s2=by_id["s2"];
+    CHECK(s2->reasons.size()==1); CHECK(s2->reasons[0].kind=="unstable"); CHECK(s2->reasons[0].decoder=="zxing-cpp");
+    CHECK(s2->reasons[0].median_ms==1.0); CHECK(s2->reasons[0].cv>1.2); CHECK(s2->reasons[0].cv<1.3);
+    const auto* s5=by_id["s5"];
+    CHECK(s5->reasons.size()==2); CHECK(s5->reasons[0].kind=="slowest"); CHECK(s5->reasons[1].format=="EAN_13");
+    CHECK(s5->reasons[0].repetitions==3); CHECK(s5->reasons[0].cv==0.0);
+    CHECK(s5->record.stratum.empty()); CHECK(s5->record.weight==1.0);
+    CHECK(s5->record.relative_path=="img/5.jpg"); CHECK(s5->record.ground_truth.at(0).polygon.size()==1);
+
+    // A higher threshold or too few repetitions flag nothing as unstable.
+    for(const auto& [threshold,repetitions]:std::vector<std::pair<double,std::size_t>>{{1.5,3},{0.25,4}}){
+        auto strict=options; strict.cv_threshold=threshold; strict.min_repetitions=repetitions;
+        const auto quiet=findHotspots(jsonl,strict);
+        CHECK(quiet.samples.size()==4);
+        for(const auto& sample:quiet.samples)for(const auto& reason:sample.reasons)CHECK(reason.kind!="unstable");
+    }
+
+    // The export reads back as a manifest.
+    std::vector<ManifestRecord> records;
+    for(const auto& sample:report.samples)records.push_back(sample.record);
+    BarberDataset::writeManifest(root/"hot.jsonl",records);
+    const auto reread=BarberDataset::readManifest(root/"hot.jsonl");
+    CHECK(reread.size()==5); CHECK(reread[0].sample_id==report.samples[0].record.sample_id);
+    writeHotspotReport(report,options,root/"hot.reasons.json");
+    std::ifstream in(root/"hot.reasons.json");
+    const auto written=nlohmann::json::parse(in);
+    CHECK(written["samples"].size()==5); CHECK(written["records"]==36);
+
+    // Errored repetitions carry no real decode time and are left out, so s0
+    // stays dbr's slowest and is not flagged unstable; a timeout counts.
+    for(int repetition=3;repetition<7;++repetition)write("dynamsoft-dbr",0,repetition,0.0,"decoder_error: broken");
+    write("dynamsoft-dbr",3,3,100.0,"decode_timeout: exceeded 100 ms");
+    const auto failed=findHotspots(jsonl,options);
+    CHECK(failed.records==41); CHECK(failed.samples[0].record.sample_id=="s0"); CHECK(failed.samples[0].reasons.size()==2);
+    for(const auto& reason:failed.samples[0].reasons){CHECK(reason.repetitions==3); CHECK(reason.kind!="unstable");}
+    bool timeout_unstable=false;
+    for(const auto& sample:failed.samples)
+        for(const auto& reason:sample.reasons)
+            if(sample.record.sample_id=="s3"&&reason.kind=="unstable")timeout_unstable=reason.repetitions==4;
+    CHECK(timeout_unstable);
+    std::filesystem::remove_all(root);
+}
@@ -0,0 +1,36 @@
+#include "test_support.h"
+#include "image_loader.h"
+
+using namespace bench;
+
+void testImageLoader()
+{
+    // 2x2 RGB: red, green / blue, white.
+    const std::uint8_t png[]={137,80,78,71,13,10,26,10,0,0,0,13,73,72,68,82,0,0,0,2,0,0,0,2,8,2,0,0,0,253,212,154,115,0,0,0,18,73,68,65,84,120,218,99,248,207,192,192,0,194,12,255,129,0,0,31,238,5,251,241,171,186,119,0,0,0,0,73,69,78,68,174,66,96,130};
+    std::string error;
+    for(const auto& name:availableImageLoaders()){
+        ImageBuffer image;
+        auto loader=createImageLoader(name,1);
+        CHECK(loader->name()==name);
+        const bool decoded=loader->decode(png,image,error);
+        if(!decoded)throw std::runtime_error(name+": "+error);
+        CHECK(image.width==2); CHECK(image.height==2); CHECK(image.rgb.size()==12);
+        CHECK(image.rgb[0]==255); CHECK(image.rgb[4]==255); CHECK(image.rgb[8]==255); CHECK(image.rgb[11]==255);
+        ImageBuffer half;
+        CHECK(createImageLoader(name,2)->decode(png,half,error));
+        CHECK(half.width==1); CHECK(half.height==1); CHECK(half.rgb[0]==128);
+    }
+    ImageBuffer broken;
+    const std::uint8_t garbage[]={0xff,0xd8,0xff,0x00,0x01};
+    CHECK(!createImageLoader("stb",1)->decode(garbage,broken,error));
+    bool threw=false;
+    try { createImageLoader("stb",3); } catch (const std::exception&) { threw=true; }
+    CHECK(threw);
+
+    ImageBuffer image; image.width=3; image.height=2; image.stride=9;
+    image.rgb={0,0,0, 10,10,10, 90,90,90,
+               20,20,20, 30,30,30, 91,91,91};
+    downscaleImage(image,2);
+    CHECK(image.width==2); CHECK(image.height==1); CHECK(image.stride==6);
+    CHECK(image.rgb[0]==15); CHECK(image.rgb[3]==91);
+}
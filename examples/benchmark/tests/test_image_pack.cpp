@@ -0,0 +1,73 @@
+#include "test_support.h"
+#include "hash.h"
+#include "image_loader.h"
+#include "image_pack.h"
+
+#include <fstream>
+
+using namespace bench;
+
+void testImagePack()
+{
+    const auto root=std::filesystem::temp_directory_path()/"barber_image_pack_test";
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root/"images/sub");
+    const std::vector<std::pair<std::string,std::string>> files{{"a.jpg","first image"},{"sub/b.png",std::string(5000,'b')},{"c.jpg","first image"}};
+    std::vector<ManifestRecord> records;
+    for(const auto& [path,content]:files){
+        std::ofstream(root/"images"/path,std::ios::binary)<<content;
+        ManifestRecord record; record.sample_id="id:"+path; record.relative_path=path; record.image_sha256=sha256(content);
+        records.push_back(record);
+    }
+
+    const auto summary=writeImagePack(root/"images",records,root/"set.pack");
+    CHECK(summary.images==3); CHECK(summary.blobs==2); CHECK(summary.image_bytes==11+5000);
+    CHECK(summary.file_bytes==std::filesystem::file_size(root/"set.pack")); CHECK(!std::filesystem::exists(root/"set.pack.partial"));
+    {
+        ImagePack pack(root/"set.pack");
+        CHECK(pack.size()==3); CHECK(pack.find("missing")==nullptr);
+        const auto* b=pack.find("id:sub/b.png");
+        CHECK(b && b->offset%kImagePackAlignment==0); CHECK(b->length==5000); CHECK(b->relative_path=="sub/b.png");
+        pack.prefetch(*b);
+        const auto bytes=pack.bytes(*b);
+        CHECK(std::string(bytes.begin(),bytes.end())==files[1].second);
+        // Duplicate images share one blob.
+        CHECK(pack.find("id:a.jpg")->offset==pack.find("id:c.jpg")->offset);
+        pack.checkManifest(records);
+        CHECK(pack.verify(records)==2);
+
+        auto stale=records; stale[0].image_sha256=sha256("other");
+        bool rejected=false;
+        try { pack.checkManifest(stale); } catch (const std::exception&) { rejected=true; }
+        CHECK(rejected);
+        auto extra=records; extra.push_back(records[0]); extra.back().sample_id="id:new";
+        rejected=false;
+        try { pack.checkManifest(extra); } catch (const std::exception&) { rejected=true; }
+        CHECK(rejected);
+    }
+
+    // A flipped byte in a blob is caught by verify(), not by the index check.
+    {
+        std::fstream file(root/"set.pack",std::ios::binary|std::ios::in|std::ios::out);
+        file.seekp(static_cast<std::streamoff>(kImagePackAlignment)+3); file.put('X');
+    }
+    {
+        ImagePack pack(root/"set.pack");
+        pack.checkManifest(records);
+        bool rejected=false;
+        try { pack.verify(records); } catch (const std::exception&) { rejected=true; }
+        CHECK(rejected);
+    }
+
+    // Packing refuses an image that no longer matches the manifest.
+    std::ofstream(root/"images/a.jpg",std::ios::binary)<<"edited";
+    bool rejected=false;
+    try { writeImagePack(root/"images",records,root/"bad.pack"); } catch (const std::exception&) { rejected=true; }
+    CHECK(rejected); CHECK(!std::filesystem::exists(root/"bad.pack"));
+
+    std::ofstream(root/"junk.pack",std::ios::binary)<<std::string(100,'j');
+    rejected=false;
+    try { ImagePack junk(root/"junk.pack"); } catch (const std::exception&) { rejected=true; }
+    CHECK(rejected);
+    std::filesystem::remove_all(root);
+}
@@ -0,0 +1,105 @@
+#include "test_support.h"
+
+// Forked workers and memfd images are Linux features.
+#ifndef __linux__
+void testIsolatedDecoder() {}
+#else
+#include "cascade_decoder.h"
+#include "decode_watchdog.h"
+#include "isolated_decoder.h"
+
+#include <algorithm>
+#include <csignal>
+#include <thread>
+#include <unistd.h>
+
+using namespace bench;
+
+namespace {
+// Reads the first pixel byte: 1 crashes the worker, 2 hangs it, anything
+// else is echoed back together with the worker's pid.
+class PixelDecoder final : public IDecoderAdapter {
+public:
+    std::string name() const override { return "pixel"; }
+    std::string version() const override { return "pid-"+std::to_string(::getpid()); }
+    DecodeRun decode(const ImageBuffer& image) override
+    {
+        DecodeRun run;
+        const std::uint8_t first=image.size()?image.data()[0]:0;
+        if(first==1)::raise(SIGKILL);
+        if(first==2)std::this_thread::sleep_for(std::chrono::seconds(30));
+        run.results.push_back({"QR_CODE",{first,image.data()[image.size()-1]},std::to_string(::getpid()),0.5,{{first,2},{3,4}}});
+        run.decode_time=std::chrono::nanoseconds(123);
+        run.error=deadline_?std::optional<std::string>("deadline="+std::to_string(deadline_->count())):std::nullopt;
+        return run;
+    }
+    bool setDeadline(std::chrono::milliseconds timeout) override { deadline_=timeout; return true; }
+private:
+    std::optional<std::chrono::milliseconds> deadline_;
+};
+
+ImageBuffer image(std::uint8_t first,int width)
+{
+    ImageBuffer result; result.width=width; result.height=2; result.stride=width*3;
+    result.rgb.assign(static_cast<std::size_t>(result.stride)*result.height,7);
+    result.rgb[0]=first;
+    return result;
+}
+}
+
+void testIsolatedDecoder()
+{
+    auto shared=std::make_shared<SharedImageBuffer>();
+    IsolatedDecoder decoder([]{return std::make_unique<PixelDecoder>();},shared);
+    CHECK(decoder.name()=="pixel"); CHECK(decoder.version()!="pid-"+std::to_string(::getpid()));
+
+    auto staged=shared->stage(image(9,4));
+    CHECK(shared->holds(staged)); CHECK(staged.rgb.empty()); CHECK(staged.size()==24); CHECK(staged.data()[0]==9);
+    auto run=decoder.decode(staged);
+    CHECK(!run.error); CHECK(run.decode_time.count()==123); CHECK(run.results.size()==1);
+    CHECK((run.results[0].raw_bytes==std::vector<std::uint8_t>{9,7})); CHECK(run.results[0].confidence==0.5);
+    CHECK(run.results[0].position.size()==2); CHECK(run.results[0].position[0].x==9); CHECK(run.results[0].position[1].y==4);
+    const auto worker=run.results[0].text;
+    CHECK(worker!=std::to_string(::getpid()));
+
+    // An unstaged image is copied in, and a larger one grows the shared region.
+    run=decoder.decode(image(5,4000));
+    CHECK(run.results.size()==1); CHECK(run.results[0].raw_bytes[0]==5); CHECK(run.results[0].text==worker);
+
+    // A crash fails only that sample; the next one runs in a fresh worker.
+    run=decoder.decode(image(1,4));
+    CHECK(run.error && run.error->find("decoder_crash")==0); CHECK(!run.timed_out); CHECK(run.results.empty());
+    CHECK(run.decode_time.count()>0);
+    CHECK(decoder.setDeadline(std::chrono::milliseconds(40)));
+    run=decoder.decode(image(3,4));
+    CHECK(run.results.size()==1); CHECK(run.results[0].text!=worker); CHECK(decoder.restarts()==1);
+    CHECK(run.error=="deadline=40");
+
+    // cancel() kills a hung worker, and the deadline survives the restart.
+    DecodeWatchdog watchdog(std::chrono::milliseconds(50));
+    const auto begin=std::chrono::steady_clock::now();
+    run=watchdog.decode(decoder,image(2,4));
+    CHECK(run.timed_out); CHECK(std::chrono::steady_clock::now()-begin<std::chrono::seconds(5));
+    CHECK(run.decode_time>=std::chrono::milliseconds(50));
+    CHECK(watchdog.cancelled()==1);
+    run=decoder.decode(image(4,4));
+    CHECK(run.results.size()==1); CHECK(run.error=="deadline=40"); CHECK(decoder.restarts()==2);
+
+    // A cascade over a worker with its own buffer decodes its pyramid levels
+    // without touching the runner's staged image, which later decoders read.
+    auto full=image(200,64); full.height=64; full.rgb.assign(static_cast<std::size_t>(full.stride)*full.height,7); full.rgb[0]=200;
+    const auto shared_full=shared->stage(full);
+    CascadeDecoder cascade(std::make_unique<IsolatedDecoder>([]{return std::make_unique<PixelDecoder>();},std::make_shared<SharedImageBuffer>()),{4,2,1},5);
+    run=cascade.decode(shared_full);
+    CHECK(run.resolved_by=="none"); CHECK(run.results.size()==1);
+    CHECK(shared->holds(shared_full)); CHECK(shared_full.data()[0]==200);
+    CHECK(std::equal(full.rgb.begin(),full.rgb.end(),shared_full.data()));
+    run=decoder.decode(shared_full);
+    CHECK(run.results.size()==1); CHECK(run.results[0].raw_bytes[0]==200);
+
+    bool threw=false;
+    try { IsolatedDecoder broken([]()->std::unique_ptr<IDecoderAdapter>{throw std::runtime_error("no license");},shared); }
+    catch (const std::exception& e) { threw=std::string(e.what())=="no license"; }
+    CHECK(threw);
+}
+#endif
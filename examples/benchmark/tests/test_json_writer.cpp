@@ -0,0 +1,59 @@
+#include "test_support.h"
+#include "json_writer.h"
+#include "result_writer.h"
+#include <nlohmann/json.hpp>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+using namespace bench;
+using json=nlohmann::json;
+
+void testJsonWriter()
+{
+    std::string buffer;
+    JsonWriter out(buffer);
+    std::vector<std::uint8_t> bytes;
+    for(int i=0;i<37;++i)bytes.push_back(static_cast<std::uint8_t>(i*7));
+    const std::string text="plain ascii long enough for a vector pass \"quoted\" \\ tab\t newline\n bell\x07 ünï 日本";
+    out.beginObject().field("text",text).field("count",42).field("big",static_cast<unsigned long long>(1)<<63)
+       .field("negative",-5LL).field("ratio",0.25).field("whole",2.0).field("flag",true)
+       .field("missing",std::optional<double>{}).key("hex").hexValue(bytes)
+       .key("list").beginArray().value(1).beginObject().endObject().beginArray().endArray().null().endArray()
+       .endObject();
+    const auto value=json::parse(buffer);
+    CHECK(value["text"]==text); CHECK(value["count"]==42); CHECK(value["big"].get<std::uint64_t>()==(std::uint64_t{1}<<63));
+    CHECK(value["negative"]==-5); CHECK(value["ratio"]==0.25); CHECK(value["whole"].is_number_float());
+    CHECK(value["flag"]==true); CHECK(value["missing"].is_null()); CHECK(value["list"].size()==4);
+    std::string expected;
+    for(auto b:bytes){ static const char d[]="0123456789abcdef"; expected+=d[b>>4]; expected+=d[b&15]; }
+    CHECK(value["hex"]==expected);
+
+    buffer.clear();
+    JsonWriter invalid(buffer);
+    invalid.value(std::string_view("ok\xff\xc3(\xed\xa0\x80" "end"));
+    CHECK(json::parse(buffer)=="ok\xef\xbf\xbd\xef\xbf\xbd(\xef\xbf\xbd\xef\xbf\xbd\xef\xbf\xbd" "end");
+
+    const auto root=std::filesystem::temp_directory_path()/"barber_json_writer_test";
+    std::filesystem::remove_all(root);
+    RawResultRecord record; record.sample.sample_id="sample"; record.decoder="decoder";
+    record.sample.ground_truth.push_back({"a","EAN_13","0012345678905",{{1,2},{3,4}},2.5,true,{}});
+    record.run.results.push_back({"EAN_13",{0x30,0x31},"01",0.5});
+    record.matches.push_back({0,0,Outcome::Correct});
+    appendResult(root/"results.jsonl",record);
+    record.repetition=1; record.run.error="failure";
+    appendResult(root/"results.jsonl",record);
+    generateSummary(root/"results.jsonl",root/"summary.json");
+    generateResultsJson(root/"results.jsonl",root/"summary.json",root/"results.json");
+    std::ifstream input(root/"results.json");
+    const auto results=json::parse(input);
+    CHECK(results["records"].size()==2);
+    CHECK(results["records"][0]["ground_truth"][0]["polygon"][1][0]==3);
+    CHECK(results["records"][0]["predictions"][0]["raw_bytes_hex"]=="3031");
+    CHECK(results["records"][1]["error"]=="failure");
+    CHECK(results["summary"]["decoders"]["decoder"]["records"]==2);
+    CHECK(results["summary"]["decoders"]["decoder"]["by_ppe"]["2-3"]["correct"]==2);
+    CHECK(results["summary"]["decoders"]["decoder"]["by_megapixels"]["<0.5"]["records"]==2);
+    input.close();
+    std::filesystem::remove_all(root);
+}
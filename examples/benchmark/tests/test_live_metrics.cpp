@@ -0,0 +1,76 @@
+#include "test_support.h"
+
+// The scrape uses POSIX sockets; Windows builds skip this test.
+#ifdef _WIN32
+void testLiveMetrics() {}
+#else
+#include "live_metrics.h"
+
+#include <arpa/inet.h>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace bench;
+
+namespace {
+std::string scrape(int port,const std::string& path)
+{
+    const int fd=::socket(AF_INET,SOCK_STREAM,0);
+    sockaddr_in address{}; address.sin_family=AF_INET; address.sin_port=htons(static_cast<std::uint16_t>(port));
+    address.sin_addr.s_addr=htonl(INADDR_LOOPBACK);
+    CHECK(::connect(fd,reinterpret_cast<sockaddr*>(&address),sizeof address)==0);
+    const auto request="GET "+path+" HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    CHECK(::send(fd,request.data(),request.size(),0)==static_cast<ssize_t>(request.size()));
+    std::string response; char buffer[4096];
+    for(ssize_t n;(n=::recv(fd,buffer,sizeof buffer,0))>0;)response.append(buffer,static_cast<std::size_t>(n));
+    ::close(fd);
+    return response;
+}
+}
+
+void testLiveMetrics()
+{
+    const auto root=std::filesystem::temp_directory_path()/"barber_live_metrics_test";
+    std::filesystem::remove_all(root); std::filesystem::create_directories(root);
+    LiveMetricsOptions options; options.textfile=root/"bench.prom"; options.http_port=0;
+    options.interval=std::chrono::milliseconds(20); options.latency_window=4;
+    {
+        LiveMetrics metrics(10,options);
+        CHECK(metrics.port()>0);
+        metrics.sampleDone(true);
+        for(int i=1;i<=6;++i)metrics.record("zxing-cpp",i*1000000LL,i%2,1,i==6,i==6);
+        metrics.record("dbr \"x\"",5000000,2,2,false,false);
+        metrics.sampleDone(); metrics.sampleDone();
+        const auto text=metrics.render();
+        CHECK(text.find("bench_samples 10\n")!=std::string::npos);
+        CHECK(text.find("bench_samples_done 3\n")!=std::string::npos);
+        CHECK(text.find("bench_decodes_total{decoder=\"zxing-cpp\"} 6\n")!=std::string::npos);
+        CHECK(text.find("bench_decode_errors_total{decoder=\"zxing-cpp\"} 1\n")!=std::string::npos);
+        CHECK(text.find("bench_recall{decoder=\"zxing-cpp\"} 0.5\n")!=std::string::npos);
+        CHECK(text.find("bench_recall{decoder=\"dbr \\\"x\\\"\"} 1\n")!=std::string::npos);
+        // The window holds the last four calls (3..6 ms).
+        CHECK(text.find("bench_decode_latency_seconds{decoder=\"zxing-cpp\",quantile=\"0.5\"} 0.004\n")!=std::string::npos);
+        CHECK(text.find("bench_decode_latency_seconds{decoder=\"zxing-cpp\",quantile=\"0.99\"} 0.005\n")!=std::string::npos);
+        CHECK(text.find("bench_decode_latency_seconds_count{decoder=\"zxing-cpp\"} 6\n")!=std::string::npos);
+        CHECK(text.find("bench_eta_seconds ")!=std::string::npos);
+        metrics.setRemainingMax(7);
+        CHECK(metrics.render().find("bench_samples_max 10\n")!=std::string::npos);CHECK(metrics.render().find("bench_samples ")==std::string::npos);
+
+        const auto response=scrape(metrics.port(),"/metrics");
+        CHECK(response.rfind("HTTP/1.1 200 OK\r\n",0)==0);
+        CHECK(response.find("bench_samples_done 3\n")!=std::string::npos);
+        CHECK(scrape(metrics.port(),"/other").rfind("HTTP/1.1 404",0)==0);
+        for(int i=0;i<100&&!std::filesystem::exists(options.textfile);++i)std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        CHECK(std::filesystem::exists(options.textfile));
+        for(int i=0;i<7;++i)metrics.sampleDone();
+    }
+    std::ifstream input(options.textfile); std::stringstream text; text<<input.rdbuf();
+    CHECK(text.str().find("bench_samples_done 10\n")!=std::string::npos);
+    CHECK(text.str().find("bench_eta_seconds 0\n")!=std::string::npos);
+    input.close();
+    std::filesystem::remove_all(root);
+}
+#endif
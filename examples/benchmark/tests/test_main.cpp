@@ -3,7 +3,7 @@
 
 int main()
 {
-    try { testMatching(); testMetrics(); testBarberParser(); }
+    try { testMatching(); testMetrics(); testBarberParser(); testImageLoader(); testJsonWriter(); testWatchdog(); testSyntheticCorpus(); testComparison(); testRecordKeys(); testTrace(); testIsolatedDecoder(); testCacheEvictor(); testLiveMetrics(); testDecoderMatrix(); testSubset(); testEnvironment(); testResourceProfile(); testRacingDecoder(); testCascadeDecoder(); testHotspots(); testAdaptiveRepetitions(); testImagePack(); }
     catch (const std::exception& e) { std::cerr << e.what() << '\n'; return 1; }
     std::cout << "All benchmark tests passed\n";
     return 0;
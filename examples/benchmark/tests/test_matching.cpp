@@ -31,6 +31,8 @@ void testMatching()
     CHECK(matches[0].outcome==Outcome::Correct);
 
     CHECK(normalizedPayload("CODE_39","*8974589*") == "8974589");
+    CHECK(canonicalFormat("Code93") == "CODE_93");
+    CHECK(normalizedPayload("Codabar","A40156B") == "40156"); CHECK(normalizedPayload("CODABAR","40156") == "40156");
     CHECK(normalizedPayload("CODE_128","{GS}8952180") == "8952180");
     CHECK(normalizedPayload("QR_CODE","t=1&amp;s=2\n") == "t=1&s=2");
     CHECK(normalizedPayload("QR_CODE","\\000001https://example") == "https://example");
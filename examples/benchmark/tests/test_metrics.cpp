@@ -1,6 +1,8 @@
 #include "test_support.h"
 #include "metrics.h"
+#include "resource_usage.h"
 #include "result_writer.h"
+#include <algorithm>
 #include <cmath>
 #include <filesystem>
 #include <fstream>
@@ -14,6 +16,46 @@ void testMetrics()
     CHECK(std::abs(ci.second-0.5962)<0.001);
     CHECK(wilsonInterval(0,0).first==0.0);
 
+    LatencyHistogram histogram;
+    for(std::int64_t i=1;i<=10000;++i)histogram.add(i*1000);
+    CHECK(histogram.count()==10000);
+    CHECK(std::abs(double(histogram.quantile(0.5))-5000000.0)/5000000.0<0.04);
+    CHECK(std::abs(double(histogram.quantile(0.99))-9900000.0)/9900000.0<0.04);
+    CHECK(histogram.quantile(0.0)>=1000*0.96);
+    const std::vector<double> edges{1,2,4};
+    CHECK(bucketIndex(edges,0.5)==0); CHECK(bucketIndex(edges,1)==1); CHECK(bucketIndex(edges,3.9)==2); CHECK(bucketIndex(edges,9)==3);
+    CHECK(bucketLabel(edges,0)=="<1"); CHECK(bucketLabel(edges,2)=="2-4"); CHECK(bucketLabel(edges,3)==">=4");
+    CHECK(parseBucketEdges("0.5,1,2").size()==3);
+    const auto midpoints=histogram.values();
+    CHECK(midpoints.size()==10000); CHECK(std::is_sorted(midpoints.begin(),midpoints.end()));
+    CHECK(midpoints[5000]==histogram.quantile(0.5));
+
+    // Counting bootstrap: intervals bracket the point estimates and do not
+    // depend on how many threads produced the replicates.
+    std::vector<std::int64_t> latencies;
+    for(std::int64_t i=0;i<20000;++i)latencies.push_back(1000000+(i*7919)%5000000);
+    std::sort(latencies.begin(),latencies.end());
+    const std::vector<double> quantiles{0.95,0.5};
+    const auto single=bootstrapLatency(latencies,quantiles,200,9,1);
+    const auto parallel=bootstrapLatency(latencies,quantiles,200,9,4);
+    CHECK(single.mean==parallel.mean); CHECK(single.quantiles==parallel.quantiles);
+    double mean=0; for(auto v:latencies)mean+=double(v); mean/=double(latencies.size());
+    CHECK(single.mean.first<=mean&&mean<=single.mean.second);
+    CHECK(single.mean.second-single.mean.first<0.05*mean);
+    const double median=double(latencies[static_cast<std::size_t>(0.5*double(latencies.size()-1))]);
+    CHECK(single.quantiles[1].first<=median&&median<=single.quantiles[1].second);
+    CHECK(single.quantiles[0].first>single.quantiles[1].second);
+    CHECK(bootstrapLatency({},quantiles).quantiles.size()==2);
+    const std::vector<std::int64_t> constant(50,7);
+    CHECK(bootstrapLatency(constant,quantiles,100).quantiles[0]==std::make_pair(7.0,7.0));
+
+    const auto before=captureResources();
+    volatile double sink=0;
+    for(int i=0;i<2000000;++i)sink=sink+i*0.5;
+    DecodeRun run; recordResourceDelta(run,before,captureResources());
+    CHECK(run.thread_cpu_time.count()>0); CHECK(run.process_cpu_time.count()>0);
+    CHECK(run.voluntary_context_switches>=0);
+
     const auto root=std::filesystem::temp_directory_path()/"barber_result_writer_test";
     std::filesystem::remove_all(root);
     RawResultRecord record; record.sample.sample_id="sample"; record.decoder="decoder";
@@ -23,5 +65,12 @@ void testMetrics()
     while(std::getline(input,line))if(!line.empty())++lines;
     CHECK(lines==1);
     input.close();
+    generateSummary(root/"results.jsonl",root/"summary.json");
+    std::ifstream summary_input(root/"summary.json");
+    const auto summary=nlohmann::json::parse(summary_input);
+    const auto& decoder=summary["decoders"]["decoder"];
+    CHECK(decoder["p95_decode_ms_ci95"].size()==2); CHECK(decoder["mean_decode_ms_ci95"][0]==0.0);
+    CHECK(decoder["by_megapixels"]["<0.5"].contains("median_decode_ms_ci95"));
+    summary_input.close();
     std::filesystem::remove_all(root);
 }
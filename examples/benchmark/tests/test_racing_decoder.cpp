@@ -0,0 +1,139 @@
+#include "test_support.h"
+#include "normalization.h"
+#include "racing_decoder.h"
+#include "result_writer.h"
+
+#include <nlohmann/json.hpp>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+using namespace bench;
+using namespace std::chrono_literals;
+
+namespace {
+// Sleeps for `delay` in small steps, then answers with `found` results.
+// A cancellable member stops early and returns an error instead.
+class TimedDecoder final : public IDecoderAdapter {
+public:
+    TimedDecoder(std::string name, std::chrono::milliseconds delay, int found, bool cancellable, bool fails=false)
+        : name_(std::move(name)), delay_(delay), found_(found), cancellable_(cancellable), fails_(fails) {}
+    std::string name() const override { return name_; }
+    std::string version() const override { return "v-"+name_; }
+    DecodeRun decode(const ImageBuffer& image) override
+    {
+        cancelled_=false;
+        const auto end=std::chrono::steady_clock::now()+delay_;
+        DecodeRun run;
+        while(std::chrono::steady_clock::now()<end){
+            if(cancelled_){ run.error="cancelled"; return run; }
+            std::this_thread::sleep_for(1ms);
+        }
+        if(fails_){ run.error="broken"; return run; }
+        for(int i=0;i<found_;++i)run.results.push_back({"QR_CODE",{},name_+std::to_string(image.width),std::nullopt});
+        run.thread_cpu_time=5ns;
+        return run;
+    }
+    bool cancel() override { if(!cancellable_)return false; cancelled_=true; ++*cancels; return true; }
+    std::shared_ptr<std::atomic<int>> cancels=std::make_shared<std::atomic<int>>(0);
+private:
+    std::string name_;
+    std::chrono::milliseconds delay_;
+    int found_;
+    bool cancellable_, fails_;
+    std::atomic<bool> cancelled_{false};
+};
+
+std::unique_ptr<RacingDecoder> race(std::unique_ptr<TimedDecoder> a,std::unique_ptr<TimedDecoder> b,bool cancel_losers=true)
+{
+    std::vector<std::unique_ptr<IDecoderAdapter>> members;
+    members.push_back(std::move(a)); members.push_back(std::move(b));
+    return std::make_unique<RacingDecoder>(std::move(members),cancel_losers);
+}
+}
+
+void testRacingDecoder()
+{
+    ImageBuffer image; image.width=7; image.height=1; image.stride=21; image.rgb.assign(21,0);
+
+    // The fast answer wins and the slow member is cancelled.
+    auto slow=std::make_unique<TimedDecoder>("dynamsoft-dbr",2000ms,1,true);
+    const auto cancels=slow->cancels;
+    auto racer=race(std::make_unique<TimedDecoder>("zxing-cpp",20ms,2,true),std::move(slow));
+    CHECK(racer->name()=="race:zxing-cpp+dynamsoft-dbr"); CHECK(racer->version()=="v-zxing-cpp+v-dynamsoft-dbr");
+    auto begin=std::chrono::steady_clock::now();
+    auto run=racer->decode(image);
+    CHECK(std::chrono::steady_clock::now()-begin<1500ms);
+    CHECK(run.resolved_by=="zxing-cpp"); CHECK(run.results.size()==2); CHECK(run.results[0].text=="zxing-cpp7");
+    CHECK(!run.error); CHECK(*cancels==1);
+    CHECK(run.decode_time>=20ms); CHECK(run.decode_time<1000ms); CHECK(run.thread_cpu_time==5ns);
+    CHECK(run.wall_time>=run.decode_time);
+    // The lanes are reusable for the next image.
+    run=racer->decode(image);
+    CHECK(run.resolved_by=="zxing-cpp"); CHECK(*cancels==2);
+
+    // An empty fast answer does not win; the slower member's results do.
+    racer=race(std::make_unique<TimedDecoder>("zxing-cpp",5ms,0,true),std::make_unique<TimedDecoder>("dynamsoft-dbr",40ms,1,true));
+    run=racer->decode(image);
+    CHECK(run.resolved_by=="dynamsoft-dbr"); CHECK(run.results.size()==1); CHECK(run.decode_time>=40ms);
+
+    // A member that cannot be cancelled is waited for but does not set the latency.
+    racer=race(std::make_unique<TimedDecoder>("zxing-cpp",300ms,1,false),std::make_unique<TimedDecoder>("dynamsoft-dbr",10ms,1,true));
+    begin=std::chrono::steady_clock::now();
+    run=racer->decode(image);
+    CHECK(std::chrono::steady_clock::now()-begin>=300ms);
+    CHECK(run.resolved_by=="dynamsoft-dbr"); CHECK(run.decode_time<250ms); CHECK(run.wall_time>=300ms);
+
+    // With cancel_losers off, a cancellable loser is left to finish too.
+    auto left=std::make_unique<TimedDecoder>("zxing-cpp",150ms,1,true);
+    const auto left_cancels=left->cancels;
+    racer=race(std::move(left),std::make_unique<TimedDecoder>("dynamsoft-dbr",10ms,1,true),false);
+    begin=std::chrono::steady_clock::now();
+    run=racer->decode(image);
+    CHECK(std::chrono::steady_clock::now()-begin>=150ms);
+    CHECK(run.resolved_by=="dynamsoft-dbr"); CHECK(run.decode_time<120ms); CHECK(*left_cancels==0);
+
+    // Nobody finds anything: a clean no-read, unless every member failed.
+    racer=race(std::make_unique<TimedDecoder>("zxing-cpp",5ms,0,true),std::make_unique<TimedDecoder>("dynamsoft-dbr",10ms,0,true,true));
+    run=racer->decode(image);
+    CHECK(run.resolved_by=="none"); CHECK(run.results.empty()); CHECK(!run.error); CHECK(run.decode_time>=10ms);
+    racer=race(std::make_unique<TimedDecoder>("zxing-cpp",5ms,1,true,true),std::make_unique<TimedDecoder>("dynamsoft-dbr",5ms,1,true,true));
+    run=racer->decode(image);
+    CHECK(run.resolved_by=="none"); CHECK(run.error&&run.error->find("every member failed")!=std::string::npos);
+
+    CHECK(isFormatSupported("race:zxing-cpp+dynamsoft-dbr:Speed","CODE_39"));
+    CHECK(isFormatSupported("race:zxing-cpp+dynamsoft-dbr","QR_CODE"));
+    CHECK(isFormatSupported("race:zxing-cpp+dynamsoft-dbr","DATA_MATRIX")==
+          (isFormatSupported("zxing-cpp","DATA_MATRIX")||isFormatSupported("dynamsoft-dbr","DATA_MATRIX")));
+    CHECK(!isFormatSupported("race","QR_CODE"));
+
+    // The summary reports winners per format and compares the race with its members.
+    const auto root=std::filesystem::temp_directory_path()/"barber_race_test";
+    std::filesystem::remove_all(root);
+    auto write=[&](const std::string& decoder,const std::string& id,const std::string& format,std::int64_t ms,bool correct,const std::string& winner,std::int64_t wall_ms=0){
+        RawResultRecord record; record.decoder=decoder; record.sample.sample_id=id;
+        GroundTruth gt; gt.format=format; gt.text="x"; gt.decode_eligible=true; record.sample.ground_truth.push_back(gt);
+        record.run.decode_time=std::chrono::milliseconds(ms); record.run.resolved_by=winner; record.run.wall_time=std::chrono::milliseconds(wall_ms);
+        record.matches.push_back({0,std::nullopt,correct?Outcome::Correct:Outcome::NotFound});
+        appendResult(root/"results.jsonl",record);
+    };
+    write("zxing-cpp","a","QR_CODE",10,true,""); write("zxing-cpp","b","EAN_13",30,false,"");
+    write("dynamsoft-dbr","a","QR_CODE",20,true,""); write("dynamsoft-dbr","b","EAN_13",20,true,"");
+    const auto name=std::string("race:zxing-cpp+dynamsoft-dbr");
+    write(name,"a","QR_CODE",10,true,"zxing-cpp",30); write(name,"b","EAN_13",20,true,"dynamsoft-dbr",30);
+    SummaryOptions options; options.bootstrap_resamples=0;
+    generateSummary(root/"results.jsonl",root/"summary.json",options);
+    std::ifstream in(root/"summary.json");
+    const auto summary=nlohmann::json::parse(in);
+    const auto& entry=summary["decoders"][name];
+    CHECK(entry["selection"]["by_image"]["zxing-cpp"]==1); CHECK(entry["selection"]["by_image"]["dynamsoft-dbr"]==1);
+    CHECK(entry["selection"]["by_format"]["EAN_13"]["dynamsoft-dbr"]==1);
+    CHECK(entry["versus"]["zxing-cpp"]["recall_delta"]==0.5);
+    CHECK(entry["versus"]["zxing-cpp"]["speedup"]==20.0/15.0);
+    CHECK(entry["mean_wall_ms"]==30.0); CHECK(entry["versus"]["zxing-cpp"]["wall_speedup"]==20.0/30.0);
+    CHECK(!summary["decoders"]["zxing-cpp"].contains("mean_wall_ms"));
+    CHECK(entry["versus"]["dynamsoft-dbr"]["recall_delta"]==0.0);
+    CHECK(!summary["decoders"]["zxing-cpp"].contains("selection"));
+    std::filesystem::remove_all(root);
+}
@@ -0,0 +1,40 @@
+#include "test_support.h"
+#include "record_keys.h"
+#include "result_writer.h"
+
+#include <filesystem>
+#include <fstream>
+
+using namespace bench;
+
+void testRecordKeys()
+{
+    RecordKeySet keys;
+    CHECK(!keys.contains("a|b|0")); CHECK(keys.empty());
+    for(int i=0;i<5000;++i)CHECK(keys.insert(recordKey("sample"+std::to_string(i),i%2?"zxing-cpp":"dynamsoft-dbr",i%3)));
+    CHECK(keys.size()==5000);
+    CHECK(!keys.insert(recordKey("sample42","dynamsoft-dbr",0)));
+    CHECK(keys.count(recordKey("sample42","dynamsoft-dbr",0))==1);
+    CHECK(!keys.contains(recordKey("sample42","dynamsoft-dbr",1)));
+    CHECK(keys.insert("")); CHECK(keys.contains("")); CHECK(keys.size()==5001);
+    keys.clear(); CHECK(!keys.contains(recordKey("sample42","dynamsoft-dbr",0)));
+    CHECK(keyHash("abcdefgh1")!=keyHash("abcdefgh2")); CHECK(keyHash("")!=0);
+
+    // Field order, nested look-alike keys and whitespace do not confuse the scanner.
+    CHECK(scanRecordKey(R"({"sample_id":"s1","ground_truth":[{"decoder":"fake","repetition":9}],"decoder":"zxing-cpp","repetition":2})")=="s1|zxing-cpp|2");
+    CHECK(scanRecordKey(R"({ "repetition" : 11 , "text":"\"decoder\":\"x\"", "decoder" : "d", "sample_id" : "s" })")=="s|d|11");
+    // Escaped values and missing fields take the full-parse path.
+    CHECK(scanRecordKey(R"({"sample_id":"a\"b","decoder":"d","repetition":0})")=="a\"b|d|0");
+    bool threw=false;
+    try { scanRecordKey(R"({"sample_id":"s","decoder":"d","repet)"); } catch (const std::exception&) { threw=true; }
+    CHECK(threw);
+
+    const auto root=std::filesystem::temp_directory_path()/"bench_record_keys_test";
+    std::filesystem::remove_all(root);
+    RawResultRecord record; record.decoder="decoder";
+    record.sample.ground_truth.push_back({"a","QR_CODE","decoder",{},std::nullopt,true,{}});
+    for(int i=0;i<3;++i){record.sample.sample_id="s"+std::to_string(i);record.repetition=i;appendResult(root/"results.jsonl",record);}
+    const auto completed=completedKeys(root/"results.jsonl");
+    CHECK(completed.size()==3); CHECK(completed.contains("s2|decoder|2")); CHECK(!completed.contains("s2|decoder|0"));
+    std::filesystem::remove_all(root);
+}
@@ -0,0 +1,99 @@
+#include "test_support.h"
+
+// cgroups, RLIMIT_AS and forked workers are Linux features.
+#ifndef __linux__
+void testResourceProfile() {}
+#else
+#include "isolated_decoder.h"
+#include "resource_profile.h"
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <sys/mman.h>
+#include <unistd.h>
+
+using namespace bench;
+
+namespace {
+void writeFile(const std::filesystem::path& path,const std::string& text)
+{
+    std::filesystem::create_directories(path.parent_path());
+    std::ofstream(path)<<text;
+}
+
+std::string readFile(const std::filesystem::path& path)
+{
+    std::ifstream in(path); std::stringstream text; text<<in.rdbuf(); return text.str();
+}
+
+// Asks for far more memory than the worker's limit leaves.
+class GreedyDecoder final : public IDecoderAdapter {
+public:
+    std::string name() const override { return "greedy"; }
+    std::string version() const override { return "1"; }
+    DecodeRun decode(const ImageBuffer&) override
+    {
+        std::unique_ptr<char[]> block(new char[std::size_t{1}<<30]);
+        DecodeRun run; run.results.push_back({"QR_CODE",{},std::to_string(block[0]!=1),std::nullopt});
+        return run;
+    }
+};
+}
+
+void testResourceProfile()
+{
+    const auto host=resourceProfile("host");
+    CHECK(host.cpus==0); CHECK(!host.cpu_quota); CHECK(host.memory_limit_bytes==0);
+    const auto edge=resourceProfile("edge");
+    CHECK(edge.name=="edge"); CHECK(edge.cpus==2); CHECK(edge.cpu_quota==2.0); CHECK(edge.memory_limit_bytes==std::size_t{1}<<30);
+    bool rejected=false;
+    try { resourceProfile("phone"); } catch (const std::exception&) { rejected=true; }
+    CHECK(rejected);
+    CHECK(!allowedCpus().empty());
+
+    const auto root=std::filesystem::temp_directory_path()/"barber_cgroup_test";
+    std::filesystem::remove_all(root);
+    writeFile(root/"proc/self/cgroup","0::/bench.slice\n");
+    writeFile(root/"cg/bench.slice/cgroup.controllers","cpu io memory pids\n");
+    writeFile(root/"cg/bench.slice/cgroup.subtree_control","cpu memory\n");
+    // The kernel creates these in a new group; the fake tree needs them up front.
+    const auto group_path=root/"cg/bench.slice"/("barcode-benchmark-"+std::to_string(::getpid()));
+    for(const char* name:{"cpu.max","memory.max","memory.swap.max","cgroup.procs"})writeFile(group_path/name,"");
+    writeFile(group_path/"memory.events","low 0\nhigh 0\nmax 4\noom 3\noom_kill 2\n");
+    std::string reason;
+    {
+        const auto group=WorkerCgroup::create(edge,reason,root/"cg",root/"proc");
+        CHECK(group); CHECK(group->path()==group_path); CHECK(group->limitsMemory());
+        CHECK(readFile(group_path/"cpu.max")=="200000 100000");
+        CHECK(readFile(group_path/"memory.max")=="1073741824");
+        CHECK(readFile(group_path/"memory.swap.max")=="0");
+        CHECK(group->oomKills()==2);
+        group->join(); CHECK(readFile(group_path/"cgroup.procs")=="0");
+    }
+    writeFile(root/"cg/bench.slice/cgroup.controllers","cpu io pids\n");
+    CHECK(!WorkerCgroup::create(edge,reason,root/"cg",root/"proc"));
+    CHECK(reason.find("memory controller")!=std::string::npos);
+    writeFile(root/"proc/self/cgroup","1:name=systemd:/\n");
+    CHECK(!WorkerCgroup::create(edge,reason,root/"cg",root/"proc"));
+    std::filesystem::remove_all(root);
+
+    // Under an address-space cap a failed allocation is reported as an OOM
+    // decode, and the worker stays usable. The cap counts from what the
+    // worker maps after fork, so a large harness mapping does not eat it.
+    const std::size_t reserved=std::size_t{512}<<20;
+    void* reservation=::mmap(nullptr,reserved,PROT_NONE,MAP_PRIVATE|MAP_ANONYMOUS|MAP_NORESERVE,-1,0);
+    CHECK(reservation!=MAP_FAILED);
+    IsolatedDecoder decoder([]{
+        limitAddressSpace(std::size_t{256}<<20);
+        return std::make_unique<GreedyDecoder>();
+    },std::make_shared<SharedImageBuffer>());
+    ImageBuffer image; image.width=1; image.height=1; image.stride=3; image.rgb.assign(3,0);
+    for(int attempt=0;attempt<2;++attempt){
+        const auto run=decoder.decode(image);
+        CHECK(run.error&&run.error->rfind("decoder_oom:",0)==0);
+    }
+    CHECK(decoder.restarts()==0);
+    ::munmap(reservation,reserved);
+}
+#endif
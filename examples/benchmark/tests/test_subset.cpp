@@ -0,0 +1,111 @@
+#include "test_support.h"
+#include "barber_dataset.h"
+#include "metrics.h"
+#include "result_writer.h"
+#include "subset.h"
+
+#include <nlohmann/json.hpp>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <set>
+
+using namespace bench;
+
+namespace {
+ManifestRecord sampleRecord(int i)
+{
+    ManifestRecord r;
+    r.sample_id="s"+std::to_string(i); r.relative_path=r.sample_id+".jpg";
+    r.annotation_file=i%5==0?"extra.json":"main.json";
+    r.width=i%3==0?4000:800; r.height=i%3==0?3000:600;
+    const int symbols=1+i%7/5;
+    for(int k=0;k<symbols;++k){
+        GroundTruth gt; gt.annotation_id=r.sample_id+"-"+std::to_string(k);
+        gt.format=i%4==0?"QR_CODE":"EAN13"; gt.text="1"; gt.decode_eligible=true;
+        if(i%2)gt.ppe=1.0+i%9;
+        r.ground_truth.push_back(gt);
+    }
+    return r;
+}
+
+// A latency that depends on the stratum, so an unweighted subset mean is off.
+double latencyMs(const ManifestRecord& r) { return r.width>1000?40.0:5.0+r.ground_truth.size(); }
+}
+
+void testSubset()
+{
+    std::vector<ManifestRecord> population;
+    for(int i=0;i<2000;++i)population.push_back(sampleRecord(i));
+    SubsetOptions options; options.size=120;
+    const auto subset=selectSubset(population,options);
+    CHECK(subset.records.size()==120); CHECK(subset.population==2000);
+    CHECK(subset.dimensions.size()==5);
+    double total_weight=0; std::set<std::string> strata,ids;
+    for(const auto& r:subset.records){
+        total_weight+=r.weight; strata.insert(r.stratum); ids.insert(r.sample_id);
+        CHECK(r.weight>=1); CHECK(r.stratum==subsetStratum(r,options));
+    }
+    CHECK(std::abs(total_weight-2000)<1e-6); CHECK(strata.size()==subset.strata); CHECK(ids.size()==120);
+    std::set<std::string> every;
+    for(const auto& r:population)every.insert(subsetStratum(r,options));
+    CHECK(every.size()==subset.strata);
+    const auto again=selectSubset(population,options);
+    for(std::size_t i=0;i<again.records.size();++i)CHECK(again.records[i].sample_id==subset.records[i].sample_id);
+    options.seed=2;
+    CHECK(selectSubset(population,options).records[0].sample_id!=subset.records[0].sample_id||
+          selectSubset(population,options).records[1].sample_id!=subset.records[1].sample_id);
+
+    // Fewer picks than strata drops dimensions from the end.
+    options.size=4;
+    const auto coarse=selectSubset(population,options);
+    CHECK(coarse.records.size()==4); CHECK(coarse.dimensions.size()<5); CHECK(coarse.strata<=4);
+    options.size=5000;
+    const auto whole=selectSubset(population,options);
+    CHECK(whole.records.size()==2000); for(const auto& r:whole.records)CHECK(r.weight==1);
+
+    // The weighted estimate recovers the population mean within its bounds.
+    double truth=0; for(const auto& r:population)truth+=latencyMs(r); truth/=population.size();
+    std::vector<StratifiedUnit> units;
+    for(const auto& r:subset.records)units.push_back({r.stratum,r.weight,latencyMs(r),1});
+    const auto estimate=stratifiedRatio(units);
+    CHECK(std::abs(estimate.value-truth)<1e-9+3*estimate.standard_error+0.5);
+    CHECK(std::abs(estimate.population-2000)<1e-6);
+    units.clear();
+    for(const auto& r:whole.records)units.push_back({r.stratum,r.weight,latencyMs(r),1});
+    const auto census=stratifiedRatio(units);
+    CHECK(std::abs(census.value-truth)<1e-9); CHECK(census.standard_error==0);
+    // Two strata of 10 with 2 picks each: N_h^2 (1-f) s^2/n_h summed, over N.
+    const auto manual=stratifiedRatio({{"a",5,1,1},{"a",5,3,1},{"b",5,10,1},{"b",5,14,1}});
+    CHECK(std::abs(manual.value-7)<1e-12);
+    CHECK(std::abs(manual.standard_error-std::sqrt(100*0.8*2/2+100*0.8*8/2)/20)<1e-12);
+
+    const auto root=std::filesystem::temp_directory_path()/"barber_subset_test";
+    std::filesystem::remove_all(root);
+    BarberDataset::writeManifest(root/"subset.jsonl",subset.records);
+    const auto reread=BarberDataset::readManifest(root/"subset.jsonl");
+    CHECK(reread.size()==120); CHECK(reread[3].stratum==subset.records[3].stratum);
+    CHECK(std::abs(reread[3].weight-subset.records[3].weight)<1e-12);
+    CHECK(BarberDataset::manifestLine(population[0]).find("weight")==std::string::npos);
+
+    for(const auto& r:subset.records){
+        RawResultRecord record; record.sample=r; record.decoder="zxing-cpp";
+        record.run.decode_time=std::chrono::nanoseconds(static_cast<std::int64_t>(latencyMs(r)*1e6));
+        for(std::size_t i=0;i<r.ground_truth.size();++i)
+            record.matches.push_back({i,std::nullopt,r.width>1000?Outcome::NotFound:Outcome::Correct});
+        appendResult(root/"results.jsonl",record);
+    }
+    SummaryOptions summary_options; summary_options.bootstrap_resamples=0;
+    generateSummary(root/"results.jsonl",root/"summary.json",summary_options);
+    std::ifstream in(root/"summary.json");
+    const auto summary=nlohmann::json::parse(in);
+    const auto& estimate_json=summary["decoders"]["zxing-cpp"]["subset_estimate"];
+    CHECK(estimate_json["images"]==120); CHECK(std::abs(estimate_json["population_images"].get<double>()-2000)<1e-6);
+    const auto& ci=estimate_json["mean_decode_ms_ci95"];
+    CHECK(ci[0].get<double>()<=estimate_json["mean_decode_ms"].get<double>());
+    CHECK(ci[1].get<double>()>=estimate_json["mean_decode_ms"].get<double>());
+    double recall_truth=0,eligible=0;
+    for(const auto& r:population){eligible+=r.ground_truth.size();if(r.width<=1000)recall_truth+=r.ground_truth.size();}
+    CHECK(std::abs(estimate_json["recall"].get<double>()-recall_truth/eligible)<0.05);
+    std::filesystem::remove_all(root);
+}
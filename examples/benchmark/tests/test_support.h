@@ -7,3 +7,22 @@
 void testMatching();
 void testMetrics();
 void testBarberParser();
+void testImageLoader();
+void testJsonWriter();
+void testWatchdog();
+void testSyntheticCorpus();
+void testComparison();
+void testRecordKeys();
+void testTrace();
+void testIsolatedDecoder();
+void testCacheEvictor();
+void testLiveMetrics();
+void testDecoderMatrix();
+void testSubset();
+void testEnvironment();
+void testResourceProfile();
+void testRacingDecoder();
+void testCascadeDecoder();
+void testHotspots();
+void testAdaptiveRepetitions();
+void testImagePack();
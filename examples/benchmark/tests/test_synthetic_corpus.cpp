@@ -0,0 +1,96 @@
+#include "test_support.h"
+#include "barber_dataset.h"
+#include "hash.h"
+#include "image_loader.h"
+#include "normalization.h"
+#include "synthetic_corpus.h"
+
+#include <fstream>
+#include <sstream>
+
+using namespace bench;
+
+namespace {
+
+// Stand-in for the ZXing writer: a bar pattern for linear formats and a
+// checkerboard for QR, with PDF417-style 2x widened cells for PDF_417.
+class FakeEncoder final : public ISymbolEncoder {
+public:
+    std::string name() const override { return "fake"; }
+    std::vector<std::string> formats() const override { return {"EAN_13","QR_CODE","PDF_417"}; }
+    bool encode(std::string_view format, std::string_view text, SymbolMatrix& output, std::string& error) const override
+    {
+        if(text.empty()){error="empty";return false;}
+        if(format=="EAN_13"){
+            output.width=95;output.height=1;output.cells.resize(95);
+            for(int x=0;x<95;++x)output.cells[x]=(x/(1+x%3))%2;
+            return true;
+        }
+        const int cell=format=="PDF_417"?2:1;
+        output.width=21*cell;output.height=21;output.cells.resize(static_cast<std::size_t>(output.width)*21);
+        for(int y=0;y<21;++y)for(int x=0;x<output.width;++x)output.cells[static_cast<std::size_t>(y)*output.width+x]=((x/cell)+y)%2;
+        return true;
+    }
+};
+
+std::string slurp(const std::filesystem::path& path)
+{
+    std::ifstream input(path,std::ios::binary);std::ostringstream text;text<<input.rdbuf();return text.str();
+}
+
+}
+
+void testSyntheticCorpus()
+{
+    std::mt19937_64 rng(7);
+    for(const char* format:{"EAN_13","EAN_8","UPC_A","UPC_E","ITF","CODE_39","CODE_93","CODABAR","CODE_128","QR_CODE","PDF_417"}){
+        for(int i=0;i<20;++i){
+            const auto payload=syntheticPayload(format,rng);
+            CHECK(!payload.empty());CHECK(isPayloadStructurallyValid(format,payload));
+        }
+    }
+    const auto codabar=syntheticPayload("CODABAR",rng);
+    CHECK(std::string_view("ABCD").find(codabar.front())!=std::string_view::npos);CHECK(std::string_view("ABCD").find(codabar.back())!=std::string_view::npos);
+    CHECK(codabar.find_first_not_of("0123456789-$:/.+",1)==codabar.size()-1);
+    CHECK(syntheticPayload("CODE_93",rng).find_first_not_of("0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ-.$/+%")==std::string::npos);
+    CHECK(syntheticPayload("UPC_E",rng).size()==8);CHECK(syntheticPayload("ITF",rng).size()%2==0);
+
+    const auto root=std::filesystem::temp_directory_path()/"bench_synth_test";
+    std::filesystem::remove_all(root);
+    FakeEncoder encoder;
+    SynthOptions options;
+    options.output=root/"a";options.count=5;options.width=320;options.height=240;
+    options.module_sizes={2,3};options.max_symbols=3;options.image_format="png";options.threads=2;options.seed=11;
+    const auto summary=generateSyntheticCorpus(options,encoder);
+    CHECK(summary.images==5);CHECK(summary.symbols>=1);
+
+    const auto records=BarberDataset::readManifest(root/"a"/"manifest.jsonl");
+    CHECK(records.size()==5);
+    std::size_t symbols=0;
+    for(const auto& record:records){
+        CHECK(record.width==320);CHECK(record.height==240);
+        const auto path=root/"a"/"images"/record.relative_path;
+        CHECK(sha256File(path)==record.image_sha256);
+        ImageBuffer image;std::string error;
+        CHECK(loadImage(path,image,error));CHECK(image.width==320);CHECK(image.height==240);
+        for(const auto& truth:record.ground_truth){
+            ++symbols;
+            CHECK(truth.decode_eligible);CHECK(truth.ppe&&(*truth.ppe==2||*truth.ppe==3));
+            CHECK(truth.polygon.size()==4);
+            for(const auto& p:truth.polygon){CHECK(p.x>=0&&p.x<=320);CHECK(p.y>=0&&p.y<=240);}
+            CHECK(isPayloadStructurallyValid(truth.format,truth.text));
+        }
+    }
+    CHECK(symbols==summary.symbols);
+
+    // Output depends on (seed, index) only, not on the thread count.
+    options.output=root/"b";options.threads=1;
+    generateSyntheticCorpus(options,encoder);
+    CHECK(slurp(root/"a"/"manifest.jsonl")==slurp(root/"b"/"manifest.jsonl"));
+
+    options.formats={"AZTEC"};
+    bool threw=false;
+    try { generateSyntheticCorpus(options,encoder); } catch (const std::exception&) { threw=true; }
+    CHECK(threw);
+    std::filesystem::remove_all(root);
+}
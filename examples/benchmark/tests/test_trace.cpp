@@ -0,0 +1,49 @@
+#include "test_support.h"
+#include "trace.h"
+
+#include <nlohmann/json.hpp>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <thread>
+
+using namespace bench;
+
+void testTrace()
+{
+    const auto path=std::filesystem::temp_directory_path()/"bench_trace_test.json";
+    stopTrace();
+    { TraceSpan span("ignored","s0"); }
+    CHECK(!traceEnabled());
+
+    startTrace(4);
+    nameTraceThread("runner");
+    { TraceSpan span("image_load","sample-1"); }
+    { TraceSpan span("decode","sample-1","zxing-cpp"); }
+    std::thread worker([]{
+        nameTraceThread("worker");
+        for(int i=0;i<6;++i){ TraceSpan span("decode",i==5?"last":"early"); }
+    });
+    worker.join();
+    stopTrace();
+    { TraceSpan span("after_stop"); }
+    CHECK(writeTrace(path)==6);
+
+    std::ifstream in(path);
+    const auto trace=nlohmann::json::parse(in);
+    std::map<int,std::string> threads;
+    std::map<std::string,int> names;
+    for(const auto& event:trace.at("traceEvents")){
+        if(event.at("ph")=="M"){threads[event.at("tid").get<int>()]=event.at("args").at("name");continue;}
+        CHECK(event.at("ph")=="X"); CHECK(event.at("dur").get<double>()>=0); CHECK(event.at("ts").get<double>()>=0);
+        ++names[event.at("name").get<std::string>()];
+    }
+    CHECK(threads.size()==2); CHECK(threads[1]=="runner"); CHECK(threads[2]=="worker");
+    CHECK(names["image_load"]==1); CHECK(names["decode"]==5); CHECK(!names.count("ignored")); CHECK(!names.count("after_stop"));
+    // The worker's ring holds four spans, so the two oldest were overwritten.
+    CHECK(trace.at("otherData").at("dropped_spans")==2);
+    const auto& events=trace.at("traceEvents");
+    CHECK(events[2].at("args").at("sample_id")=="sample-1"); CHECK(events[2].at("args").at("detail")=="zxing-cpp");
+    CHECK(events.back().at("args").at("sample_id")=="last");
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,54 @@
+#include "test_support.h"
+#include "decode_watchdog.h"
+#include <atomic>
+
+using namespace bench;
+
+namespace {
+class SleepingDecoder final : public IDecoderAdapter {
+public:
+    SleepingDecoder(std::chrono::milliseconds duration, bool cancellable) : duration_(duration), cancellable_(cancellable) {}
+    std::string name() const override { return "sleeping"; }
+    std::string version() const override { return "1"; }
+    DecodeRun decode(const ImageBuffer&) override
+    {
+        DecodeRun run; cancelled_=false;
+        const auto begin=std::chrono::steady_clock::now();
+        while(std::chrono::steady_clock::now()-begin<duration_&&!cancelled_)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        run.decode_time=std::chrono::steady_clock::now()-begin;
+        run.results.push_back({"QR_CODE",{},"late",std::nullopt});
+        return run;
+    }
+    bool cancel() override { if(!cancellable_)return false; cancelled_=true; return true; }
+private:
+    std::chrono::milliseconds duration_;
+    bool cancellable_;
+    std::atomic<bool> cancelled_{false};
+};
+}
+
+void testWatchdog()
+{
+    CHECK(toString(Outcome::Timeout)=="timeout");
+    DecodeWatchdog watchdog(std::chrono::milliseconds(30));
+    ImageBuffer image;
+    SleepingDecoder fast(std::chrono::milliseconds(0),true);
+    auto run=watchdog.decode(fast,image);
+    CHECK(!run.timed_out); CHECK(run.results.size()==1); CHECK(!run.error);
+
+    SleepingDecoder cancellable(std::chrono::milliseconds(5000),true);
+    const auto begin=std::chrono::steady_clock::now();
+    run=watchdog.decode(cancellable,image);
+    CHECK(std::chrono::steady_clock::now()-begin<std::chrono::seconds(2));
+    CHECK(run.timed_out); CHECK(run.results.empty()); CHECK(run.error);
+    CHECK(watchdog.cancelled()==1);
+
+    SleepingDecoder stubborn(std::chrono::milliseconds(80),false);
+    run=watchdog.decode(stubborn,image);
+    CHECK(run.timed_out); CHECK(run.results.empty());
+    CHECK(watchdog.overruns()==2); CHECK(watchdog.cancelled()==1);
+
+    run=watchdog.decode(fast,image);
+    CHECK(!run.timed_out);
+}
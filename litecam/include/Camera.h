@@ -5,6 +5,7 @@
 #include <string>
 #include <iostream>
 #include <cstdint>
+#include <utility>
 
 // Export macro for shared library
 #ifdef _WIN32
@@ -37,10 +38,13 @@ using Microsoft::WRL::ComPtr;
 #include <sys/ioctl.h>
 #include <sys/mman.h>
 
+class FrameView;
+
 struct Buffer
 {
     void *start;
     size_t length;
+    FrameView *view; // The view holding this buffer while it is dequeued
 };
 #endif
 
@@ -53,6 +57,43 @@ struct CAMERA_API FrameData
     size_t size;
 };
 
+class Camera;
+
+// A captured frame borrowed from the driver instead of copied. On Linux the
+// pixels are the dequeued V4L2 mmap buffer in the device's native format
+// (YUYV unless the driver chose otherwise); the buffer goes back to the
+// capture queue when the view is released or destroyed. Camera::Release()
+// empties any view still outstanding, since its buffer is unmapped. Hold
+// fewer views than the camera has buffers (four), or capture stalls.
+class FrameView
+{
+public:
+    FrameView() = default;
+    ~FrameView() { Release(); }
+    FrameView(FrameView &&other) noexcept;
+    FrameView &operator=(FrameView &&other) noexcept;
+    FrameView(const FrameView &) = delete;
+    FrameView &operator=(const FrameView &) = delete;
+
+    // Requeues the buffer; safe to call more than once.
+    void Release();
+    explicit operator bool() const { return data != nullptr; }
+
+    const unsigned char *data = nullptr;
+    size_t size = 0;          // Bytes filled by the driver
+    int width = 0;
+    int height = 0;
+    int stride = 0;           // Bytes per row
+    uint32_t pixelFormat = 0; // FourCC, e.g. V4L2_PIX_FMT_YUYV
+    uint32_t sequence = 0;    // Driver frame counter; gaps mean dropped frames
+    int64_t timestampUs = 0;  // Driver capture time in microseconds
+
+private:
+    friend class Camera;
+    Camera *owner = nullptr;
+    unsigned int index = 0;
+};
+
 struct CAMERA_API MediaTypeInfo
 {
     uint32_t width;
@@ -87,7 +128,7 @@ public:
     Camera();
     ~Camera();
 #elif __linux__
-    Camera() : frameWidth(640), frameHeight(480), fd(-1), buffers(nullptr), bufferCount(0) {}
+    Camera() : frameWidth(640), frameHeight(480), frameStride(640 * 2), pixelFormat(V4L2_PIX_FMT_YUYV), fd(-1), buffers(nullptr), bufferCount(0) {}
     ~Camera() { Release(); }
 #elif __APPLE__
     Camera() noexcept; // Add noexcept to match the implementation
@@ -99,6 +140,11 @@ public:
 
     std::vector<MediaTypeInfo> ListSupportedMediaTypes();
     FrameData CaptureFrame();
+#ifdef __linux__
+    // Dequeues the next frame without converting or copying it; the view is
+    // empty on failure. CaptureFrame() converts one of these to RGB.
+    FrameView AcquireFrame();
+#endif
     bool SetResolution(int width, int height);
 
     uint32_t frameWidth;
@@ -114,6 +160,8 @@ private:
 #endif
 
 #ifdef __linux__
+    uint32_t frameStride;
+    uint32_t pixelFormat;
     int fd;
     Buffer *buffers;
     unsigned int bufferCount;
@@ -122,6 +170,10 @@ private:
     void UninitDevice();
     bool StartCapture();
     void StopCapture();
+    friend class FrameView;
+    void RequeueBuffer(unsigned int index);
+    // Points the buffer at the view that now holds it, after a move.
+    void TrackView(unsigned int index, FrameView *view);
 #endif
 
 #ifdef __APPLE__
@@ -130,4 +182,45 @@ private:
 #endif
 };
 
+inline FrameView::FrameView(FrameView &&other) noexcept
+{
+    *this = std::move(other);
+}
+
+inline FrameView &FrameView::operator=(FrameView &&other) noexcept
+{
+    if (this != &other)
+    {
+        Release();
+        data = other.data;
+        size = other.size;
+        width = other.width;
+        height = other.height;
+        stride = other.stride;
+        pixelFormat = other.pixelFormat;
+        sequence = other.sequence;
+        timestampUs = other.timestampUs;
+        owner = other.owner;
+        index = other.index;
+        other.owner = nullptr;
+        other.data = nullptr;
+#ifdef __linux__
+        if (owner)
+            owner->TrackView(index, this);
+#endif
+    }
+    return *this;
+}
+
+inline void FrameView::Release()
+{
+#ifdef __linux__
+    if (owner)
+        owner->RequeueBuffer(index);
+#endif
+    owner = nullptr;
+    data = nullptr;
+    size = 0;
+}
+
 #endif // CAMERA_H
@@ -26,6 +26,10 @@
 #define CAMERA_API
 #endif
 
+#ifdef __linux__
+class FrameView;
+#endif
+
 class CAMERA_API CameraWindow
 {
 public:
@@ -36,6 +40,11 @@ public:
     void Show();
     bool WaitKey(char key);
     void ShowFrame(const unsigned char *rgbData, int width, int height);
+#ifdef __linux__
+    // Shows a YUYV frame from Camera::AcquireFrame(), converted straight
+    // into the window's image buffer with no RGB frame in between.
+    void ShowFrame(const FrameView &view);
+#endif
     void DrawContour(const std::vector<std::pair<int, int>> &points);
 
     struct Color
@@ -64,6 +73,9 @@ private:
     Window window;
     GC gc; // Graphics context
     Atom wmDeleteMessage;
+    std::vector<unsigned char> frameBuffer; // BGRX pixels, reused across frames
+
+    void PutFrame(int frameWidth, int frameHeight);
 #elif __APPLE__
     // Add macOS-specific members (e.g., NSWindow or CGContext)
     void *nsWindow; // Use proper macOS data structures here
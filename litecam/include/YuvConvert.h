@@ -0,0 +1,45 @@
+#ifndef YUV_CONVERT_H
+#define YUV_CONVERT_H
+
+#include <cstddef>
+
+// Export macro for shared library, unless Camera.h or CameraPreview.h has
+// already defined it
+#ifndef CAMERA_API
+#ifdef _WIN32
+#ifdef CAMERA_EXPORTS
+#define CAMERA_API __declspec(dllexport)
+#else
+#define CAMERA_API __declspec(dllimport)
+#endif
+#elif defined(__linux__) || defined(__APPLE__)
+#define CAMERA_API __attribute__((visibility("default")))
+#else
+#define CAMERA_API
+#endif
+#endif
+
+// YUYV (YUY2) to RGB conversion with full-range BT.601 coefficients, in
+// 16-bit fixed point so every kernel gives the same bytes:
+//   R = Y + (((V - 128) * 128 * 718) >> 16)
+//   G = Y - (((U - 128) * 128 * 176) >> 16) - (((V - 128) * 128 * 366) >> 16) - 1
+//   B = Y + (((U - 128) * 128 * 907) >> 16)
+// clamped to 0..255. Strides are in bytes, and an odd width drops its last
+// pixel because YUYV stores pixels in pairs.
+CAMERA_API void ConvertYUYVToRGB(const unsigned char *yuyv, int yuyvStride, unsigned char *rgb, int rgbStride, int width, int height);
+CAMERA_API void ConvertYUYVToBGR(const unsigned char *yuyv, int yuyvStride, unsigned char *bgr, int bgrStride, int width, int height);
+// Four bytes per pixel with X = 255. BGRX is the byte order of a 32-bit
+// TrueColor XImage on little-endian machines.
+CAMERA_API void ConvertYUYVToRGBX(const unsigned char *yuyv, int yuyvStride, unsigned char *rgbx, int rgbxStride, int width, int height);
+CAMERA_API void ConvertYUYVToBGRX(const unsigned char *yuyv, int yuyvStride, unsigned char *bgrx, int bgrxStride, int width, int height);
+// Copies the luma plane only; no color math.
+CAMERA_API void ConvertYUYVToGray(const unsigned char *yuyv, int yuyvStride, unsigned char *gray, int grayStride, int width, int height);
+
+// The kernels are picked at first use from what the CPU supports: "avx2",
+// "sse2", "neon" or "scalar". SetYuvKernel() forces one, e.g. to compare
+// them, and returns false when it is unavailable here; "auto" restores the
+// default.
+CAMERA_API const char *GetYuvKernel();
+CAMERA_API bool SetYuvKernel(const char *name);
+
+#endif // YUV_CONVERT_H
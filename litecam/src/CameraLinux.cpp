@@ -1,54 +1,11 @@
 #include "Camera.h"
+#include "YuvConvert.h"
 #include <iostream>
 #include <vector>
 #include <string>
 #include <map>
 #include <cstring>
 
-unsigned char clamp(double value, double min, double max)
-{
-    if (value < min)
-        return static_cast<unsigned char>(min);
-    if (value > max)
-        return static_cast<unsigned char>(max);
-    return static_cast<unsigned char>(value);
-}
-
-void ConvertYUY2ToRGB(const unsigned char *yuy2Data, unsigned char *rgbData, int width, int height)
-{
-    int rgbIndex = 0;
-    for (int i = 0; i < width * height * 2; i += 4)
-    {
-        // Extract YUV values
-        unsigned char y1 = yuy2Data[i];
-        unsigned char u = yuy2Data[i + 1];
-        unsigned char y2 = yuy2Data[i + 2];
-        unsigned char v = yuy2Data[i + 3];
-
-#ifdef _WIN32
-        // Convert first pixel (Y1, U, V) to RGB
-        rgbData[rgbIndex++] = clamp(y1 + 1.772 * (u - 128), 0.0, 255.0);
-        rgbData[rgbIndex++] = clamp(y1 - 0.344136 * (u - 128) - 0.714136 * (v - 128), 0.0, 255.0);
-        rgbData[rgbIndex++] = clamp(y1 + 1.402 * (v - 128), 0.0, 255.0);
-
-        // Convert second pixel (Y2, U, V) to RGB
-        rgbData[rgbIndex++] = clamp(y2 + 1.772 * (u - 128), 0.0, 255.0);
-        rgbData[rgbIndex++] = clamp(y2 - 0.344136 * (u - 128) - 0.714136 * (v - 128), 0.0, 255.0);
-        rgbData[rgbIndex++] = clamp(y2 + 1.402 * (v - 128), 0.0, 255.0);
-#else
-        // Convert first pixel (Y1, U, V) to RGB
-        rgbData[rgbIndex++] = clamp(y1 + 1.402 * (v - 128), 0.0, 255.0);
-        rgbData[rgbIndex++] = clamp(y1 - 0.344136 * (u - 128) - 0.714136 * (v - 128), 0.0, 255.0);
-        rgbData[rgbIndex++] = clamp(y1 + 1.772 * (u - 128), 0.0, 255.0);
-
-        // Convert second pixel (Y2, U, V) to RGB
-        rgbData[rgbIndex++] = clamp(y2 + 1.402 * (v - 128), 0.0, 255.0);
-        rgbData[rgbIndex++] = clamp(y2 - 0.344136 * (u - 128) - 0.714136 * (v - 128), 0.0, 255.0);
-        rgbData[rgbIndex++] = clamp(y2 + 1.772 * (u - 128), 0.0, 255.0);
-#endif
-    }
-}
-
 bool Camera::Open(int cameraIndex)
 {
     std::string devicePath = "/dev/video" + std::to_string(cameraIndex);
@@ -82,6 +39,12 @@ bool Camera::Open(int cameraIndex)
         return false;
     }
 
+    // The driver may adjust the size and pad rows
+    frameWidth = fmt.fmt.pix.width;
+    frameHeight = fmt.fmt.pix.height;
+    frameStride = fmt.fmt.pix.bytesperline ? fmt.fmt.pix.bytesperline : frameWidth * 2;
+    pixelFormat = fmt.fmt.pix.pixelformat;
+
     if (!InitDevice() || !StartCapture())
     {
         Release();
@@ -126,12 +89,15 @@ bool Camera::SetResolution(int width, int height)
     // Save the actual resolution set by the device
     frameWidth = fmt.fmt.pix.width;
     frameHeight = fmt.fmt.pix.height;
+    frameStride = fmt.fmt.pix.bytesperline ? fmt.fmt.pix.bytesperline : frameWidth * 2;
+    pixelFormat = fmt.fmt.pix.pixelformat;
 
     return true;
 }
 
-FrameData Camera::CaptureFrame()
+FrameView Camera::AcquireFrame()
 {
+    FrameView view;
     struct v4l2_buffer buf;
     memset(&buf, 0, sizeof(buf));
     buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
@@ -141,29 +107,59 @@ FrameData Camera::CaptureFrame()
     if (ioctl(fd, VIDIOC_DQBUF, &buf) < 0)
     {
         perror("Failed to dequeue buffer");
-        return {};
+        return view;
     }
 
-    // FILE *file = fopen("raw_frame.yuyv", "wb");
-    // fwrite(buffers[buf.index].start, 1, buffers[buf.index].length, file);
-    // fclose(file);
-
-    // Prepare FrameData structure
-    FrameData frame;
-    frame.width = frameWidth;
-    frame.height = frameHeight;
-    frame.size = frameWidth * frameHeight * 3; // 3 bytes per pixel (RGB)
-    frame.rgbData = new unsigned char[frame.size];
+    view.data = reinterpret_cast<const unsigned char *>(buffers[buf.index].start);
+    view.size = buf.bytesused ? buf.bytesused : buffers[buf.index].length;
+    view.width = frameWidth;
+    view.height = frameHeight;
+    view.stride = frameStride;
+    view.pixelFormat = pixelFormat;
+    view.sequence = buf.sequence;
+    view.timestampUs = static_cast<int64_t>(buf.timestamp.tv_sec) * 1000000 + buf.timestamp.tv_usec;
+    view.owner = this;
+    view.index = buf.index;
+    buffers[buf.index].view = &view;
+    return view;
+}
 
-    // Convert YUYV to RGB
-    ConvertYUY2ToRGB(reinterpret_cast<unsigned char *>(buffers[buf.index].start), frame.rgbData, frameWidth, frameHeight);
+void Camera::TrackView(unsigned int index, FrameView *view)
+{
+    buffers[index].view = view;
+}
 
-    // Requeue the buffer
+void Camera::RequeueBuffer(unsigned int index)
+{
+    buffers[index].view = nullptr;
+    struct v4l2_buffer buf;
+    memset(&buf, 0, sizeof(buf));
+    buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buf.memory = V4L2_MEMORY_MMAP;
+    buf.index = index;
     if (ioctl(fd, VIDIOC_QBUF, &buf) < 0)
     {
         perror("Failed to queue buffer");
     }
+}
 
+FrameData Camera::CaptureFrame()
+{
+    FrameView view = AcquireFrame();
+    if (!view)
+        return {};
+
+    // Prepare FrameData structure
+    FrameData frame;
+    frame.width = view.width;
+    frame.height = view.height;
+    frame.size = view.width * view.height * 3; // 3 bytes per pixel (RGB)
+    frame.rgbData = new unsigned char[frame.size];
+
+    // Convert YUYV to RGB
+    ConvertYUYVToRGB(view.data, view.stride, frame.rgbData, view.width * 3, view.width, view.height);
+
+    // The view requeues the buffer when it goes out of scope
     return frame;
 }
 
@@ -181,7 +177,7 @@ bool Camera::InitDevice()
         return false;
     }
 
-    buffers = new Buffer[req.count];
+    buffers = new Buffer[req.count]();
     bufferCount = req.count;
 
     for (unsigned int i = 0; i < bufferCount; ++i)
@@ -222,6 +218,14 @@ void Camera::UninitDevice()
     {
         for (unsigned int i = 0; i < bufferCount; ++i)
         {
+            // A view that outlives the capture would requeue on a closed fd
+            // and read unmapped memory, so it is emptied instead
+            if (buffers[i].view)
+            {
+                buffers[i].view->owner = nullptr;
+                buffers[i].view->data = nullptr;
+                buffers[i].view->size = 0;
+            }
             munmap(buffers[i].start, buffers[i].length);
         }
         delete[] buffers;
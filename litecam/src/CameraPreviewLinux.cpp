@@ -1,4 +1,6 @@
 #include "CameraPreview.h"
+#include "Camera.h"
+#include "YuvConvert.h"
 #include <iostream>
 #include <algorithm>
 #include <cstring>
@@ -123,27 +125,47 @@ void CameraWindow::ShowFrame(const unsigned char *rgbData, int frameWidth, int f
         return;
     }
 
-    // Create a buffer with an alpha channel for each pixel
-    int stride = frameWidth * 4; // 4 bytes per pixel (RGBA)
-    std::vector<unsigned char> rgbaBuffer(frameWidth * frameHeight * 4);
-
-    // Populate the buffer with RGB data and set alpha to 255
+    // A 32-bit TrueColor XImage stores each pixel as B, G, R, X
+    frameBuffer.resize(static_cast<size_t>(frameWidth) * frameHeight * 4);
     for (int i = 0; i < frameWidth * frameHeight; ++i)
     {
-        rgbaBuffer[i * 4 + 0] = rgbData[i * 3 + 2]; // Red
-        rgbaBuffer[i * 4 + 1] = rgbData[i * 3 + 1]; // Green
-        rgbaBuffer[i * 4 + 2] = rgbData[i * 3 + 0]; // Blue
-        rgbaBuffer[i * 4 + 3] = 255;                // Alpha
+        frameBuffer[i * 4 + 0] = rgbData[i * 3 + 2]; // Blue
+        frameBuffer[i * 4 + 1] = rgbData[i * 3 + 1]; // Green
+        frameBuffer[i * 4 + 2] = rgbData[i * 3 + 0]; // Red
+        frameBuffer[i * 4 + 3] = 255;
+    }
+
+    PutFrame(frameWidth, frameHeight);
+}
+
+void CameraWindow::ShowFrame(const FrameView &view)
+{
+    if (!display || !window || !gc || !view)
+    {
+        std::cerr << "Invalid display, window, gc, or frame." << std::endl;
+        return;
+    }
+    if (view.pixelFormat != V4L2_PIX_FMT_YUYV)
+    {
+        std::cerr << "ShowFrame expects a YUYV frame." << std::endl;
+        return;
     }
 
-    // Try to create the XImage
+    frameBuffer.resize(static_cast<size_t>(view.width) * view.height * 4);
+    ConvertYUYVToBGRX(view.data, view.stride, frameBuffer.data(), view.width * 4, view.width, view.height);
+    PutFrame(view.width, view.height);
+}
+
+void CameraWindow::PutFrame(int frameWidth, int frameHeight)
+{
+    // Wrap frameBuffer in an XImage without copying it
     XImage *image = XCreateImage(
         display,
         DefaultVisual(display, DefaultScreen(display)),
         24,      // Depth: 24 bits for RGB
         ZPixmap, // Format
         0,       // Offset
-        reinterpret_cast<char *>(rgbaBuffer.data()),
+        reinterpret_cast<char *>(frameBuffer.data()),
         frameWidth, frameHeight,
         32, // Bitmap pad: 32-bit alignment
         0   // Bytes per line (auto-calculated)
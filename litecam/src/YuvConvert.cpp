@@ -0,0 +1,410 @@
+#include "YuvConvert.h"
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+#if defined(__x86_64__) || defined(_M_X64) || (defined(__i386__) && defined(__SSE2__))
+#define LITECAM_YUV_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define LITECAM_AVX2_TARGET
+#else
+#define LITECAM_AVX2_TARGET __attribute__((target("avx2")))
+#endif
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define LITECAM_YUV_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace
+{
+// Chroma coefficients scaled by 512: 1.402, 0.344136, 0.714136 and 1.772.
+// Chroma enters the multiply as (C - 128) << 7, so the R and B terms are the
+// high half of a 16-bit product, which is one instruction on every target.
+// G needs both chroma terms; they are summed in 32 bits and rounded once,
+// so neutral chroma leaves G equal to Y.
+const int kRV = 718;
+const int kGU = 176;
+const int kGV = 366;
+const int kBU = 907;
+
+// Converts `width` pixels (even) of one row; channels is 3 or 4.
+typedef void (*ColorRow)(const unsigned char *src, unsigned char *dst, int width, int channels, bool swapRB);
+typedef void (*GrayRow)(const unsigned char *src, unsigned char *dst, int width);
+
+inline int Term(int chroma, int coef)
+{
+    return (chroma * 128 * coef) >> 16;
+}
+
+inline int GreenTerm(int u, int v)
+{
+    return (u * 128 * kGU + v * 128 * kGV + (1 << 15)) >> 16;
+}
+
+inline unsigned char Clamp255(int value)
+{
+    return static_cast<unsigned char>(value < 0 ? 0 : value > 255 ? 255 : value);
+}
+
+// The reference every SIMD kernel must match byte for byte.
+void ColorRowScalar(const unsigned char *src, unsigned char *dst, int width, int channels, bool swapRB)
+{
+    for (int x = 0; x < width; x += 2, src += 4)
+    {
+        const int d = src[1] - 128;
+        const int e = src[3] - 128;
+        const int rt = Term(e, kRV);
+        const int gt = GreenTerm(d, e);
+        const int bt = Term(d, kBU);
+        for (int k = 0; k < 2; ++k, dst += channels)
+        {
+            const int y = src[k * 2];
+            const unsigned char r = Clamp255(y + rt);
+            const unsigned char b = Clamp255(y + bt);
+            dst[0] = swapRB ? b : r;
+            dst[1] = Clamp255(y - gt);
+            dst[2] = swapRB ? r : b;
+            if (channels == 4)
+                dst[3] = 255;
+        }
+    }
+}
+
+void GrayRowScalar(const unsigned char *src, unsigned char *dst, int width)
+{
+    for (int x = 0; x < width; ++x)
+        dst[x] = src[x * 2];
+}
+
+#ifdef LITECAM_YUV_X86
+// Eight pixels of YUYV in one register to 16-bit R, G and B.
+inline void ColorHalfSSE2(__m128i v, __m128i &r, __m128i &g, __m128i &b)
+{
+    const __m128i y = _mm_and_si128(v, _mm_set1_epi16(0x00FF));
+    const __m128i uv = _mm_slli_epi16(_mm_sub_epi16(_mm_srli_epi16(v, 8), _mm_set1_epi16(128)), 7);
+    // U0 V0 U1 V1 ... -> U0 U0 U1 U1 ... and V0 V0 V1 V1 ...
+    const __m128i u = _mm_shufflehi_epi16(_mm_shufflelo_epi16(uv, _MM_SHUFFLE(2, 2, 0, 0)), _MM_SHUFFLE(2, 2, 0, 0));
+    const __m128i w = _mm_shufflehi_epi16(_mm_shufflelo_epi16(uv, _MM_SHUFFLE(3, 3, 1, 1)), _MM_SHUFFLE(3, 3, 1, 1));
+    // U*kGU + V*kGV per pair, rounded, then widened back to both pixels.
+    const __m128i sum = _mm_madd_epi16(uv, _mm_set1_epi32((kGV << 16) | kGU));
+    const __m128i pairs = _mm_srai_epi32(_mm_add_epi32(sum, _mm_set1_epi32(1 << 15)), 16);
+    const __m128i packed = _mm_packs_epi32(pairs, pairs);
+    r = _mm_add_epi16(y, _mm_mulhi_epi16(w, _mm_set1_epi16(kRV)));
+    g = _mm_sub_epi16(y, _mm_unpacklo_epi16(packed, packed));
+    b = _mm_add_epi16(y, _mm_mulhi_epi16(u, _mm_set1_epi16(kBU)));
+}
+
+void ColorRowSSE2(const unsigned char *src, unsigned char *dst, int width, int channels, bool swapRB)
+{
+    int x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        __m128i r0, g0, b0, r1, g1, b1;
+        ColorHalfSSE2(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + x * 2)), r0, g0, b0);
+        ColorHalfSSE2(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + x * 2 + 16)), r1, g1, b1);
+        __m128i r = _mm_packus_epi16(r0, r1);
+        const __m128i g = _mm_packus_epi16(g0, g1);
+        __m128i b = _mm_packus_epi16(b0, b1);
+        if (swapRB)
+            std::swap(r, b);
+        const __m128i opaque = _mm_set1_epi8(-1);
+        const __m128i rgLo = _mm_unpacklo_epi8(r, g), rgHi = _mm_unpackhi_epi8(r, g);
+        const __m128i bxLo = _mm_unpacklo_epi8(b, opaque), bxHi = _mm_unpackhi_epi8(b, opaque);
+        const __m128i quads[4] = {_mm_unpacklo_epi16(rgLo, bxLo), _mm_unpackhi_epi16(rgLo, bxLo),
+                                  _mm_unpacklo_epi16(rgHi, bxHi), _mm_unpackhi_epi16(rgHi, bxHi)};
+        unsigned char *out = dst + x * channels;
+        if (channels == 4)
+        {
+            for (int q = 0; q < 4; ++q)
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(out + q * 16), quads[q]);
+            continue;
+        }
+        // SSE2 has no byte shuffle, so the X bytes are dropped in scalar code.
+        alignas(16) unsigned char packed[64];
+        for (int q = 0; q < 4; ++q)
+            _mm_store_si128(reinterpret_cast<__m128i *>(packed + q * 16), quads[q]);
+        for (int i = 0; i < 16; ++i)
+            std::memcpy(out + i * 3, packed + i * 4, 3);
+    }
+    ColorRowScalar(src + x * 2, dst + x * channels, width - x, channels, swapRB);
+}
+
+void GrayRowSSE2(const unsigned char *src, unsigned char *dst, int width)
+{
+    const __m128i mask = _mm_set1_epi16(0x00FF);
+    int x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        const __m128i a = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + x * 2)), mask);
+        const __m128i b = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + x * 2 + 16)), mask);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + x), _mm_packus_epi16(a, b));
+    }
+    GrayRowScalar(src + x * 2, dst + x, width - x);
+}
+
+// Same steps as SSE2 on two 128-bit lanes at once; lambdas are avoided
+// because they would not inherit the avx2 target.
+LITECAM_AVX2_TARGET inline void ColorHalfAVX2(__m256i v, __m256i &r, __m256i &g, __m256i &b)
+{
+    const __m256i y = _mm256_and_si256(v, _mm256_set1_epi16(0x00FF));
+    const __m256i uv = _mm256_slli_epi16(_mm256_sub_epi16(_mm256_srli_epi16(v, 8), _mm256_set1_epi16(128)), 7);
+    const __m256i u = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(uv, _MM_SHUFFLE(2, 2, 0, 0)), _MM_SHUFFLE(2, 2, 0, 0));
+    const __m256i w = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(uv, _MM_SHUFFLE(3, 3, 1, 1)), _MM_SHUFFLE(3, 3, 1, 1));
+    const __m256i sum = _mm256_madd_epi16(uv, _mm256_set1_epi32((kGV << 16) | kGU));
+    const __m256i pairs = _mm256_srai_epi32(_mm256_add_epi32(sum, _mm256_set1_epi32(1 << 15)), 16);
+    const __m256i packed = _mm256_packs_epi32(pairs, pairs);
+    r = _mm256_add_epi16(y, _mm256_mulhi_epi16(w, _mm256_set1_epi16(kRV)));
+    g = _mm256_sub_epi16(y, _mm256_unpacklo_epi16(packed, packed));
+    b = _mm256_add_epi16(y, _mm256_mulhi_epi16(u, _mm256_set1_epi16(kBU)));
+}
+
+LITECAM_AVX2_TARGET void ColorRowAVX2(const unsigned char *src, unsigned char *dst, int width, int channels, bool swapRB)
+{
+    // Keeps the first 12 bytes of each lane: four pixels without X.
+    const __m256i dropX = _mm256_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1,
+                                           0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+    int x = 0;
+    for (; x + 32 <= width; x += 32)
+    {
+        __m256i r0, g0, b0, r1, g1, b1;
+        ColorHalfAVX2(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + x * 2)), r0, g0, b0);
+        ColorHalfAVX2(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + x * 2 + 32)), r1, g1, b1);
+        // Lane 0 now holds pixels 0-7 and 16-23, lane 1 pixels 8-15 and 24-31.
+        __m256i r = _mm256_packus_epi16(r0, r1);
+        const __m256i g = _mm256_packus_epi16(g0, g1);
+        __m256i b = _mm256_packus_epi16(b0, b1);
+        if (swapRB)
+        {
+            const __m256i red = r;
+            r = b;
+            b = red;
+        }
+        const __m256i opaque = _mm256_set1_epi8(-1);
+        const __m256i rgLo = _mm256_unpacklo_epi8(r, g), rgHi = _mm256_unpackhi_epi8(r, g);
+        const __m256i bxLo = _mm256_unpacklo_epi8(b, opaque), bxHi = _mm256_unpackhi_epi8(b, opaque);
+        const __m256i q0 = _mm256_unpacklo_epi16(rgLo, bxLo), q1 = _mm256_unpackhi_epi16(rgLo, bxLo);
+        const __m256i q2 = _mm256_unpacklo_epi16(rgHi, bxHi), q3 = _mm256_unpackhi_epi16(rgHi, bxHi);
+        const __m256i pixels[4] = {_mm256_permute2x128_si256(q0, q1, 0x20), _mm256_permute2x128_si256(q0, q1, 0x31),
+                                   _mm256_permute2x128_si256(q2, q3, 0x20), _mm256_permute2x128_si256(q2, q3, 0x31)};
+        unsigned char *out = dst + x * channels;
+        if (channels == 4)
+        {
+            for (int q = 0; q < 4; ++q)
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + q * 32), pixels[q]);
+            continue;
+        }
+        // Each 16-byte store overlaps the next by four bytes; the last one
+        // writes exactly 12 so nothing past this block is touched.
+        for (int q = 0; q < 4; ++q)
+        {
+            const __m256i packed = _mm256_shuffle_epi8(pixels[q], dropX);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out + q * 24), _mm256_castsi256_si128(packed));
+            const __m128i high = _mm256_extracti128_si256(packed, 1);
+            if (q < 3)
+            {
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(out + q * 24 + 12), high);
+            }
+            else
+            {
+                _mm_storel_epi64(reinterpret_cast<__m128i *>(out + q * 24 + 12), high);
+                const int tail = _mm_cvtsi128_si32(_mm_srli_si128(high, 8));
+                std::memcpy(out + q * 24 + 20, &tail, 4);
+            }
+        }
+    }
+    ColorRowSSE2(src + x * 2, dst + x * channels, width - x, channels, swapRB);
+}
+
+LITECAM_AVX2_TARGET void GrayRowAVX2(const unsigned char *src, unsigned char *dst, int width)
+{
+    const __m256i mask = _mm256_set1_epi16(0x00FF);
+    int x = 0;
+    for (; x + 32 <= width; x += 32)
+    {
+        const __m256i a = _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + x * 2)), mask);
+        const __m256i b = _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + x * 2 + 32)), mask);
+        // packus interleaves the lanes; put the four 8-pixel groups back in order.
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + x), _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), _MM_SHUFFLE(3, 1, 2, 0)));
+    }
+    GrayRowSSE2(src + x * 2, dst + x, width - x);
+}
+
+bool HasAVX2()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return false;
+    __cpuid(info, 1);
+    // The OS must save the YMM registers across context switches.
+    if (!(info[2] & (1 << 27)) || (_xgetbv(0) & 6) != 6)
+        return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif // LITECAM_YUV_X86
+
+#ifdef LITECAM_YUV_NEON
+void ColorRowNEON(const unsigned char *src, unsigned char *dst, int width, int channels, bool swapRB)
+{
+    int x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        // Y even, U, Y odd, V for 16 pixels.
+        const uint8x8x4_t p = vld4_u8(src + x * 2);
+        // vqdmulh doubles the product, so chroma is shifted by 6 rather than 7.
+        const int16x8_t d = vshlq_n_s16(vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(p.val[1])), vdupq_n_s16(128)), 6);
+        const int16x8_t e = vshlq_n_s16(vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(p.val[3])), vdupq_n_s16(128)), 6);
+        const int16x8_t rt = vqdmulhq_n_s16(e, kRV);
+        // G sums both products in 32 bits; the rounding shift by 15 undoes
+        // the smaller chroma shift and matches the scalar rounding.
+        const int16x8_t gt = vcombine_s16(
+            vrshrn_n_s32(vmlal_n_s16(vmull_n_s16(vget_low_s16(d), kGU), vget_low_s16(e), kGV), 15),
+            vrshrn_n_s32(vmlal_n_s16(vmull_n_s16(vget_high_s16(d), kGU), vget_high_s16(e), kGV), 15));
+        const int16x8_t bt = vqdmulhq_n_s16(d, kBU);
+        const int16x8_t y0 = vreinterpretq_s16_u16(vmovl_u8(p.val[0]));
+        const int16x8_t y1 = vreinterpretq_s16_u16(vmovl_u8(p.val[2]));
+        const uint8x8x2_t r = vzip_u8(vqmovun_s16(vaddq_s16(y0, rt)), vqmovun_s16(vaddq_s16(y1, rt)));
+        const uint8x8x2_t g = vzip_u8(vqmovun_s16(vsubq_s16(y0, gt)), vqmovun_s16(vsubq_s16(y1, gt)));
+        const uint8x8x2_t b = vzip_u8(vqmovun_s16(vaddq_s16(y0, bt)), vqmovun_s16(vaddq_s16(y1, bt)));
+        const uint8x16_t red = vcombine_u8(r.val[0], r.val[1]);
+        const uint8x16_t green = vcombine_u8(g.val[0], g.val[1]);
+        const uint8x16_t blue = vcombine_u8(b.val[0], b.val[1]);
+        if (channels == 4)
+        {
+            uint8x16x4_t out = {{swapRB ? blue : red, green, swapRB ? red : blue, vdupq_n_u8(255)}};
+            vst4q_u8(dst + x * 4, out);
+        }
+        else
+        {
+            uint8x16x3_t out = {{swapRB ? blue : red, green, swapRB ? red : blue}};
+            vst3q_u8(dst + x * 3, out);
+        }
+    }
+    ColorRowScalar(src + x * 2, dst + x * channels, width - x, channels, swapRB);
+}
+
+void GrayRowNEON(const unsigned char *src, unsigned char *dst, int width)
+{
+    int x = 0;
+    for (; x + 16 <= width; x += 16)
+        vst1q_u8(dst + x, vld2q_u8(src + x * 2).val[0]);
+    GrayRowScalar(src + x * 2, dst + x, width - x);
+}
+#endif // LITECAM_YUV_NEON
+
+struct Kernel
+{
+    const char *name;
+    ColorRow color;
+    GrayRow gray;
+};
+
+const Kernel kScalar = {"scalar", ColorRowScalar, GrayRowScalar};
+#ifdef LITECAM_YUV_X86
+const Kernel kSSE2 = {"sse2", ColorRowSSE2, GrayRowSSE2};
+const Kernel kAVX2 = {"avx2", ColorRowAVX2, GrayRowAVX2};
+#endif
+#ifdef LITECAM_YUV_NEON
+const Kernel kNEON = {"neon", ColorRowNEON, GrayRowNEON};
+#endif
+
+const Kernel *BestKernel()
+{
+#ifdef LITECAM_YUV_X86
+    return HasAVX2() ? &kAVX2 : &kSSE2;
+#elif defined(LITECAM_YUV_NEON)
+    return &kNEON;
+#else
+    return &kScalar;
+#endif
+}
+
+std::atomic<const Kernel *> activeKernel{nullptr};
+
+const Kernel *ActiveKernel()
+{
+    const Kernel *kernel = activeKernel.load(std::memory_order_relaxed);
+    if (!kernel)
+    {
+        kernel = BestKernel();
+        activeKernel.store(kernel, std::memory_order_relaxed);
+    }
+    return kernel;
+}
+
+void ConvertColor(const unsigned char *yuyv, int yuyvStride, unsigned char *dst, int dstStride, int width, int height, int channels, bool swapRB)
+{
+    if (!yuyv || !dst || width < 2 || height <= 0)
+        return;
+    const ColorRow row = ActiveKernel()->color;
+    for (int y = 0; y < height; ++y)
+        row(yuyv + static_cast<size_t>(y) * yuyvStride, dst + static_cast<size_t>(y) * dstStride, width & ~1, channels, swapRB);
+}
+} // namespace
+
+void ConvertYUYVToRGB(const unsigned char *yuyv, int yuyvStride, unsigned char *rgb, int rgbStride, int width, int height)
+{
+    ConvertColor(yuyv, yuyvStride, rgb, rgbStride, width, height, 3, false);
+}
+
+void ConvertYUYVToBGR(const unsigned char *yuyv, int yuyvStride, unsigned char *bgr, int bgrStride, int width, int height)
+{
+    ConvertColor(yuyv, yuyvStride, bgr, bgrStride, width, height, 3, true);
+}
+
+void ConvertYUYVToRGBX(const unsigned char *yuyv, int yuyvStride, unsigned char *rgbx, int rgbxStride, int width, int height)
+{
+    ConvertColor(yuyv, yuyvStride, rgbx, rgbxStride, width, height, 4, false);
+}
+
+void ConvertYUYVToBGRX(const unsigned char *yuyv, int yuyvStride, unsigned char *bgrx, int bgrxStride, int width, int height)
+{
+    ConvertColor(yuyv, yuyvStride, bgrx, bgrxStride, width, height, 4, true);
+}
+
+void ConvertYUYVToGray(const unsigned char *yuyv, int yuyvStride, unsigned char *gray, int grayStride, int width, int height)
+{
+    if (!yuyv || !gray || width < 2 || height <= 0)
+        return;
+    const GrayRow row = ActiveKernel()->gray;
+    for (int y = 0; y < height; ++y)
+        row(yuyv + static_cast<size_t>(y) * yuyvStride, gray + static_cast<size_t>(y) * grayStride, width & ~1);
+}
+
+const char *GetYuvKernel()
+{
+    return ActiveKernel()->name;
+}
+
+bool SetYuvKernel(const char *name)
+{
+    if (!name)
+        return false;
+    const Kernel *kernel = nullptr;
+    if (std::strcmp(name, "auto") == 0)
+        kernel = BestKernel();
+    else if (std::strcmp(name, "scalar") == 0)
+        kernel = &kScalar;
+#ifdef LITECAM_YUV_X86
+    else if (std::strcmp(name, "sse2") == 0)
+        kernel = &kSSE2;
+    else if (std::strcmp(name, "avx2") == 0 && HasAVX2())
+        kernel = &kAVX2;
+#endif
+#ifdef LITECAM_YUV_NEON
+    else if (std::strcmp(name, "neon") == 0)
+        kernel = &kNEON;
+#endif
+    if (!kernel)
+        return false;
+    activeKernel.store(kernel, std::memory_order_relaxed);
+    return true;
+}
@@ -0,0 +1,213 @@
+// Checks that every YUYV conversion kernel this CPU supports matches the
+// scalar reference byte for byte and maps neutral chroma to gray, then
+// measures their throughput.
+//
+//   yuyv_benchmark [--check] [--width W] [--height H] [--frames N]
+//
+// Exits with 1 if any kernel disagrees with the reference.
+
+#include "YuvConvert.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+typedef void (*Convert)(const unsigned char *, int, unsigned char *, int, int, int);
+
+struct Output
+{
+    const char *name;
+    Convert convert;
+    int channels;
+};
+
+const Output kOutputs[] = {
+    {"rgb", ConvertYUYVToRGB, 3},
+    {"bgr", ConvertYUYVToBGR, 3},
+    {"rgbx", ConvertYUYVToRGBX, 4},
+    {"bgrx", ConvertYUYVToBGRX, 4},
+    {"gray", ConvertYUYVToGray, 1},
+};
+
+const char *kKernels[] = {"scalar", "sse2", "avx2", "neon"};
+
+// Output rows get 7 bytes of padding filled with a sentinel, so a kernel
+// that writes past the end of a row is caught too.
+std::vector<unsigned char> Run(Convert convert, const std::vector<unsigned char> &yuyv, int yuyvStride, int width, int height, int channels)
+{
+    const int stride = width * channels + 7;
+    std::vector<unsigned char> out(static_cast<size_t>(stride) * height, 0xCD);
+    convert(yuyv.data(), yuyvStride, out.data(), stride, width, height);
+    return out;
+}
+
+// Every kernel against the scalar one on one frame; returns the mismatches.
+int CheckFrame(const std::vector<unsigned char> &yuyv, int yuyvStride, int width, int height)
+{
+    int failures = 0;
+    for (const Output &output : kOutputs)
+    {
+        SetYuvKernel("scalar");
+        const std::vector<unsigned char> reference = Run(output.convert, yuyv, yuyvStride, width, height, output.channels);
+        for (const char *kernel : kKernels)
+        {
+            if (std::strcmp(kernel, "scalar") == 0 || !SetYuvKernel(kernel))
+                continue;
+            const std::vector<unsigned char> result = Run(output.convert, yuyv, yuyvStride, width, height, output.channels);
+            if (result != reference)
+            {
+                const size_t at = std::mismatch(result.begin(), result.end(), reference.begin()).first - result.begin();
+                printf("MISMATCH %s %s %dx%d at byte %zu: %d != %d\n", kernel, output.name, width, height, at, result[at], reference[at]);
+                ++failures;
+            }
+        }
+    }
+    SetYuvKernel("auto");
+    return failures;
+}
+
+std::vector<unsigned char> RandomFrame(int yuyvStride, int height, unsigned seed)
+{
+    std::mt19937 random(seed);
+    std::vector<unsigned char> frame(static_cast<size_t>(yuyvStride) * height);
+    for (unsigned char &byte : frame)
+        byte = static_cast<unsigned char>(random());
+    return frame;
+}
+
+int Check()
+{
+    int failures = 0;
+    // Every (Y, U, V) combination: 256 rows of U, each holding all V for a
+    // run of Y values.
+    const int width = 256 * 8 * 2;
+    std::vector<unsigned char> all;
+    for (int y0 = 0; y0 < 256; y0 += 8)
+    {
+        all.assign(static_cast<size_t>(width) * 2 * 256, 0);
+        for (int u = 0; u < 256; ++u)
+        {
+            unsigned char *row = all.data() + static_cast<size_t>(u) * width * 2;
+            for (int i = 0; i < width / 2; ++i)
+            {
+                row[i * 4] = static_cast<unsigned char>(y0 + (i & 7));
+                row[i * 4 + 1] = static_cast<unsigned char>(u);
+                row[i * 4 + 2] = static_cast<unsigned char>(255 - y0 - (i & 7));
+                row[i * 4 + 3] = static_cast<unsigned char>(i >> 3);
+            }
+        }
+        failures += CheckFrame(all, width * 2, width, 256);
+    }
+
+    // Widths around every block size, with padded input rows.
+    for (int w = 2; w <= 100; ++w)
+    {
+        const int stride = (w + 1) / 2 * 4 + 12;
+        failures += CheckFrame(RandomFrame(stride, 3, w), stride, w, 3);
+    }
+    failures += CheckFrame(RandomFrame(1920 * 2, 1080, 1080), 1920 * 2, 1920, 1080);
+
+    // The fixed-point reference stays within 2 of the double-precision
+    // formula litecam used before.
+    SetYuvKernel("scalar");
+    int worst = 0;
+    unsigned char rgb[6];
+    for (int y = 0; y < 256; ++y)
+        for (int u = 0; u < 256; ++u)
+            for (int v = 0; v < 256; ++v)
+            {
+                const unsigned char pair[4] = {static_cast<unsigned char>(y), static_cast<unsigned char>(u), static_cast<unsigned char>(y), static_cast<unsigned char>(v)};
+                ConvertYUYVToRGB(pair, 4, rgb, 6, 2, 1);
+                const double exact[3] = {y + 1.402 * (v - 128), y - 0.344136 * (u - 128) - 0.714136 * (v - 128), y + 1.772 * (u - 128)};
+                for (int c = 0; c < 3; ++c)
+                    worst = std::max(worst, std::abs(rgb[c] - static_cast<int>(std::min(255.0, std::max(0.0, exact[c])))));
+            }
+    SetYuvKernel("auto");
+    printf("max difference from floating point: %d\n", worst);
+    if (worst > 2)
+        ++failures;
+
+    // Neutral chroma is gray: R = G = B = Y for every Y, on every kernel.
+    std::vector<unsigned char> gray(256 * 2);
+    for (int i = 0; i < 256; ++i)
+    {
+        gray[i * 2] = static_cast<unsigned char>(i);
+        gray[i * 2 + 1] = 128;
+    }
+    for (const char *kernel : kKernels)
+    {
+        if (!SetYuvKernel(kernel))
+            continue;
+        const std::vector<unsigned char> out = Run(ConvertYUYVToRGB, gray, 256 * 2, 256, 1, 3);
+        for (int i = 0; i < 256; ++i)
+            if (out[i * 3] != i || out[i * 3 + 1] != i || out[i * 3 + 2] != i)
+            {
+                printf("NEUTRAL %s Y=%d: %d %d %d\n", kernel, i, out[i * 3], out[i * 3 + 1], out[i * 3 + 2]);
+                ++failures;
+                break;
+            }
+    }
+    SetYuvKernel("auto");
+    return failures;
+}
+
+void Measure(int width, int height, int frames)
+{
+    const std::vector<unsigned char> yuyv = RandomFrame(width * 2, height, 1);
+    std::vector<unsigned char> out(static_cast<size_t>(width) * height * 4);
+    for (const char *kernel : kKernels)
+    {
+        if (!SetYuvKernel(kernel))
+            continue;
+        for (const Output &output : kOutputs)
+        {
+            output.convert(yuyv.data(), width * 2, out.data(), width * output.channels, width, height);
+            const auto begin = std::chrono::steady_clock::now();
+            for (int i = 0; i < frames; ++i)
+                output.convert(yuyv.data(), width * 2, out.data(), width * output.channels, width, height);
+            const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+            printf("%-7s %-5s %8.3f ms/frame %9.1f Mpixel/s\n", kernel, output.name, seconds * 1000 / frames,
+                   static_cast<double>(width) * height * frames / seconds / 1e6);
+        }
+    }
+    SetYuvKernel("auto");
+}
+
+int main(int argc, char *argv[])
+{
+    int width = 1920;
+    int height = 1080;
+    int frames = 200;
+    bool checkOnly = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--check")
+            checkOnly = true;
+        else if (arg == "--width" && i + 1 < argc)
+            width = std::atoi(argv[++i]);
+        else if (arg == "--height" && i + 1 < argc)
+            height = std::atoi(argv[++i]);
+        else if (arg == "--frames" && i + 1 < argc)
+            frames = std::max(1, std::atoi(argv[++i]));
+        else
+        {
+            printf("Usage: %s [--check] [--width W] [--height H] [--frames N]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    printf("default kernel: %s\n", GetYuvKernel());
+    const int failures = Check();
+    printf("bit-exact check: %s\n", failures ? "FAILED" : "passed");
+    if (failures || checkOnly)
+        return failures ? 1 : 0;
+    Measure(width & ~1, height, frames);
+    return 0;
+}